@@ -14,6 +14,19 @@ SOURCES += \
     flightdetailswidget.cpp \
     apimanager.cpp \
     databasehelper.cpp \
+    datamodels.cpp \
+    connectionpool.cpp \
+    preparedstatementcache.cpp \
+    asyncdatabasehelper.cpp \
+    seatmap.cpp \
+    routesearch.cpp \
+    farecalendar.cpp \
+    airportindex.cpp \
+    tablemodels.cpp \
+    tablefilter.cpp \
+    httpcache.cpp \
+    retrypolicy.cpp \
+    tokenbucket.cpp \
     customwidgets.cpp
 
 HEADERS += \
@@ -24,6 +37,20 @@ HEADERS += \
     flightdetailswidget.h \
     apimanager.h \
     databasehelper.h \
+    datamodels.h \
+    connectionpool.h \
+    preparedstatementcache.h \
+    lrucache.h \
+    asyncdatabasehelper.h \
+    seatmap.h \
+    routesearch.h \
+    farecalendar.h \
+    airportindex.h \
+    tablemodels.h \
+    tablefilter.h \
+    httpcache.h \
+    retrypolicy.h \
+    tokenbucket.h \
     customwidgets.h
 
 FORMS += \
@@ -0,0 +1,238 @@
+#include "airportindex.h"
+#include <QFile>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// 前缀扫描的上限，单字符输入时避免遍历过多键
+const int MAX_PREFIX_SCAN = 4096;
+
+}
+
+AirportIndex::AirportIndex()
+{
+}
+
+void AirportIndex::build(const QVector<Airport> &source)
+{
+    airports = source;
+    iataIndex.clear();
+    keys.clear();
+    trigrams.clear();
+
+    for (int id = 0; id < airports.size(); ++id) {
+        const Airport &airport = airports.at(id);
+        iataIndex.insert(airport.iata.toUpper(), id);
+
+        QString initials;
+        for (const QString &syllable : airport.pinyin.split(' ', Qt::SkipEmptyParts)) {
+            initials += syllable.at(0);
+        }
+
+        QSet<QString> airportKeys = {
+            normalize(airport.iata), normalize(airport.city), normalize(airport.name),
+            normalize(airport.pinyin), normalize(initials)
+        };
+        airportKeys.remove(QString());
+
+        QSet<QString> airportTrigrams;
+        for (const QString &key : std::as_const(airportKeys)) {
+            keys.append(qMakePair(key, id));
+            for (const QString &trigram : trigramsOf(key)) {
+                airportTrigrams.insert(trigram);
+            }
+        }
+
+        for (const QString &trigram : std::as_const(airportTrigrams)) {
+            trigrams[trigram].append(id);
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+}
+
+bool AirportIndex::loadFromFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QVector<Airport> loaded;
+    QTextStream stream(&file);
+    while (!stream.atEnd()) {
+        const QStringList fields = stream.readLine().split(',');
+        if (fields.size() < 4 || fields.at(0).trimmed().isEmpty()) {
+            continue;
+        }
+        loaded.append(Airport{fields.at(0).trimmed(), fields.at(1).trimmed(),
+                              fields.at(2).trimmed(), fields.at(3).trimmed()});
+    }
+
+    build(loaded);
+    return true;
+}
+
+QVector<Airport> AirportIndex::suggest(const QString &text, int limit) const
+{
+    QVector<Airport> result;
+    const QString query = normalize(text);
+    if (query.isEmpty() || limit <= 0) {
+        return result;
+    }
+
+    QHash<int, int> scores;
+    const auto score = [&scores](int id, int value) {
+        int &current = scores[id];
+        current = qMax(current, value);
+    };
+
+    auto iata = iataIndex.constFind(query.toUpper());
+    if (iata != iataIndex.constEnd()) {
+        score(iata.value(), 1000);
+    }
+
+    // 前缀匹配：越接近完整键得分越高
+    auto it = std::lower_bound(keys.cbegin(), keys.cend(), qMakePair(query, -1));
+    for (int scanned = 0; it != keys.cend() && scanned < MAX_PREFIX_SCAN; ++it, ++scanned) {
+        if (!it->first.startsWith(query)) {
+            break;
+        }
+        score(it->second, 500 + query.size() * 100 / it->first.size());
+    }
+
+    // 模糊匹配：至少一半的三字组命中
+    if (scores.size() < limit && query.size() >= 3) {
+        const QStringList queryTrigrams = trigramsOf(query);
+        QHash<int, int> shared;
+        for (const QString &trigram : queryTrigrams) {
+            for (int id : trigrams.value(trigram)) {
+                ++shared[id];
+            }
+        }
+
+        for (auto match = shared.cbegin(); match != shared.cend(); ++match) {
+            if (match.value() * 2 >= queryTrigrams.size()) {
+                score(match.key(), match.value() * 100 / queryTrigrams.size());
+            }
+        }
+    }
+
+    // 同分时按内置顺序（大机场在前）
+    QVector<QPair<int, int>> ranked;
+    ranked.reserve(scores.size());
+    for (auto match = scores.cbegin(); match != scores.cend(); ++match) {
+        ranked.append(qMakePair(-match.value(), match.key()));
+    }
+    const int count = qMin(limit, int(ranked.size()));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.append(airports.at(ranked.at(i).second));
+    }
+    return result;
+}
+
+QString AirportIndex::resolveCity(const QString &text) const
+{
+    // 联想结果的显示文本 "机场名 (IATA)"
+    static const QRegularExpression codePattern("\\(([A-Za-z]{3})\\)\\s*$");
+    const QRegularExpressionMatch match = codePattern.match(text);
+    if (match.hasMatch()) {
+        auto iata = iataIndex.constFind(match.captured(1).toUpper());
+        if (iata != iataIndex.constEnd()) {
+            return airports.at(iata.value()).city;
+        }
+    }
+
+    const QVector<Airport> best = suggest(text, 1);
+    return best.isEmpty() ? text.trimmed() : best.first().city;
+}
+
+int AirportIndex::size() const
+{
+    return airports.size();
+}
+
+const AirportIndex &AirportIndex::defaultIndex()
+{
+    static const AirportIndex index = [] {
+        AirportIndex builtin;
+        builtin.build(builtinAirports());
+        return builtin;
+    }();
+    return index;
+}
+
+QVector<Airport> AirportIndex::builtinAirports()
+{
+    return {
+        {"PEK", "北京", "北京首都国际机场", "bei jing"},
+        {"PKX", "北京", "北京大兴国际机场", "bei jing"},
+        {"PVG", "上海", "上海浦东国际机场", "shang hai"},
+        {"SHA", "上海", "上海虹桥国际机场", "shang hai"},
+        {"CAN", "广州", "广州白云国际机场", "guang zhou"},
+        {"SZX", "深圳", "深圳宝安国际机场", "shen zhen"},
+        {"CTU", "成都", "成都双流国际机场", "cheng du"},
+        {"TFU", "成都", "成都天府国际机场", "cheng du"},
+        {"KMG", "昆明", "昆明长水国际机场", "kun ming"},
+        {"XIY", "西安", "西安咸阳国际机场", "xi an"},
+        {"CKG", "重庆", "重庆江北国际机场", "chong qing"},
+        {"HGH", "杭州", "杭州萧山国际机场", "hang zhou"},
+        {"NKG", "南京", "南京禄口国际机场", "nan jing"},
+        {"WUH", "武汉", "武汉天河国际机场", "wu han"},
+        {"CSX", "长沙", "长沙黄花国际机场", "chang sha"},
+        {"XMN", "厦门", "厦门高崎国际机场", "xia men"},
+        {"TAO", "青岛", "青岛胶东国际机场", "qing dao"},
+        {"CGO", "郑州", "郑州新郑国际机场", "zheng zhou"},
+        {"TSN", "天津", "天津滨海国际机场", "tian jin"},
+        {"SYX", "三亚", "三亚凤凰国际机场", "san ya"},
+        {"HAK", "海口", "海口美兰国际机场", "hai kou"},
+        {"URC", "乌鲁木齐", "乌鲁木齐地窝堡国际机场", "wu lu mu qi"},
+        {"SHE", "沈阳", "沈阳桃仙国际机场", "shen yang"},
+        {"DLC", "大连", "大连周水子国际机场", "da lian"},
+        {"HRB", "哈尔滨", "哈尔滨太平国际机场", "ha er bin"},
+        {"KWE", "贵阳", "贵阳龙洞堡国际机场", "gui yang"},
+        {"NNG", "南宁", "南宁吴圩国际机场", "nan ning"},
+        {"FOC", "福州", "福州长乐国际机场", "fu zhou"},
+        {"TNA", "济南", "济南遥墙国际机场", "ji nan"},
+        {"LHW", "兰州", "兰州中川国际机场", "lan zhou"},
+        {"HET", "呼和浩特", "呼和浩特白塔国际机场", "hu he hao te"},
+        {"LXA", "拉萨", "拉萨贡嘎国际机场", "la sa"},
+        {"HKG", "香港", "香港国际机场", "xiang gang"},
+        {"MFM", "澳门", "澳门国际机场", "ao men"},
+        {"TPE", "台北", "台湾桃园国际机场", "tai bei"},
+        {"NRT", "东京", "东京成田国际机场", "dong jing"},
+        {"HND", "东京", "东京羽田国际机场", "dong jing"},
+        {"ICN", "首尔", "首尔仁川国际机场", "shou er"},
+        {"SIN", "新加坡", "新加坡樟宜机场", "xin jia po"},
+        {"BKK", "曼谷", "曼谷素万那普机场", "man gu"},
+        {"LHR", "伦敦", "伦敦希思罗机场", "lun dun"},
+        {"CDG", "巴黎", "巴黎戴高乐机场", "ba li"},
+        {"FRA", "法兰克福", "法兰克福机场", "fa lan ke fu"},
+        {"JFK", "纽约", "纽约肯尼迪国际机场", "niu yue"},
+        {"LAX", "洛杉矶", "洛杉矶国际机场", "luo shan ji"},
+        {"SYD", "悉尼", "悉尼金斯福德·史密斯机场", "xi ni"}
+    };
+}
+
+QString AirportIndex::normalize(const QString &text)
+{
+    static const QRegularExpression separators("[\\s·()（）]");
+    QString key = text.toCaseFolded();
+    key.remove(separators);
+    return key;
+}
+
+QStringList AirportIndex::trigramsOf(const QString &key)
+{
+    QStringList result;
+    for (int i = 0; i + 3 <= key.size(); ++i) {
+        result.append(key.mid(i, 3));
+    }
+    return result;
+}
@@ -0,0 +1,55 @@
+#ifndef AIRPORTINDEX_H
+#define AIRPORTINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+
+// 机场条目，pinyin 为城市拼音，音节以空格分隔（如 "bei jing"）
+struct Airport
+{
+    QString iata;
+    QString city;
+    QString name;
+    QString pinyin;
+
+    QString displayText() const { return QString("%1 (%2)").arg(name, iata); }
+};
+
+// 城市/机场联想索引
+// 城市、机场名、拼音全拼、拼音首字母和 IATA 代码归一化后放入有序数组，前缀匹配用二分查找；
+// 长度不少于 3 的输入再按三字组倒排表做模糊匹配，容忍错字和漏字。
+// 索引建好后只读，可在多个线程中同时查询。
+class AirportIndex
+{
+public:
+    AirportIndex();
+
+    void build(const QVector<Airport> &airports);
+    // 每行 "iata,city,name,pinyin"
+    bool loadFromFile(const QString &filePath);
+
+    // 按匹配程度排序的候选，IATA 完全匹配优先，其次前缀，最后模糊匹配
+    QVector<Airport> suggest(const QString &text, int limit = 10) const;
+    // 把用户输入（城市、机场名、拼音、代码或联想结果的显示文本）解析为城市名，无法识别时原样返回
+    QString resolveCity(const QString &text) const;
+
+    int size() const;
+
+    // 内置常用机场
+    static const AirportIndex &defaultIndex();
+    static QVector<Airport> builtinAirports();
+
+private:
+    QVector<Airport> airports;
+    QHash<QString, int> iataIndex;
+    QVector<QPair<QString, int>> keys;          // (归一化键, 机场序号)，按键排序
+    QHash<QString, QVector<int>> trigrams;      // 三字组 -> 机场序号
+
+    static QString normalize(const QString &text);
+    static QStringList trigramsOf(const QString &key);
+};
+
+#endif // AIRPORTINDEX_H
@@ -3,128 +3,740 @@
 #include <QNetworkRequest>
 #include <QJsonDocument>
 #include <QDebug>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QRandomGenerator>
+#include <algorithm>
 
 APIManager::APIManager(QObject *parent)
     : QObject(parent)
     , networkManager(new QNetworkAccessManager(this))
+    , cache(new HttpResponseCache(this))
     , baseApiUrl("https://api.flightsystem.com/v1")
+    , flightSearchTicket(0)
+    , nextSerial(0)
+    , nextTicket(0)
+    , retryPolicies(API_REQUEST_KINDS)
+    , generalBucket(10, 40)
+    , searchBucket(5, 15)
+    , waiting(REQUEST_PRIORITIES)
+    , queueDeadlines(REQUEST_PRIORITIES)
+    , connectionsPerHost(4)
+    , scheduleTimer(new QTimer(this))
 {
+    cache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/http");
+    networkManager->setCache(cache);
+    clock.start();
+    scheduleTimer->setSingleShot(true);
+    connect(scheduleTimer, &QTimer::timeout, this, &APIManager::dispatchWaiting);
+    
+    for (int kind = 0; kind < API_REQUEST_KINDS; ++kind) {
+        retryPolicies[kind] = isIdempotent(ApiRequest(kind)) ? RetryPolicy::standard() : RetryPolicy::none();
+    }
+    
+    // 并发上限低于 QNetworkAccessManager 每主机 6 个连接，排队顺序由这里的优先级决定；
+    // 后台刷新过时就没有意义，排队期限最短
+    queueDeadlines[int(RequestPriority::Interactive)] = 15000;
+    queueDeadlines[int(RequestPriority::Normal)] = 30000;
+    queueDeadlines[int(RequestPriority::Background)] = 10000;
+    
     connect(networkManager, &QNetworkAccessManager::finished,
             this, &APIManager::handleNetworkReply);
 }
 
-void APIManager::searchFlights(const QString &departure, const QString &destination, const QDate &date)
+void APIManager::setBaseUrl(const QString &url)
 {
-    QJsonObject requestData;
-    requestData["departure"] = departure;
-    requestData["destination"] = destination;
-    requestData["date"] = date.toString("yyyy-MM-dd");
+    baseApiUrl = url;
+    breaker.reset();
+}
+
+QString APIManager::baseUrl() const
+{
+    return baseApiUrl;
+}
+
+HttpResponseCache *APIManager::responseCache() const
+{
+    return cache;
+}
+
+RequestStatistics APIManager::statistics() const
+{
+    return requestStatistics;
+}
+
+int APIManager::inFlightCount() const
+{
+    return requests.size();
+}
+
+void APIManager::setRetryPolicy(ApiRequest kind, const RetryPolicy &policy)
+{
+    RetryPolicy &target = retryPolicies[int(kind)];
+    target = policy;
+    target.maxAttempts = isIdempotent(kind) ? qMax(1, policy.maxAttempts) : 1;
+}
+
+RetryPolicy APIManager::retryPolicy(ApiRequest kind) const
+{
+    return retryPolicies.at(int(kind));
+}
+
+bool APIManager::isIdempotent(ApiRequest kind)
+{
+    switch (kind) {
+    case ApiRequest::Login:
+    case ApiRequest::Register:
+    case ApiRequest::CreateBooking:
+        return false;
+    default:
+        return true;
+    }
+}
+
+CircuitBreaker &APIManager::circuitBreaker()
+{
+    return breaker;
+}
+
+void APIManager::setRateLimit(RateLimit limit, int burst, int refillPerMinute)
+{
+    TokenBucket &bucket = limit == RateLimit::Search ? searchBucket : generalBucket;
+    bucket.configure(burst, refillPerMinute);
+    dispatchWaiting();
+}
+
+RequestPriority APIManager::priorityOf(ApiRequest kind)
+{
+    switch (kind) {
+    case ApiRequest::SearchFlights:
+    case ApiRequest::CreateBooking:
+    case ApiRequest::CancelBooking:
+    case ApiRequest::Login:
+    case ApiRequest::Register:
+        return RequestPriority::Interactive;
+    case ApiRequest::FlightStatistics:
+    case ApiRequest::UserStatistics:
+    case ApiRequest::BookingStatistics:
+    case ApiRequest::SystemStatus:
+    case ApiRequest::SystemConfig:
+        return RequestPriority::Background;
+    default:
+        return RequestPriority::Normal;
+    }
+}
+
+void APIManager::setMaxConnectionsPerHost(int count)
+{
+    connectionsPerHost = qMax(1, count);
+    dispatchWaiting();
+}
+
+int APIManager::maxConnectionsPerHost() const
+{
+    return connectionsPerHost;
+}
+
+void APIManager::setQueueDeadline(RequestPriority priority, int ms)
+{
+    queueDeadlines[int(priority)] = qMax(0, ms);
+}
+
+SchedulerStatistics APIManager::schedulerStatistics() const
+{
+    SchedulerStatistics stats = schedulerStats;
+    for (int priority = 0; priority < REQUEST_PRIORITIES; ++priority) {
+        stats.queued[priority] = waiting.at(priority).size();
+    }
+    for (int active : activeByHost) {
+        stats.active += active;
+    }
+    return stats;
+}
+
+int APIManager::queuedCount() const
+{
+    int count = 0;
+    for (const QQueue<QueuedRequest> &queue : waiting) {
+        count += queue.size();
+    }
+    return count;
+}
+
+quint64 APIManager::searchFlights(const QString &departure, const QString &destination, const QDate &date,
+                                  const ResponseHandler &handler)
+{
+    QUrlQuery query;
+    query.addQueryItem("departure", departure);
+    query.addQueryItem("destination", destination);
+    query.addQueryItem("date", date.toString("yyyy-MM-dd"));
     
-    makeApiCall("/flights/search", requestData);
+    // 先登记新的等待者再撤回旧的，条件相同时请求会沿用下去
+    quint64 ticket = 0;
+    makeGetCall(ApiRequest::SearchFlights, "/flights/search", query, false, handler, &ticket);
+    if (!handler) {
+        cancelFlightSearch();
+        flightSearchTicket = ticket;
+    }
+    return ticket;
+}
+
+void APIManager::cancelFlightSearch(quint64 ticket)
+{
+    if (ticket == 0 || ticket == flightSearchTicket) {
+        ticket = flightSearchTicket;
+        flightSearchTicket = 0;
+    }
+    if (ticket != 0) {
+        detach(ticket);
+    }
 }
 
-void APIManager::getFlightDetails(const QString &flightNumber)
+void APIManager::getFlightDetails(const QString &flightNumber, bool refresh, const ResponseHandler &handler)
 {
     QString endpoint = QString("/flights/%1").arg(flightNumber);
-    makeApiCall(endpoint);
+    makeGetCall(ApiRequest::FlightDetails, endpoint, QUrlQuery(), refresh, handler);
 }
 
-void APIManager::bookFlight(const QJsonObject &bookingData)
+void APIManager::updateFlightStatus(const QString &flightNumber, const QJsonObject &statusData,
+                                    const ResponseHandler &handler)
 {
-    makeApiCall("/bookings", bookingData);
+    QString endpoint = QString("/flights/%1/status").arg(flightNumber);
+    makeApiCall(ApiRequest::UpdateFlightStatus, "PUT", endpoint, statusData, handler);
 }
 
-void APIManager::loginUser(const QString &username, const QString &password)
+void APIManager::loginUser(const QString &username, const QString &password, const ResponseHandler &handler)
 {
     QJsonObject requestData;
     requestData["username"] = username;
     requestData["password"] = password;
     
-    makeApiCall("/auth/login", requestData);
+    makeApiCall(ApiRequest::Login, "POST", "/auth/login", requestData, handler);
 }
 
-void APIManager::registerUser(const QJsonObject &userData)
+void APIManager::registerUser(const QJsonObject &userData, const ResponseHandler &handler)
 {
-    makeApiCall("/auth/register", userData);
+    makeApiCall(ApiRequest::Register, "POST", "/auth/register", userData, handler);
+}
+
+void APIManager::getUserProfile(const QString &userId, bool refresh, const ResponseHandler &handler)
+{
+    QString endpoint = QString("/users/%1").arg(userId);
+    makeGetCall(ApiRequest::UserProfile, endpoint, QUrlQuery(), refresh, handler);
 }
 
-void APIManager::getUserProfile(const QString &userId)
+void APIManager::updateUserProfile(const QString &userId, const QJsonObject &userData,
+                                   const ResponseHandler &handler)
 {
     QString endpoint = QString("/users/%1").arg(userId);
-    makeApiCall(endpoint);
+    makeApiCall(ApiRequest::UpdateUserProfile, "PUT", endpoint, userData, handler);
 }
 
-void APIManager::getSystemStatus()
+void APIManager::getUserBookings(const QString &userId, const QUrlQuery &filter, bool refresh,
+                                 const ResponseHandler &handler)
 {
-    makeApiCall("/system/status");
+    QString endpoint = QString("/users/%1/bookings").arg(userId);
+    makeGetCall(ApiRequest::UserBookings, endpoint, filter, refresh, handler);
 }
 
-void APIManager::getFlightStatistics()
+void APIManager::bookFlight(const QJsonObject &bookingData, const ResponseHandler &handler)
 {
-    makeApiCall("/statistics/flights");
+    makeApiCall(ApiRequest::CreateBooking, "POST", "/bookings", bookingData, handler);
 }
 
-void APIManager::makeApiCall(const QString &endpoint, const QJsonObject &data)
+void APIManager::getBookingDetails(const QString &bookingId, bool refresh, const ResponseHandler &handler)
+{
+    QString endpoint = QString("/bookings/%1").arg(bookingId);
+    makeGetCall(ApiRequest::BookingDetails, endpoint, QUrlQuery(), refresh, handler);
+}
+
+void APIManager::cancelBooking(const QString &bookingId, const QJsonObject &cancelData,
+                               const ResponseHandler &handler)
+{
+    QString endpoint = QString("/bookings/%1/cancel").arg(bookingId);
+    makeApiCall(ApiRequest::CancelBooking, "PUT", endpoint, cancelData, handler);
+}
+
+void APIManager::getFlightStatistics(bool refresh, const ResponseHandler &handler)
+{
+    makeGetCall(ApiRequest::FlightStatistics, "/statistics/flights", QUrlQuery(), refresh, handler);
+}
+
+void APIManager::getUserStatistics(bool refresh, const ResponseHandler &handler)
+{
+    makeGetCall(ApiRequest::UserStatistics, "/statistics/users", QUrlQuery(), refresh, handler);
+}
+
+void APIManager::getBookingStatistics(bool refresh, const ResponseHandler &handler)
+{
+    makeGetCall(ApiRequest::BookingStatistics, "/statistics/bookings", QUrlQuery(), refresh, handler);
+}
+
+void APIManager::getSystemStatus(bool refresh, const ResponseHandler &handler)
+{
+    makeGetCall(ApiRequest::SystemStatus, "/system/status", QUrlQuery(), refresh, handler);
+}
+
+void APIManager::getSystemConfig(bool refresh, const ResponseHandler &handler)
+{
+    makeGetCall(ApiRequest::SystemConfig, "/system/config", QUrlQuery(), refresh, handler);
+}
+
+QString APIManager::makeApiCall(ApiRequest kind, const QByteArray &method, const QString &endpoint,
+                                const QJsonObject &data, const ResponseHandler &handler)
 {
     QUrl url(baseApiUrl + endpoint);
-    QNetworkRequest request(url);
     
+    // QJsonObject 的键有序，紧凑格式即为规范形式
+    QByteArray body;
+    if (!data.isEmpty()) {
+        body = QJsonDocument(data).toJson(QJsonDocument::Compact);
+    }
+    
+    QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setRawHeader("User-Agent", "FlightSystem/1.0");
     
-    QByteArray postData;
-    if (!data.isEmpty()) {
-        QJsonDocument doc(data);
-        postData = doc.toJson();
+    return submit(kind, requestKey(method, url, body), method, request, body, handler);
+}
+
+QString APIManager::makeGetCall(ApiRequest kind, const QString &endpoint, const QUrlQuery &query,
+                                bool refresh, const ResponseHandler &handler, quint64 *ticket)
+{
+    QUrl url(baseApiUrl + endpoint);
+    url.setQuery(query);
+    
+    const QString key = requestKey("GET", url, QByteArray());
+    if (refresh && !requests.contains(key)) {
+        cache->expire(url);
+    }
+    
+    QNetworkRequest request(url);
+    request.setRawHeader("User-Agent", "FlightSystem/1.0");
+    // 默认策略：新鲜则读缓存，过期则带校验头请求，304 时沿用缓存内容
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+    request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, true);
+    
+    return submit(kind, key, "GET", request, QByteArray(), handler, ticket);
+}
+
+QString APIManager::requestKey(const QByteArray &method, const QUrl &url, const QByteArray &body)
+{
+    return QString::fromLatin1(method) + ' ' + url.toString(QUrl::FullyEncoded) + ' ' + QString::fromUtf8(body);
+}
+
+QString APIManager::hostOf(const QUrl &url)
+{
+    return url.host() + ':' + QString::number(url.port(url.scheme() == "https" ? 443 : 80));
+}
+
+bool APIManager::isTransientFailure(QNetworkReply *reply)
+{
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status > 0) {
+        return status == 408 || status == 429 || status == 502 || status == 503 || status == 504;
+    }
+    
+    // 没有拿到 HTTP 响应：只有连接层面的临时故障值得重试
+    switch (reply->error()) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool APIManager::isServiceFailure(QNetworkReply *reply)
+{
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status > 0) {
+        return status >= 500;
+    }
+    
+    // 没有 HTTP 响应的错误都算服务故障，主动取消的除外
+    return reply->error() != QNetworkReply::NoError
+        && reply->error() != QNetworkReply::OperationCanceledError;
+}
+
+QString APIManager::submit(ApiRequest kind, const QString &key, const QByteArray &method,
+                           const QNetworkRequest &request, const QByteArray &body, const ResponseHandler &handler,
+                           quint64 *ticket)
+{
+    const Waiter waiter{++nextTicket, handler};
+    if (ticket) {
+        *ticket = waiter.ticket;
+    }
+    
+    auto it = requests.find(key);
+    if (it != requests.end()) {
+        ++requestStatistics.coalesced;
+        it->waiters.append(waiter);
+        return key;
+    }
+    
+    PendingRequest pending;
+    pending.kind = kind;
+    pending.method = method;
+    pending.request = request;
+    pending.body = body;
+    pending.host = hostOf(request.url());
+    pending.serial = ++nextSerial;
+    pending.waiters.append(waiter);
+    requests.insert(key, pending);
+    send(key);
+    return key;
+}
+
+void APIManager::send(const QString &key)
+{
+    auto it = requests.find(key);
+    if (it == requests.end()) {
+        return;
+    }
+    
+    if (!breaker.allowRequest(clock.elapsed())) {
+        ++requestStatistics.rejected;
+        // 与正常响应一样异步回调，调用方不必区分两种情况
+        const quint64 serial = it->serial;
+        QMetaObject::invokeMethod(this, [this, key, serial]() {
+            auto current = requests.find(key);
+            if (current != requests.end() && current->serial == serial && !current->reply) {
+                finish(key, QJsonObject(), QString("API Error: service unavailable (circuit open)"));
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+    
+    // 统一进入等待队列再按优先级取出，新请求不会越过已在排队的同级或更高优先级请求
+    const qint64 now = clock.elapsed();
+    const int priority = int(priorityOf(it->kind));
+    const int deadline = queueDeadlines.at(priority);
+    it->queued = true;
+    waiting[priority].enqueue({key, it->serial, now, deadline > 0 ? now + deadline : -1});
+    dispatchWaiting();
+    
+    it = requests.find(key);
+    if (it != requests.end() && it->queued) {
+        ++requestStatistics.queued;
+        schedulerStats.peakQueued = qMax(schedulerStats.peakQueued, queuedCount());
+    }
+}
+
+void APIManager::issue(const QString &key)
+{
+    auto it = requests.find(key);
+    if (it == requests.end()) {
+        return;
     }
     
-    QNetworkReply *reply = networkManager->post(request, postData);
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("requestData", data);
+    ++it->attempts;
+    ++requestStatistics.sent;
+    ++activeByHost[it->host];
+    QNetworkReply *reply = it->method == "GET"
+        ? networkManager->get(it->request)
+        : networkManager->sendCustomRequest(it->request, it->method, it->body);
+    it->reply = reply;
+    replies.insert(reply, key);
+}
+
+void APIManager::dispatchWaiting()
+{
+    const qint64 now = clock.elapsed();
+    qint64 nextWait = -1;
+    QStringList expired;
+    
+    auto wakeAfter = [&nextWait](qint64 wait) {
+        if (wait >= 0 && (nextWait < 0 || wait < nextWait)) {
+            nextWait = wait;
+        }
+    };
+    
+    for (int priority = 0; priority < REQUEST_PRIORITIES; ++priority) {
+        QQueue<QueuedRequest> &queue = waiting[priority];
+        for (auto entry = queue.begin(); entry != queue.end();) {
+            auto it = requests.find(entry->key);
+            if (it == requests.end() || it->serial != entry->serial || !it->queued) {
+                entry = queue.erase(entry);
+                continue;
+            }
+            if (entry->deadline >= 0 && now >= entry->deadline) {
+                it->queued = false;
+                expired.append(entry->key);
+                entry = queue.erase(entry);
+                continue;
+            }
+            
+            // 连接已满时不消耗令牌，等有请求返回再取
+            const bool slot = hasConnectionSlot(it->host, RequestPriority(priority));
+            if (!slot || !acquireTokens(it->kind, now)) {
+                if (slot) {
+                    wakeAfter(tokenWait(it->kind, now));
+                }
+                if (entry->deadline >= 0) {
+                    wakeAfter(entry->deadline - now);
+                }
+                ++entry;
+                continue;
+            }
+            
+            it->queued = false;
+            schedulerStats.longestWaitMs = qMax(schedulerStats.longestWaitMs, now - entry->enqueuedAt);
+            const QString key = entry->key;
+            entry = queue.erase(entry);
+            issue(key);
+        }
+    }
+    
+    if (nextWait >= 0) {
+        scheduleTimer->start(int(qMax<qint64>(1, nextWait)));
+    } else {
+        scheduleTimer->stop();
+    }
+    
+    // 遍历结束后再回调，回调中可能发起新的请求
+    for (const QString &key : expired) {
+        ++schedulerStats.expired;
+        finish(key, QJsonObject(), QString("API Error: request expired in queue"));
+    }
+}
+
+bool APIManager::hasConnectionSlot(const QString &host, RequestPriority priority) const
+{
+    const int active = activeByHost.value(host);
+    if (priority == RequestPriority::Background && connectionsPerHost > 1) {
+        return active < connectionsPerHost - 1;
+    }
+    return active < connectionsPerHost;
+}
+
+void APIManager::releaseConnectionSlot(const QString &host)
+{
+    auto it = activeByHost.find(host);
+    if (it == activeByHost.end()) {
+        return;
+    }
+    if (--it.value() <= 0) {
+        activeByHost.erase(it);
+    }
+}
+
+bool APIManager::acquireTokens(ApiRequest kind, qint64 now)
+{
+    // 先确认每个桶都有令牌再一起扣除
+    const bool search = kind == ApiRequest::SearchFlights;
+    if (!generalBucket.ready(now) || (search && !searchBucket.ready(now))) {
+        return false;
+    }
+    generalBucket.tryTake(now);
+    if (search) {
+        searchBucket.tryTake(now);
+    }
+    return true;
+}
+
+qint64 APIManager::tokenWait(ApiRequest kind, qint64 now)
+{
+    const qint64 general = generalBucket.waitTime(now);
+    const qint64 search = kind == ApiRequest::SearchFlights ? searchBucket.waitTime(now) : 0;
+    if (general < 0 || search < 0) {
+        return -1;
+    }
+    return qMax(general, search);
+}
+
+void APIManager::scheduleRetry(const QString &key, int delayMs)
+{
+    auto it = requests.find(key);
+    if (it == requests.end()) {
+        return;
+    }
+    const quint64 serial = it->serial;
+    QTimer::singleShot(delayMs, this, [this, key, serial]() {
+        // 等待期间被取消或已结束的请求不再发送
+        auto current = requests.find(key);
+        if (current != requests.end() && current->serial == serial && !current->reply) {
+            send(key);
+        }
+    });
+}
+
+void APIManager::cancel(const QString &key)
+{
+    auto it = requests.find(key);
+    if (it == requests.end()) {
+        return;
+    }
+    QNetworkReply *reply = it->reply;
+    if (it->queued) {
+        QQueue<QueuedRequest> &queue = waiting[int(priorityOf(it->kind))];
+        const quint64 serial = it->serial;
+        queue.erase(std::remove_if(queue.begin(), queue.end(), [&key, serial](const QueuedRequest &entry) {
+            return entry.key == key && entry.serial == serial;
+        }), queue.end());
+    }
+    const QString host = it->host;
+    requests.erase(it);
+    
+    if (reply) {
+        // abort() 同步触发 finished，此时已找不到对应请求，handleNetworkReply 直接忽略
+        replies.remove(reply);
+        releaseConnectionSlot(host);
+        reply->abort();
+        dispatchWaiting();
+    }
+}
+
+void APIManager::detach(quint64 ticket)
+{
+    for (auto it = requests.begin(); it != requests.end(); ++it) {
+        QVector<Waiter> &waiters = it->waiters;
+        const int before = waiters.size();
+        waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [ticket](const Waiter &waiter) {
+            return waiter.ticket == ticket;
+        }), waiters.end());
+        if (waiters.size() == before) {
+            continue;
+        }
+        
+        // 合并进来的其他调用方仍在等待时请求照常进行
+        if (waiters.isEmpty()) {
+            const QString key = it.key();
+            cancel(key);
+        }
+        return;
+    }
 }
 
 void APIManager::handleNetworkReply(QNetworkReply *reply)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        emit errorOccurred(QString("API Error: %1").arg(reply->errorString()));
-        reply->deleteLater();
+    reply->deleteLater();
+    
+    // 被新请求取代的搜索不再上报
+    const QString key = replies.take(reply);
+    auto it = requests.find(key);
+    if (it == requests.end() || it->reply != reply) {
         return;
     }
+    it->reply = nullptr;
+    releaseConnectionSlot(it->host);
     
-    QByteArray responseData = reply->readAll();
-    QString endpoint = reply->property("endpoint").toString();
+    // 是否重试和是否计入熔断分开判断：5xx 与网络层错误都说明服务不可用，408/429 只重试不计入
+    if (isServiceFailure(reply)) {
+        breaker.recordFailure(clock.elapsed());
+    } else {
+        breaker.recordSuccess();
+    }
     
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
+    if (isTransientFailure(reply)) {
+        const RetryPolicy policy = retryPolicies.at(int(it->kind));
+        if (it->attempts < policy.maxAttempts) {
+            int delay = policy.delayFor(it->attempts, QRandomGenerator::global()->generateDouble());
+            // 服务器要求的等待时间优先，但不超过策略上限
+            const int retryAfter = reply->rawHeader("Retry-After").toInt() * 1000;
+            delay = qBound(delay, retryAfter, qMax(delay, policy.maxDelayMs));
+            ++requestStatistics.retried;
+            scheduleRetry(key, delay);
+            dispatchWaiting();
+            return;
+        }
+    }
     
-    if (parseError.error != QJsonParseError::NoError) {
-        emit errorOccurred(QString("JSON Parse Error: %1").arg(parseError.errorString()));
-        reply->deleteLater();
+    QJsonObject response;
+    QString error;
+    if (reply->error() != QNetworkReply::NoError) {
+        error = QString("API Error: %1").arg(reply->errorString());
+    } else {
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            error = QString("JSON Parse Error: %1").arg(parseError.errorString());
+        } else {
+            response = doc.object();
+        }
+    }
+    finish(key, response, error);
+    // 空出的连接交给排队中优先级最高的请求
+    dispatchWaiting();
+}
+
+void APIManager::finish(const QString &key, const QJsonObject &response, const QString &error)
+{
+    if (!requests.contains(key)) {
         return;
     }
+    // 先移除再回调，回调里发起的同样请求会重新发送
+    const PendingRequest request = requests.take(key);
     
-    QJsonObject response = doc.object();
+    for (const Waiter &waiter : request.waiters) {
+        if (waiter.handler) {
+            waiter.handler(response, error);
+        }
+    }
     
-    // 根据不同的端点发出相应的信号
-    if (endpoint.contains("/flights/search")) {
+    if (!error.isEmpty()) {
+        emit errorOccurred(error);
+        return;
+    }
+    dispatch(request.kind, response);
+}
+
+void APIManager::dispatch(ApiRequest kind, const QJsonObject &response)
+{
+    switch (kind) {
+    case ApiRequest::SearchFlights:
         emit flightSearchCompleted(response["flights"].toArray());
-    } else if (endpoint.contains("/flights/") && !endpoint.contains("/search")) {
+        break;
+    case ApiRequest::FlightDetails:
         emit flightDetailsReceived(response);
-    } else if (endpoint.contains("/bookings")) {
-        emit bookingCompleted(response);
-    } else if (endpoint.contains("/auth/login")) {
+        break;
+    case ApiRequest::UpdateFlightStatus:
+        emit flightStatusUpdated(response);
+        break;
+    case ApiRequest::Login:
         emit loginCompleted(response);
-    } else if (endpoint.contains("/auth/register")) {
+        break;
+    case ApiRequest::Register:
         emit registrationCompleted(response);
-    } else if (endpoint.contains("/users/")) {
+        break;
+    case ApiRequest::UserProfile:
         emit userProfileReceived(response);
-    } else if (endpoint.contains("/system/status")) {
-        emit systemStatusReceived(response);
-    } else if (endpoint.contains("/statistics/flights")) {
+        break;
+    case ApiRequest::UpdateUserProfile:
+        emit userProfileUpdated(response);
+        break;
+    case ApiRequest::UserBookings:
+        emit userBookingsReceived(response);
+        break;
+    case ApiRequest::CreateBooking:
+        emit bookingCompleted(response);
+        break;
+    case ApiRequest::BookingDetails:
+        emit bookingDetailsReceived(response);
+        break;
+    case ApiRequest::CancelBooking:
+        emit bookingCancelled(response);
+        break;
+    case ApiRequest::FlightStatistics:
         emit statisticsReceived(response);
+        break;
+    case ApiRequest::UserStatistics:
+        emit userStatisticsReceived(response);
+        break;
+    case ApiRequest::BookingStatistics:
+        emit bookingStatisticsReceived(response);
+        break;
+    case ApiRequest::SystemStatus:
+        emit systemStatusReceived(response);
+        break;
+    case ApiRequest::SystemConfig:
+        emit systemConfigReceived(response);
+        break;
     }
-    
-    reply->deleteLater();
 }
 
 QJsonObject APIManager::createRequestData(const QStringList &params)
@@ -139,4 +751,4 @@ void APIManager::parseResponse(const QByteArray &response, const QString &reques
     // 解析响应数据
     Q_UNUSED(response);
     Q_UNUSED(requestType);
-}
\ No newline at end of file
+}
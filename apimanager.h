@@ -8,47 +8,259 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QHash>
+#include <QUrlQuery>
+#include <QVector>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+#include "httpcache.h"
+#include "retrypolicy.h"
+#include "tokenbucket.h"
+
+// 请求类型，与 docs/API.md 中的接口一一对应
+// 每个响应按发出时记录的类型分发，不再根据端点字符串猜测
+enum class ApiRequest
+{
+    SearchFlights,          // GET  /flights/search
+    FlightDetails,          // GET  /flights/{flight_number}
+    UpdateFlightStatus,     // PUT  /flights/{flight_number}/status
+    Login,                  // POST /auth/login
+    Register,               // POST /auth/register
+    UserProfile,            // GET  /users/{user_id}
+    UpdateUserProfile,      // PUT  /users/{user_id}
+    UserBookings,           // GET  /users/{user_id}/bookings
+    CreateBooking,          // POST /bookings
+    BookingDetails,         // GET  /bookings/{booking_id}
+    CancelBooking,          // PUT  /bookings/{booking_id}/cancel
+    FlightStatistics,       // GET  /statistics/flights
+    UserStatistics,         // GET  /statistics/users
+    BookingStatistics,      // GET  /statistics/bookings
+    SystemStatus,           // GET  /system/status
+    SystemConfig            // GET  /system/config
+};
+
+const int API_REQUEST_KINDS = int(ApiRequest::SystemConfig) + 1;
+
+// 请求优先级：限流排队时高优先级先发
+enum class RequestPriority
+{
+    Interactive,            // 用户正在等待结果：搜索、预订、登录
+    Normal,
+    Background              // 后台刷新：统计、系统状态
+};
+
+const int REQUEST_PRIORITIES = int(RequestPriority::Background) + 1;
+
+// 客户端限流的令牌桶，对应 docs/API.md 的限流规则
+enum class RateLimit
+{
+    General,                // 所有请求：每用户每分钟 50 次（单个客户端比每 IP 100 次更严）
+    Search                  // 搜索接口：每分钟 20 次
+};
+
+// 请求计数
+struct RequestStatistics
+{
+    quint64 sent = 0;           // 实际发出的请求（每次重试各算一次）
+    quint64 coalesced = 0;      // 与进行中的相同请求合并、没有单独发出的请求
+    quint64 retried = 0;        // 失败后安排的重试
+    quint64 rejected = 0;       // 熔断期间未发出、直接失败的请求
+    quint64 queued = 0;         // 没能立即发出、排队等待过的请求
+};
+
+// 发送队列状态
+struct SchedulerStatistics
+{
+    QVector<int> queued = QVector<int>(REQUEST_PRIORITIES);    // 各优先级当前排队数
+    int peakQueued = 0;         // 排队总数的最大值
+    int active = 0;             // 已发出、尚未返回
+    quint64 expired = 0;        // 排队超过期限被放弃的请求
+    qint64 longestWaitMs = 0;   // 已出队请求中最长的排队时间
+};
 
 class APIManager : public QObject
 {
     Q_OBJECT
 
 public:
+    // 单次请求的回调，成功时 error 为空；在对应信号之前调用，被取消的搜索不会回调
+    using ResponseHandler = std::function<void(const QJsonObject &response, const QString &error)>;
+    
     explicit APIManager(QObject *parent = nullptr);
     
+    void setBaseUrl(const QString &url);
+    QString baseUrl() const;
+    HttpResponseCache *responseCache() const;
+    
+    // 方法、URL 和请求体都相同的请求在前一个返回之前不会重复发出，
+    // 而是共用进行中的 QNetworkReply，结果只解析、发出一次信号，各自的回调都会被调用
+    RequestStatistics statistics() const;
+    // 尚未得到最终结果的请求数，包括等待重试的
+    int inFlightCount() const;
+    
+    // 幂等请求（GET / PUT）默认在连接失败、408/429/502/503/504 时指数退避重试两次，
+    // POST 请求（登录、注册、预订）始终只发送一次，设置的重试次数会被忽略
+    void setRetryPolicy(ApiRequest kind, const RetryPolicy &policy);
+    RetryPolicy retryPolicy(ApiRequest kind) const;
+    static bool isIdempotent(ApiRequest kind);
+    
+    // 后端连续失败时熔断，期间的请求直接以错误返回
+    CircuitBreaker &circuitBreaker();
+    
+    // 令牌不足或同一主机的并发已满时请求按优先级排队，先发优先级高的，同一优先级按先后顺序。
+    // 后台请求最多占用 上限 - 1 个连接，总给交互请求留一个；排队超过期限的请求以错误结束
+    void setRateLimit(RateLimit limit, int burst, int refillPerMinute);
+    void setMaxConnectionsPerHost(int count);
+    int maxConnectionsPerHost() const;
+    // ms 为 0 时不设期限
+    void setQueueDeadline(RequestPriority priority, int ms);
+    static RequestPriority priorityOf(ApiRequest kind);
+    int queuedCount() const;
+    SchedulerStatistics schedulerStatistics() const;
+    
+    // 只读接口使用 GET 并经过响应缓存：新鲜的缓存直接返回，不发请求；
+    // refresh 为 true 时忽略新鲜度，向服务器发出条件请求，未变化时只花费一次 304
+    
     // 航班相关API
-    void searchFlights(const QString &departure, const QString &destination, const QDate &date);
-    void getFlightDetails(const QString &flightNumber);
-    void bookFlight(const QJsonObject &bookingData);
+    // 返回本次调用的编号。条件相同的搜索合并为一个请求，各调用方各自撤回：
+    // cancelFlightSearch(ticket) 只撤回这一次调用的回调，没有调用方再等待时才放弃请求本身。
+    // 不带回调、只靠 flightSearchCompleted 接收结果的搜索，新的一次会自动撤回上一次
+    quint64 searchFlights(const QString &departure, const QString &destination, const QDate &date,
+                          const ResponseHandler &handler = ResponseHandler());
+    // ticket 为 0 时撤回最近一次不带回调的搜索
+    void cancelFlightSearch(quint64 ticket = 0);
+    void getFlightDetails(const QString &flightNumber, bool refresh = false,
+                          const ResponseHandler &handler = ResponseHandler());
+    void updateFlightStatus(const QString &flightNumber, const QJsonObject &statusData,
+                            const ResponseHandler &handler = ResponseHandler());
     
     // 用户相关API
-    void loginUser(const QString &username, const QString &password);
-    void registerUser(const QJsonObject &userData);
-    void getUserProfile(const QString &userId);
+    void loginUser(const QString &username, const QString &password,
+                   const ResponseHandler &handler = ResponseHandler());
+    void registerUser(const QJsonObject &userData, const ResponseHandler &handler = ResponseHandler());
+    void getUserProfile(const QString &userId, bool refresh = false,
+                        const ResponseHandler &handler = ResponseHandler());
+    void updateUserProfile(const QString &userId, const QJsonObject &userData,
+                           const ResponseHandler &handler = ResponseHandler());
+    // filter 可包含 status / limit / offset
+    void getUserBookings(const QString &userId, const QUrlQuery &filter = QUrlQuery(), bool refresh = false,
+                         const ResponseHandler &handler = ResponseHandler());
+    
+    // 预订相关API
+    void bookFlight(const QJsonObject &bookingData, const ResponseHandler &handler = ResponseHandler());
+    void getBookingDetails(const QString &bookingId, bool refresh = false,
+                           const ResponseHandler &handler = ResponseHandler());
+    void cancelBooking(const QString &bookingId, const QJsonObject &cancelData,
+                       const ResponseHandler &handler = ResponseHandler());
+    
+    // 统计相关API
+    void getFlightStatistics(bool refresh = false, const ResponseHandler &handler = ResponseHandler());
+    void getUserStatistics(bool refresh = false, const ResponseHandler &handler = ResponseHandler());
+    void getBookingStatistics(bool refresh = false, const ResponseHandler &handler = ResponseHandler());
     
     // 系统相关API
-    void getSystemStatus();
-    void getFlightStatistics();
+    void getSystemStatus(bool refresh = false, const ResponseHandler &handler = ResponseHandler());
+    void getSystemConfig(bool refresh = false, const ResponseHandler &handler = ResponseHandler());
 
 signals:
     void flightSearchCompleted(const QJsonArray &flights);
     void flightDetailsReceived(const QJsonObject &details);
+    void flightStatusUpdated(const QJsonObject &result);
     void bookingCompleted(const QJsonObject &result);
+    void bookingDetailsReceived(const QJsonObject &booking);
+    void bookingCancelled(const QJsonObject &result);
     void loginCompleted(const QJsonObject &result);
     void registrationCompleted(const QJsonObject &result);
     void userProfileReceived(const QJsonObject &profile);
+    void userProfileUpdated(const QJsonObject &profile);
+    void userBookingsReceived(const QJsonObject &bookings);
     void systemStatusReceived(const QJsonObject &status);
+    void systemConfigReceived(const QJsonObject &config);
     void statisticsReceived(const QJsonObject &statistics);
+    void userStatisticsReceived(const QJsonObject &statistics);
+    void bookingStatisticsReceived(const QJsonObject &statistics);
     void errorOccurred(const QString &error);
 
 private slots:
     void handleNetworkReply(QNetworkReply *reply);
 
 private:
+    // 等待某个请求结果的一次调用
+    struct Waiter
+    {
+        quint64 ticket;
+        ResponseHandler handler;            // 只靠信号接收结果时为空
+    };
+    
+    // 一个逻辑请求，从第一次发送到最终结果（包括等待重试的时间），合并进来的调用只追加等待者
+    struct PendingRequest
+    {
+        ApiRequest kind;
+        QByteArray method;
+        QNetworkRequest request;
+        QByteArray body;
+        QString host;
+        QVector<Waiter> waiters;
+        QNetworkReply *reply = nullptr;     // 等待重试或排队时为空
+        int attempts = 0;
+        quint64 serial = 0;                 // 区分先后两个键相同的请求
+        bool queued = false;
+    };
+    
+    struct QueuedRequest
+    {
+        QString key;
+        quint64 serial;
+        qint64 enqueuedAt;
+        qint64 deadline;                    // -1 表示不过期
+    };
+    
     QNetworkAccessManager *networkManager;
+    HttpResponseCache *cache;
     QString baseApiUrl;
+    quint64 flightSearchTicket;
+    QHash<QString, PendingRequest> requests;    // 请求键 -> 请求
+    QHash<QNetworkReply *, QString> replies;    // 进行中的响应 -> 请求键
+    quint64 nextSerial;
+    quint64 nextTicket;
+    RequestStatistics requestStatistics;
+    QVector<RetryPolicy> retryPolicies;
+    CircuitBreaker breaker;
+    QElapsedTimer clock;
+    TokenBucket generalBucket;
+    TokenBucket searchBucket;
+    QVector<QQueue<QueuedRequest>> waiting;     // 按优先级分开的等待队列
+    QVector<int> queueDeadlines;                // 各优先级的排队期限（毫秒）
+    QHash<QString, int> activeByHost;           // 主机 -> 已发出未返回的请求数
+    int connectionsPerHost;
+    SchedulerStatistics schedulerStats;
+    QTimer *scheduleTimer;
     
-    void makeApiCall(const QString &endpoint, const QJsonObject &data = QJsonObject());
+    static QString requestKey(const QByteArray &method, const QUrl &url, const QByteArray &body);
+    static bool isTransientFailure(QNetworkReply *reply);
+    static bool isServiceFailure(QNetworkReply *reply);
+    static QString hostOf(const QUrl &url);
+    QString submit(ApiRequest kind, const QString &key, const QByteArray &method,
+                   const QNetworkRequest &request, const QByteArray &body, const ResponseHandler &handler,
+                   quint64 *ticket = nullptr);
+    void send(const QString &key);
+    void issue(const QString &key);
+    void dispatchWaiting();
+    bool acquireTokens(ApiRequest kind, qint64 now);
+    qint64 tokenWait(ApiRequest kind, qint64 now);
+    bool hasConnectionSlot(const QString &host, RequestPriority priority) const;
+    void releaseConnectionSlot(const QString &host);
+    void scheduleRetry(const QString &key, int delayMs);
+    void cancel(const QString &key);
+    void detach(quint64 ticket);
+    void finish(const QString &key, const QJsonObject &response, const QString &error);
+    void dispatch(ApiRequest kind, const QJsonObject &response);
+    QString makeApiCall(ApiRequest kind, const QByteArray &method, const QString &endpoint,
+                        const QJsonObject &data, const ResponseHandler &handler);
+    QString makeGetCall(ApiRequest kind, const QString &endpoint, const QUrlQuery &query,
+                        bool refresh, const ResponseHandler &handler, quint64 *ticket = nullptr);
     QJsonObject createRequestData(const QStringList &params);
     void parseResponse(const QByteArray &response, const QString &requestType);
 };
@@ -0,0 +1,278 @@
+#include "asyncdatabasehelper.h"
+#include <QMetaObject>
+
+AsyncDatabaseHelper::AsyncDatabaseHelper(DatabaseHelper *helper, QObject *parent)
+    : QObject(parent)
+    , databaseHelper(helper)
+    , workerThread(new QThread(this))
+    , worker(new QObject())
+    , pending(0)
+    , stopping(false)
+{
+    workerThread->setObjectName("DatabaseWorker");
+    worker->moveToThread(workerThread);
+    connect(workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    workerThread->start();
+}
+
+AsyncDatabaseHelper::~AsyncDatabaseHelper()
+{
+    // 退出请求排在已入队的任务之后：这些任务先在工作线程上依次以取消结束，
+    // 每个 QFuture 都会完成；正在执行的任务照常完成。
+    // 退出事件循环后工作线程的连接会自动归还连接池
+    stopping = true;
+    QThread *thread = workerThread;
+    QMetaObject::invokeMethod(worker, [thread]() {
+        thread->quit();
+    }, Qt::QueuedConnection);
+    workerThread->wait();
+}
+
+QFuture<QJsonArray> AsyncDatabaseHelper::getFlights(const QString &departure, const QString &destination,
+                                                    const QueryCancelToken &token)
+{
+    return submit<QJsonArray>([departure, destination](DatabaseHelper *helper) {
+        return helper->getFlights(departure, destination);
+    }, token);
+}
+
+QFuture<QJsonObject> AsyncDatabaseHelper::getFlightDetails(const QString &flightNumber,
+                                                           const QueryCancelToken &token)
+{
+    return submit<QJsonObject>([flightNumber](DatabaseHelper *helper) {
+        return helper->getFlightDetails(flightNumber);
+    }, token);
+}
+
+FlightStream *AsyncDatabaseHelper::streamFlights(const QString &departure, const QString &destination,
+                                                int batchSize, int window, QObject *parent)
+{
+    FlightStream *stream = new FlightStream(parent);
+    std::shared_ptr<FlightStream::State> state = stream->state;
+    state->departure = departure;
+    state->destination = destination;
+    state->batchSize = qMax(1, batchSize);
+    state->credits = qMax(1, window);
+    state->receiver = stream;
+    state->reading = true;
+
+    QPointer<AsyncDatabaseHelper> self(this);
+    stream->scheduleRead = [self, state]() {
+        if (self) {
+            self->enqueue([self, state]() {
+                self->readStreamBatch(state);
+            });
+        }
+    };
+    stream->scheduleRead();
+    return stream;
+}
+
+void AsyncDatabaseHelper::readStreamBatch(const std::shared_ptr<FlightStream::State> &state)
+{
+    QMutexLocker locker(&state->mutex);
+    // 析构期间按取消处理，只关闭游标
+    if (stopping) {
+        state->cancelled = true;
+    }
+    const bool cancelled = state->cancelled;
+    locker.unlock();
+
+    QVector<Flight> batch;
+    if (!cancelled) {
+        if (!state->cursor) {
+            state->cursor.reset(new FlightCursor(
+                databaseHelper->openFlightCursor(state->departure, state->destination, state->batchSize)));
+        }
+        batch = state->cursor->nextBatch();
+    }
+
+    locker.relock();
+    // 游标在工作线程上关闭，连接随即可以回收。读到末尾时 nextBatch() 已关闭游标，
+    // 最后一批仍要交付；只有取消时才丢弃
+    const bool stop = state->cancelled || !state->cursor || state->cursor->atEnd();
+    if (stop) {
+        state->cursor.reset();
+        state->exhausted = true;
+    }
+    if (state->cancelled) {
+        batch.clear();
+    }
+    if (!batch.isEmpty()) {
+        --state->credits;
+    }
+    const bool readMore = !stop && state->credits > 0;
+    state->reading = readMore;
+    locker.unlock();
+
+    // 批次和结束通知按顺序投递到 GUI 线程，最后一批先于 finished() 到达
+    const QPointer<FlightStream> receiver = state->receiver;
+    if (!batch.isEmpty()) {
+        QMetaObject::invokeMethod(this, [receiver, batch]() {
+            if (receiver) {
+                receiver->deliver(batch);
+            }
+        }, Qt::QueuedConnection);
+    }
+    if (stop) {
+        QMetaObject::invokeMethod(this, [receiver]() {
+            if (receiver) {
+                receiver->finish();
+            }
+        }, Qt::QueuedConnection);
+    } else if (readMore) {
+        // 重新排队而不是循环读完，期间提交的查询不必等整个流结束
+        enqueue([this, state]() {
+            readStreamBatch(state);
+        });
+    }
+}
+
+QFuture<QJsonObject> AsyncDatabaseHelper::getUser(const QString &username, const QueryCancelToken &token)
+{
+    return submit<QJsonObject>([username](DatabaseHelper *helper) {
+        return helper->getUser(username);
+    }, token);
+}
+
+QFuture<QJsonArray> AsyncDatabaseHelper::getUserBookings(const QString &userId, const QueryCancelToken &token)
+{
+    return submit<QJsonArray>([userId](DatabaseHelper *helper) {
+        return helper->getUserBookings(userId);
+    }, token);
+}
+
+QFuture<QJsonObject> AsyncDatabaseHelper::getBookingDetails(const QString &bookingId,
+                                                            const QueryCancelToken &token)
+{
+    return submit<QJsonObject>([bookingId](DatabaseHelper *helper) {
+        return helper->getBookingDetails(bookingId);
+    }, token);
+}
+
+QFuture<QJsonObject> AsyncDatabaseHelper::getFlightStatistics(const QueryCancelToken &token)
+{
+    return submit<QJsonObject>([](DatabaseHelper *helper) {
+        return helper->getFlightStatistics();
+    }, token);
+}
+
+QFuture<QJsonObject> AsyncDatabaseHelper::getUserStatistics(const QueryCancelToken &token)
+{
+    return submit<QJsonObject>([](DatabaseHelper *helper) {
+        return helper->getUserStatistics();
+    }, token);
+}
+
+QFuture<QJsonObject> AsyncDatabaseHelper::getBookingStatistics(const QueryCancelToken &token)
+{
+    return submit<QJsonObject>([](DatabaseHelper *helper) {
+        return helper->getBookingStatistics();
+    }, token);
+}
+
+int AsyncDatabaseHelper::pendingCount() const
+{
+    return pending.load();
+}
+
+DatabaseHelper *AsyncDatabaseHelper::helper() const
+{
+    return databaseHelper;
+}
+
+void AsyncDatabaseHelper::enqueue(std::function<void()> job)
+{
+    emit pendingCountChanged(++pending);
+
+    QMetaObject::invokeMethod(worker, [this, job]() {
+        job();
+        int remaining = --pending;
+        QMetaObject::invokeMethod(this, [this, remaining]() {
+            emit pendingCountChanged(remaining);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+FlightStream::FlightStream(QObject *parent)
+    : QObject(parent)
+    , state(std::make_shared<State>())
+    , done(false)
+    , batches(0)
+    , rows(0)
+{
+}
+
+FlightStream::~FlightStream()
+{
+    cancel();
+}
+
+void FlightStream::cancel()
+{
+    QMutexLocker locker(&state->mutex);
+    if (state->cancelled || state->exhausted) {
+        return;
+    }
+    state->cancelled = true;
+
+    // 读取已暂停时排一个任务去关闭游标
+    const bool resume = !state->reading;
+    state->reading = true;
+    locker.unlock();
+    if (resume && scheduleRead) {
+        scheduleRead();
+    }
+}
+
+bool FlightStream::isFinished() const
+{
+    return done;
+}
+
+bool FlightStream::isCancelled() const
+{
+    QMutexLocker locker(&state->mutex);
+    return state->cancelled;
+}
+
+int FlightStream::batchCount() const
+{
+    return batches;
+}
+
+qint64 FlightStream::rowCount() const
+{
+    return rows;
+}
+
+void FlightStream::deliver(const QVector<Flight> &batch)
+{
+    if (isCancelled()) {
+        return;
+    }
+    ++batches;
+    rows += batch.size();
+    emit batchReady(batch);
+
+    // 这一批已处理完，归还一个额度，读取因额度用完而暂停时恢复
+    QMutexLocker locker(&state->mutex);
+    ++state->credits;
+    const bool resume = !state->reading && !state->exhausted && !state->cancelled;
+    if (resume) {
+        state->reading = true;
+    }
+    locker.unlock();
+    if (resume) {
+        scheduleRead();
+    }
+}
+
+void FlightStream::finish()
+{
+    if (done) {
+        return;
+    }
+    done = true;
+    emit finished();
+}
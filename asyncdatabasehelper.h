@@ -0,0 +1,174 @@
+#ifndef ASYNCDATABASEHELPER_H
+#define ASYNCDATABASEHELPER_H
+
+#include <QObject>
+#include <QThread>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMutex>
+#include <QPointer>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "databasehelper.h"
+
+// 查询取消令牌，复制后共享同一取消状态
+class QueryCancelToken
+{
+public:
+    QueryCancelToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() { cancelled->store(true); }
+    bool isCancelled() const { return cancelled->load(); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+class AsyncDatabaseHelper;
+
+// 分批流式读取航班
+// 工作线程每次只读一批，读完后重新排队，其他查询可以插在批次之间执行。
+// 已读出但还没经 batchReady 交给使用方的批次最多 window 个：GUI 线程处理完一批，
+// 工作线程才继续读下一批，内存占用只与 batchSize * window 有关，与结果总行数无关。
+// 只能在创建它的线程中使用，销毁时自动取消。
+class FlightStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~FlightStream();
+
+    // 停止读取剩余行，之后不再发出 batchReady，随后发出 finished()
+    void cancel();
+    bool isFinished() const;
+    bool isCancelled() const;
+    int batchCount() const;
+    qint64 rowCount() const;
+
+signals:
+    void batchReady(const QVector<Flight> &batch);
+    void finished();
+
+private:
+    friend class AsyncDatabaseHelper;
+
+    // 工作线程与 GUI 线程共享的状态，cursor 只在工作线程访问
+    struct State
+    {
+        QMutex mutex;
+        int credits = 0;            // 还能预读的批数
+        bool reading = false;       // 读取任务已排队或正在执行
+        bool exhausted = false;     // 游标已读完或已关闭
+        bool cancelled = false;
+        QString departure;
+        QString destination;
+        int batchSize = 0;
+        std::unique_ptr<FlightCursor> cursor;
+        QPointer<FlightStream> receiver;
+    };
+
+    explicit FlightStream(QObject *parent);
+
+    std::shared_ptr<State> state;
+    std::function<void()> scheduleRead;
+    bool done;
+    int batches;
+    qint64 rows;
+
+    void deliver(const QVector<Flight> &batch);
+    void finish();
+};
+
+// DatabaseHelper 的异步外观
+// 所有查询排队到专用的数据库工作线程执行（该线程从连接池获得自己的连接），
+// 结果通过 QFuture 返回（由 QFutureInterface 驱动，Qt 5.15 和 Qt 6 均可用）。令牌被取消或 QFuture 被 cancel() 时，尚未开始的查询直接跳过，
+// 已执行完的查询结果被丢弃。
+class AsyncDatabaseHelper : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncDatabaseHelper(DatabaseHelper *helper, QObject *parent = nullptr);
+    ~AsyncDatabaseHelper();
+
+    // 航班相关查询
+    QFuture<QJsonArray> getFlights(const QString &departure = "", const QString &destination = "",
+                                   const QueryCancelToken &token = QueryCancelToken());
+    QFuture<QJsonObject> getFlightDetails(const QString &flightNumber,
+                                          const QueryCancelToken &token = QueryCancelToken());
+    // 分批流式读取航班，返回的对象归 parent 所有（parent 为空时由调用方删除）
+    FlightStream *streamFlights(const QString &departure = "", const QString &destination = "",
+                                int batchSize = 1000, int window = 2, QObject *parent = nullptr);
+
+    // 用户和预订查询
+    QFuture<QJsonObject> getUser(const QString &username,
+                                 const QueryCancelToken &token = QueryCancelToken());
+    QFuture<QJsonArray> getUserBookings(const QString &userId,
+                                        const QueryCancelToken &token = QueryCancelToken());
+    QFuture<QJsonObject> getBookingDetails(const QString &bookingId,
+                                           const QueryCancelToken &token = QueryCancelToken());
+
+    // 系统统计
+    QFuture<QJsonObject> getFlightStatistics(const QueryCancelToken &token = QueryCancelToken());
+    QFuture<QJsonObject> getUserStatistics(const QueryCancelToken &token = QueryCancelToken());
+    QFuture<QJsonObject> getBookingStatistics(const QueryCancelToken &token = QueryCancelToken());
+
+    // 在工作线程上执行任意 DatabaseHelper 操作
+    template<typename T>
+    QFuture<T> submit(std::function<T(DatabaseHelper *)> task,
+                      const QueryCancelToken &token = QueryCancelToken());
+
+    int pendingCount() const;
+    // 背后的同步 DatabaseHelper，只用于连接它的变更信号
+    DatabaseHelper *helper() const;
+
+signals:
+    void pendingCountChanged(int count);
+
+private:
+    DatabaseHelper *databaseHelper;
+    QThread *workerThread;
+    QObject *worker;
+    std::atomic<int> pending;
+    std::atomic<bool> stopping;     // 析构开始后置位，排队中的任务只做收尾
+
+    void enqueue(std::function<void()> job);
+    void readStreamBatch(const std::shared_ptr<FlightStream::State> &state);
+};
+
+template<typename T>
+QFuture<T> AsyncDatabaseHelper::submit(std::function<T(DatabaseHelper *)> task,
+                                       const QueryCancelToken &token)
+{
+    QFutureInterface<T> promise;
+    promise.reportStarted();
+    QFuture<T> future = promise.future();
+
+    DatabaseHelper *helper = databaseHelper;
+    const std::atomic<bool> *stopping = &this->stopping;
+    enqueue([promise, task, token, helper, stopping]() mutable {
+        // 析构时仍在排队的查询不再执行，直接以取消结束
+        if (token.isCancelled() || promise.isCanceled() || stopping->load()) {
+            promise.reportCanceled();
+            promise.reportFinished();
+            return;
+        }
+
+        const T result = task(helper);
+
+        // 执行期间被取消的查询不再交付结果
+        if (token.isCancelled() || promise.isCanceled()) {
+            promise.reportCanceled();
+        } else {
+            promise.reportResult(result);
+        }
+        promise.reportFinished();
+    });
+
+    return future;
+}
+
+#endif // ASYNCDATABASEHELPER_H
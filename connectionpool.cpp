@@ -0,0 +1,371 @@
+#include "connectionpool.h"
+#include <QThread>
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QAtomicInteger>
+#include <QSqlQuery>
+
+namespace {
+QAtomicInteger<quint32> poolCounter(0);
+}
+
+ConnectionPool::ConnectionPool(const QString &driverName, QObject *parent)
+    : QObject(parent)
+    , driverName(driverName)
+    , connectionPrefix(QString("flightsystem_pool%1").arg(poolCounter.fetchAndAddRelaxed(1)))
+    , maxConnectionCount(QThread::idealThreadCount() + 2)
+    , maxIdleMsecs(5 * 60 * 1000)
+    , acquireTimeoutMsecs(10000)
+    , connectionSerial(0)
+    , statementHits(0)
+    , statementMisses(0)
+    , reapTimer(new QTimer(this))
+{
+    reapTimer->setInterval(60 * 1000);
+    connect(reapTimer, &QTimer::timeout, this, &ConnectionPool::reapIdleConnections);
+    reapTimer->start();
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    // 池随 DatabaseHelper 一起销毁，此时使用它的工作线程应当都已结束，剩余连接只能在这里移除
+    QMutexLocker locker(&mutex);
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+        removeConnectionLocked(*it);
+    }
+    connections.clear();
+}
+
+void ConnectionPool::setDatabaseName(const QString &name)
+{
+    QMutexLocker locker(&mutex);
+    dbName = name;
+}
+
+QString ConnectionPool::databaseName() const
+{
+    QMutexLocker locker(&mutex);
+    return dbName;
+}
+
+void ConnectionPool::setMaxConnections(int count)
+{
+    QMutexLocker locker(&mutex);
+    maxConnectionCount = qMax(1, count);
+    slotAvailable.wakeAll();
+}
+
+int ConnectionPool::maxConnections() const
+{
+    QMutexLocker locker(&mutex);
+    return maxConnectionCount;
+}
+
+void ConnectionPool::setMaxIdleTime(int msecs)
+{
+    QMutexLocker locker(&mutex);
+    maxIdleMsecs = msecs;
+}
+
+int ConnectionPool::maxIdleTime() const
+{
+    QMutexLocker locker(&mutex);
+    return maxIdleMsecs;
+}
+
+void ConnectionPool::setAcquireTimeout(int msecs)
+{
+    QMutexLocker locker(&mutex);
+    acquireTimeoutMsecs = msecs;
+}
+
+int ConnectionPool::acquireTimeout() const
+{
+    QMutexLocker locker(&mutex);
+    return acquireTimeoutMsecs;
+}
+
+void ConnectionPool::setInitStatements(const QStringList &statements)
+{
+    QMutexLocker locker(&mutex);
+    initSql = statements;
+}
+
+QStringList ConnectionPool::initStatements() const
+{
+    QMutexLocker locker(&mutex);
+    return initSql;
+}
+
+QSqlDatabase ConnectionPool::acquire()
+{
+    QThread *thread = QThread::currentThread();
+    QMutexLocker locker(&mutex);
+
+    auto it = connections.find(thread);
+    if (it != connections.end() && it->stale && it->pins == 0) {
+        // 被回收或切换数据库的连接由所属线程自己关闭，随后按当前参数新建
+        removeConnectionLocked(*it);
+        connections.erase(it);
+        slotAvailable.wakeOne();
+        it = connections.end();
+    }
+    if (it != connections.end()) {
+        it->lastUsed.restart();
+        if (!it->database.isOpen()) {
+            // 连接被关闭后旧语句全部失效
+            it->statements->clear();
+        }
+        QSqlDatabase database = it->database;
+        const QString name = it->name;
+        locker.unlock();
+        if (!database.isOpen()) {
+            openConnection(database, name);
+        }
+        return database;
+    }
+
+    // 池已满时先尝试回收空闲连接，再等待其他线程归还
+    QDeadlineTimer deadline(acquireTimeoutMsecs);
+    while (connections.size() >= maxConnectionCount) {
+        if (reapIdleLocked() > 0) {
+            continue;
+        }
+        if (!slotAvailable.wait(&mutex, deadline)) {
+            locker.unlock();
+            emit connectionError(QString("连接池已满 (%1 个连接)，等待超时").arg(maxConnections()));
+            return QSqlDatabase();
+        }
+    }
+
+    PooledConnection connection;
+    connection.name = QString("%1_conn%2").arg(connectionPrefix).arg(++connectionSerial);
+    connection.database = QSqlDatabase::addDatabase(driverName, connection.name);
+    connection.database.setDatabaseName(dbName);
+    connection.statements = std::make_shared<PreparedStatementCache>();
+    connection.lastUsed.start();
+    connection.owner = thread;
+
+    // 线程结束时在该线程内归还连接
+    if (QCoreApplication::instance() && thread != QCoreApplication::instance()->thread()) {
+        connection.finishedConnection = connect(thread, &QThread::finished, this, [this, thread]() {
+            releaseThread(thread);
+        }, Qt::DirectConnection);
+    }
+
+    QSqlDatabase database = connection.database;
+    const QString name = connection.name;
+    connections.insert(thread, connection);
+    locker.unlock();
+
+    openConnection(database, name);
+    return database;
+}
+
+bool ConnectionPool::openConnection(QSqlDatabase &database, const QString &name)
+{
+    if (!database.open()) {
+        emit connectionError(QString("无法打开连接 %1: %2").arg(name, database.lastError().text()));
+        return false;
+    }
+
+    QSqlQuery query(database);
+    for (const QString &statement : initStatements()) {
+        if (!query.exec(statement)) {
+            emit connectionError(QString("连接初始化失败 (%1): %2").arg(statement, query.lastError().text()));
+        }
+    }
+
+    emit connectionOpened(name);
+    return true;
+}
+
+QSqlQuery ConnectionPool::prepare(const QString &sql)
+{
+    QSqlDatabase database = acquire();
+
+    std::shared_ptr<PreparedStatementCache> cache;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = connections.constFind(QThread::currentThread());
+        if (it != connections.constEnd()) {
+            cache = it->statements;
+        }
+    }
+
+    if (!cache) {
+        QSqlQuery query(database);
+        query.prepare(sql);
+        return query;
+    }
+
+    bool hit = false;
+    QSqlQuery query = cache->statement(database, sql, &hit);
+    if (hit) {
+        statementHits.fetchAndAddRelaxed(1);
+    } else {
+        statementMisses.fetchAndAddRelaxed(1);
+    }
+    return query;
+}
+
+quint64 ConnectionPool::statementCacheHits() const
+{
+    return statementHits.loadRelaxed();
+}
+
+quint64 ConnectionPool::statementCacheMisses() const
+{
+    return statementMisses.loadRelaxed();
+}
+
+void ConnectionPool::release()
+{
+    releaseThread(QThread::currentThread());
+}
+
+void ConnectionPool::releaseThread(QThread *thread)
+{
+    QMutexLocker locker(&mutex);
+    auto it = connections.find(thread);
+    if (it == connections.end()) {
+        return;
+    }
+    removeConnectionLocked(*it);
+    connections.erase(it);
+    slotAvailable.wakeOne();
+}
+
+int ConnectionPool::reapIdleConnections()
+{
+    QMutexLocker locker(&mutex);
+    return reapIdleLocked();
+}
+
+int ConnectionPool::reapIdleLocked()
+{
+    if (maxIdleMsecs <= 0) {
+        return 0;
+    }
+
+    int reaped = 0;
+    for (auto it = connections.begin(); it != connections.end();) {
+        // lastUsed 只在 acquire() 和钉住/释放时刷新，游标和事务期间靠钉住计数保护
+        if (it->pins > 0 || !it->lastUsed.hasExpired(maxIdleMsecs)) {
+            ++it;
+            continue;
+        }
+        if (closableLocked(*it)) {
+            removeConnectionLocked(*it);
+            it = connections.erase(it);
+            ++reaped;
+        } else {
+            it->stale = true;
+            ++it;
+        }
+    }
+
+    if (reaped > 0) {
+        slotAvailable.wakeAll();
+    }
+    return reaped;
+}
+
+void ConnectionPool::closeAll()
+{
+    QMutexLocker locker(&mutex);
+    for (auto it = connections.begin(); it != connections.end();) {
+        if (it->pins == 0 && closableLocked(*it)) {
+            removeConnectionLocked(*it);
+            it = connections.erase(it);
+        } else {
+            it->stale = true;
+            ++it;
+        }
+    }
+    slotAvailable.wakeAll();
+}
+
+bool ConnectionPool::isPinned() const
+{
+    QMutexLocker locker(&mutex);
+    auto it = connections.constFind(QThread::currentThread());
+    return it != connections.constEnd() && it->pins > 0;
+}
+
+bool ConnectionPool::closableLocked(const PooledConnection &connection) const
+{
+    return !connection.owner || connection.owner == QThread::currentThread() || connection.owner->isFinished();
+}
+
+bool ConnectionPool::pin(QThread *thread)
+{
+    QMutexLocker locker(&mutex);
+    auto it = connections.find(thread);
+    if (it == connections.end()) {
+        return false;
+    }
+    ++it->pins;
+    it->lastUsed.restart();
+    return true;
+}
+
+void ConnectionPool::unpin(QThread *thread)
+{
+    QMutexLocker locker(&mutex);
+    auto it = connections.find(thread);
+    if (it == connections.end() || it->pins == 0) {
+        return;
+    }
+    --it->pins;
+    it->lastUsed.restart();
+
+    // 钉住期间被标记过期的连接，在所属线程上释放最后一个钉住时关闭
+    if (it->pins == 0 && it->stale && thread == QThread::currentThread()) {
+        removeConnectionLocked(*it);
+        connections.erase(it);
+        slotAvailable.wakeOne();
+    }
+}
+
+int ConnectionPool::connectionCount() const
+{
+    QMutexLocker locker(&mutex);
+    return connections.size();
+}
+
+void ConnectionPool::removeConnectionLocked(PooledConnection &connection)
+{
+    if (connection.finishedConnection) {
+        disconnect(connection.finishedConnection);
+    }
+    // 先释放语句，否则连接关闭时仍有未完成的语句
+    if (connection.statements) {
+        connection.statements->clear();
+    }
+    if (connection.database.isOpen()) {
+        connection.database.close();
+    }
+    // removeDatabase 要求不再持有任何 QSqlDatabase 副本
+    connection.database = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connection.name);
+}
+
+ConnectionPin::ConnectionPin(ConnectionPool *pool)
+    : pool(pool)
+    , thread(QThread::currentThread())
+    , pinned(false)
+{
+    if (pool) {
+        pool->acquire();
+        pinned = pool->pin(thread);
+    }
+}
+
+ConnectionPin::~ConnectionPin()
+{
+    if (pool && pinned) {
+        pool->unpin(thread);
+    }
+}
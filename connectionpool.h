@@ -0,0 +1,129 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QAtomicInteger>
+#include <QPointer>
+#include <memory>
+#include "preparedstatementcache.h"
+
+class QThread;
+
+// 按线程分配的数据库连接池
+// QSqlDatabase 只能在创建它的线程中使用，因此池为每个工作线程维护一个独立命名的连接，
+// 线程结束时自动归还。空闲超时的连接由定时器回收：属于调用线程（或所属线程已结束）的连接
+// 直接关闭，其他线程的连接只标记为过期，由所属线程在下一次 acquire() 或线程结束时自行关闭。
+// 被 ConnectionPin 钉住的连接（打开的游标、进行中的事务）不会被回收。
+class ConnectionPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConnectionPool(const QString &driverName = "QSQLITE", QObject *parent = nullptr);
+    ~ConnectionPool();
+
+    // 连接参数
+    void setDatabaseName(const QString &name);
+    QString databaseName() const;
+
+    // 池限制
+    void setMaxConnections(int count);
+    int maxConnections() const;
+    void setMaxIdleTime(int msecs);
+    int maxIdleTime() const;
+    void setAcquireTimeout(int msecs);
+    int acquireTimeout() const;
+
+    // 每个新连接打开后依次执行的初始化语句（如 PRAGMA）
+    void setInitStatements(const QStringList &statements);
+    QStringList initStatements() const;
+
+    // 获取当前线程的连接，不存在时创建并打开；池已满时等待其他线程归还
+    QSqlDatabase acquire();
+    // 当前线程连接上的预编译语句，相同 SQL 复用同一语句
+    QSqlQuery prepare(const QString &sql);
+    quint64 statementCacheHits() const;
+    quint64 statementCacheMisses() const;
+
+    // 归还当前线程的连接
+    void release();
+    // 回收空闲超时的连接，返回实际关闭的数量（其他线程的连接只做标记，不计入）
+    int reapIdleConnections();
+    // 关闭调用线程和已结束线程的连接，其余连接标记为过期，所属线程下次使用时按当前参数重新打开
+    void closeAll();
+    // 当前线程的连接是否被钉住
+    bool isPinned() const;
+
+    int connectionCount() const;
+
+signals:
+    void connectionOpened(const QString &connectionName);
+    void connectionError(const QString &error);
+
+private:
+    friend class ConnectionPin;
+
+    struct PooledConnection {
+        QString name;
+        QSqlDatabase database;
+        std::shared_ptr<PreparedStatementCache> statements;
+        QElapsedTimer lastUsed;
+        QMetaObject::Connection finishedConnection;
+        QPointer<QThread> owner;
+        int pins = 0;           // 打开的游标和事务数，大于 0 时不回收
+        bool stale = false;     // 已被回收或切换了数据库，等所属线程关闭
+    };
+
+    QString driverName;
+    QString dbName;
+    QString connectionPrefix;
+    QStringList initSql;
+    int maxConnectionCount;
+    int maxIdleMsecs;
+    int acquireTimeoutMsecs;
+    quint64 connectionSerial;
+    QAtomicInteger<quint64> statementHits;
+    QAtomicInteger<quint64> statementMisses;
+
+    mutable QMutex mutex;
+    QWaitCondition slotAvailable;
+    QHash<QThread *, PooledConnection> connections;
+    QTimer *reapTimer;
+
+    bool openConnection(QSqlDatabase &database, const QString &name);
+    void releaseThread(QThread *thread);
+    int reapIdleLocked();
+    // 所属线程已结束或就是调用线程时才能直接关闭
+    bool closableLocked(const PooledConnection &connection) const;
+    void removeConnectionLocked(PooledConnection &connection);
+    bool pin(QThread *thread);
+    void unpin(QThread *thread);
+};
+
+// 在作用域内钉住当前线程的连接，使其不被回收或因数据库切换而关闭
+// 跨多次调用的游标和显式事务在开始前创建，结束后释放；只能在创建它的线程中析构
+class ConnectionPin
+{
+public:
+    explicit ConnectionPin(ConnectionPool *pool);
+    ~ConnectionPin();
+
+    ConnectionPin(const ConnectionPin &) = delete;
+    ConnectionPin &operator=(const ConnectionPin &) = delete;
+
+private:
+    QPointer<ConnectionPool> pool;
+    QThread *thread;
+    bool pinned;
+};
+
+#endif // CONNECTIONPOOL_H
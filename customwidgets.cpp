@@ -338,7 +338,13 @@ void LoadingWidget::updateAnimation()
 // ModernSearchBox 实现
 ModernSearchBox::ModernSearchBox(QWidget *parent)
     : QWidget(parent)
+    , debounceTimer(new QTimer(this))
 {
+    // 连续输入时不断重启同一个计时器，停顿后才搜索一次
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(300);
+    connect(debounceTimer, &QTimer::timeout, this, &ModernSearchBox::onDebounceTimeout);
+    
     setupUI();
 }
 
@@ -394,7 +400,9 @@ void ModernSearchBox::setupUI()
     layout->addWidget(clearButton);
     layout->addWidget(searchButton);
     
+    // 只有用户输入触发自动搜索，clear() 和程序设置文本不会
     connect(searchEdit, &QLineEdit::textChanged, this, &ModernSearchBox::onTextChanged);
+    connect(searchEdit, &QLineEdit::textEdited, this, &ModernSearchBox::onTextEdited);
     connect(searchButton, &QPushButton::clicked, this, &ModernSearchBox::onSearchClicked);
     connect(clearButton, &QPushButton::clicked, searchEdit, &QLineEdit::clear);
     connect(searchEdit, &QLineEdit::returnPressed, this, &ModernSearchBox::onSearchClicked);
@@ -415,18 +423,47 @@ void ModernSearchBox::clear()
     searchEdit->clear();
 }
 
+void ModernSearchBox::setDebounceInterval(int msec)
+{
+    debounceTimer->stop();
+    debounceTimer->setInterval(qMax(0, msec));
+}
+
+int ModernSearchBox::debounceInterval() const
+{
+    return debounceTimer->interval();
+}
+
 void ModernSearchBox::onTextChanged(const QString &text)
 {
     clearButton->setVisible(!text.isEmpty());
+    // 清空后不再搜索之前输入的内容
+    if (text.isEmpty()) {
+        debounceTimer->stop();
+    }
     emit textChanged(text);
 }
 
+void ModernSearchBox::onTextEdited(const QString &text)
+{
+    if (debounceTimer->interval() > 0 && !text.isEmpty()) {
+        debounceTimer->start();
+    }
+}
+
 void ModernSearchBox::onSearchClicked()
 {
+    debounceTimer->stop();
     emit searchRequested(searchEdit->text());
     emit returnPressed();
 }
 
+void ModernSearchBox::onDebounceTimeout()
+{
+    if (searchEdit->text().isEmpty()) return;
+    emit searchRequested(searchEdit->text());
+}
+
 // FlightInfoCard 实现
 FlightInfoCard::FlightInfoCard(const QJsonObject &flightData, QWidget *parent)
     : QFrame(parent), m_flightData(flightData), m_isHovered(false)
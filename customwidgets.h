@@ -155,6 +155,11 @@ public:
     void setPlaceholderText(const QString &text);
     QString text() const;
     void clear();
+    
+    // 用户输入停止多久后自动发出 searchRequested，0 表示只在点击或回车时搜索；
+    // 文本为空时不自动搜索
+    void setDebounceInterval(int msec);
+    int debounceInterval() const;
 
 signals:
     void textChanged(const QString &text);
@@ -163,13 +168,16 @@ signals:
 
 private slots:
     void onTextChanged(const QString &text);
+    void onTextEdited(const QString &text);
     void onSearchClicked();
+    void onDebounceTimeout();
 
 private:
     QLineEdit *searchEdit;
     QPushButton *searchButton;
     QPushButton *clearButton;
     QHBoxLayout *layout;
+    QTimer *debounceTimer;
     
     void setupUI();
 };
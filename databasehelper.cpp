@@ -1,12 +1,499 @@
 #include "databasehelper.h"
-#include <QSqlRecord>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QDate>
+#include <QSet>
+#include <QMetaMethod>
 #include <QDebug>
 
+// 各表的查询列，顺序与下方 decode* 函数使用的列序号一致
+#define FLIGHT_COLUMNS "id, flight_number, airline, departure, destination, departure_time, " \
+                       "arrival_time, status, gate, aircraft, created_at, " \
+                       "price_economy, price_business, price_first"
+#define USER_COLUMNS "id, username, password, email, phone, first_name, last_name, role, status, created_at"
+#define BOOKING_COLUMNS "id, user_id, flight_number, booking_date, status, total_price, " \
+                        "passenger_count, created_at"
+#define PASSENGER_COLUMNS "id, booking_id, first_name, last_name, id_number, seat_number, class_type"
+
+namespace {
+
+const char FLIGHT_BY_NUMBER_SQL[] = "SELECT " FLIGHT_COLUMNS " FROM flights WHERE flight_number = ?";
+const char USER_BY_NAME_SQL[] = "SELECT " USER_COLUMNS " FROM users WHERE username = ?";
+const char BOOKINGS_BY_USER_SQL[] = "SELECT " BOOKING_COLUMNS " FROM bookings WHERE user_id = ? ORDER BY created_at";
+const char BOOKING_BY_ID_SQL[] = "SELECT " BOOKING_COLUMNS " FROM bookings WHERE id = ?";
+const char PASSENGERS_BY_BOOKING_SQL[] = "SELECT " PASSENGER_COLUMNS " FROM passengers WHERE booking_id = ?";
+
+Flight decodeFlight(const QSqlQuery &query)
+{
+    Flight flight;
+    flight.id = query.value(0).toLongLong();
+    flight.flightNumber = query.value(1).toString();
+    flight.airline = query.value(2).toString();
+    flight.departure = query.value(3).toString();
+    flight.destination = query.value(4).toString();
+    flight.departureTime = query.value(5).toString();
+    flight.arrivalTime = query.value(6).toString();
+    flight.status = query.value(7).toString();
+    flight.gate = query.value(8).toString();
+    flight.aircraft = query.value(9).toString();
+    flight.createdAt = query.value(10).toString();
+    flight.economyPrice = query.value(11).toDouble();
+    flight.businessPrice = query.value(12).toDouble();
+    flight.firstPrice = query.value(13).toDouble();
+    return flight;
+}
+
+User decodeUser(const QSqlQuery &query)
+{
+    User user;
+    user.id = query.value(0).toLongLong();
+    user.username = query.value(1).toString();
+    user.password = query.value(2).toString();
+    user.email = query.value(3).toString();
+    user.phone = query.value(4).toString();
+    user.firstName = query.value(5).toString();
+    user.lastName = query.value(6).toString();
+    user.role = query.value(7).toString();
+    user.status = query.value(8).toString();
+    user.createdAt = query.value(9).toString();
+    return user;
+}
+
+Booking decodeBooking(const QSqlQuery &query)
+{
+    Booking booking;
+    booking.id = query.value(0).toLongLong();
+    booking.userId = query.value(1).toLongLong();
+    booking.flightNumber = query.value(2).toString();
+    booking.bookingDate = query.value(3).toString();
+    booking.status = query.value(4).toString();
+    booking.totalPrice = query.value(5).toDouble();
+    booking.passengerCount = query.value(6).toInt();
+    booking.createdAt = query.value(7).toString();
+    return booking;
+}
+
+Passenger decodePassenger(const QSqlQuery &query)
+{
+    Passenger passenger;
+    passenger.id = query.value(0).toLongLong();
+    passenger.bookingId = query.value(1).toLongLong();
+    passenger.firstName = query.value(2).toString();
+    passenger.lastName = query.value(3).toString();
+    passenger.idNumber = query.value(4).toString();
+    passenger.seatNumber = query.value(5).toString();
+    passenger.classType = query.value(6).toString();
+    return passenger;
+}
+
+// 票价可能是 JSON 数值或 CSV 中的字符串，缺失时写入 NULL
+QVariant priceValue(const QJsonValue &value)
+{
+    if (value.isDouble()) {
+        return value.toDouble();
+    }
+    
+    bool ok = false;
+    const double price = value.toString().toDouble(&ok);
+    return ok ? QVariant(price) : QVariant();
+}
+
+const char *const IMPORT_COLUMNS[] = {
+    "flight_number", "airline", "departure", "destination",
+    "departure_time", "arrival_time", "status", "gate", "aircraft",
+    "price_economy", "price_business", "price_first"
+};
+const int IMPORT_COLUMN_COUNT = int(sizeof(IMPORT_COLUMNS) / sizeof(IMPORT_COLUMNS[0]));
+const int IMPORT_STATUS_COLUMN = 6;
+const int IMPORT_FIRST_PRICE_COLUMN = 9;
+
+// 导入用的 upsert；缺失的票价不覆盖已有值，不带 status 列时插入由表默认值补上
+QString flightUpsertSql(bool withStatus)
+{
+    QStringList columns;
+    QStringList placeholders;
+    QStringList updates;
+    for (int i = 0; i < IMPORT_COLUMN_COUNT; ++i) {
+        if (i == IMPORT_STATUS_COLUMN && !withStatus) {
+            continue;
+        }
+        const QString column = IMPORT_COLUMNS[i];
+        columns << column;
+        placeholders << "?";
+        if (i == 0) {
+            continue;
+        }
+        if (i == IMPORT_STATUS_COLUMN || i >= IMPORT_FIRST_PRICE_COLUMN) {
+            updates << QString("%1 = COALESCE(excluded.%1, flights.%1)").arg(column);
+        } else {
+            updates << QString("%1 = excluded.%1").arg(column);
+        }
+    }
+    return QString("INSERT INTO flights (%1) VALUES (%2) ON CONFLICT(flight_number) DO UPDATE SET %3")
+        .arg(columns.join(", "), placeholders.join(", "), updates.join(", "));
+}
+
+// 按列绑定后一次 execBatch；空批次直接成功
+bool execFlightBatch(QSqlQuery &query, const QVector<QJsonObject> &flights, bool withStatus)
+{
+    if (flights.isEmpty()) {
+        return true;
+    }
+    
+    for (int i = 0; i < IMPORT_COLUMN_COUNT; ++i) {
+        if (i == IMPORT_STATUS_COLUMN && !withStatus) {
+            continue;
+        }
+        QVariantList column;
+        column.reserve(flights.size());
+        for (const QJsonObject &flight : flights) {
+            if (i < IMPORT_FIRST_PRICE_COLUMN) {
+                column.append(flight[IMPORT_COLUMNS[i]].toString());
+            } else {
+                column.append(priceValue(flight[IMPORT_COLUMNS[i]]));
+            }
+        }
+        query.addBindValue(column);
+    }
+    return query.execBatch();
+}
+
+// 航班列表查询语句，条件为空时省略对应过滤
+QString flightSearchSql(bool byDeparture, bool byDestination)
+{
+    QString sql = "SELECT " FLIGHT_COLUMNS " FROM flights WHERE 1=1";
+    if (byDeparture) {
+        sql += " AND departure = ?";
+    }
+    if (byDestination) {
+        sql += " AND destination = ?";
+    }
+    return sql;
+}
+
+// 键集分页语句：以 (sortColumn, id) 行值比较定位上一页末尾，
+// 配合以 sortColumn 结尾的索引，任意一页都只需一次索引查找，与页码无关
+QString keysetPageSql(const QString &select, QStringList conditions, const QString &sortColumn,
+                      bool afterKey)
+{
+    if (afterKey) {
+        conditions.append(QString("(%1, id) > (?, ?)").arg(sortColumn));
+    }
+    
+    QString sql = select;
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += QString(" ORDER BY %1, id LIMIT ?").arg(sortColumn);
+    return sql;
+}
+
+QString flightPageSql(bool byDeparture, bool byDestination, bool afterKey)
+{
+    QStringList conditions;
+    if (byDeparture) {
+        conditions.append("departure = ?");
+    }
+    if (byDestination) {
+        conditions.append("destination = ?");
+    }
+    return keysetPageSql("SELECT " FLIGHT_COLUMNS " FROM flights", conditions, "departure_time", afterKey);
+}
+
+QString userPageSql(bool afterKey)
+{
+    return keysetPageSql("SELECT " USER_COLUMNS " FROM users", QStringList(), "created_at", afterKey);
+}
+
+QString bookingPageSql(bool byUser, bool afterKey)
+{
+    QStringList conditions;
+    if (byUser) {
+        conditions.append("user_id = ?");
+    }
+    return keysetPageSql("SELECT " BOOKING_COLUMNS " FROM bookings", conditions, "created_at", afterKey);
+}
+
+// 统计计数维度：scope 为计数器类别，key 为计数键表达式，其中 %1 替换为 NEW、OLD 或表名
+struct CounterDimension
+{
+    const char *scope;
+    const char *key;
+};
+
+struct CounterTable
+{
+    const char *table;
+    QVector<CounterDimension> dimensions;
+};
+
+const char SEAT_INVENTORY_COLUMNS_SQL[] =
+    "SELECT flight_number, class_type, capacity, available, version FROM seat_inventory";
+const int MAX_BOOKING_ATTEMPTS = 5;
+
+SeatInventory decodeSeatInventory(const QSqlQuery &query)
+{
+    SeatInventory inventory;
+    inventory.flightNumber = query.value(0).toString();
+    inventory.classType = query.value(1).toString();
+    inventory.capacity = query.value(2).toInt();
+    inventory.available = query.value(3).toInt();
+    inventory.version = query.value(4).toLongLong();
+    return inventory;
+}
+
+QString cabinOf(const Passenger &passenger)
+{
+    return passenger.classType.isEmpty() ? QString("经济舱") : passenger.classType;
+}
+
+const char COUNTER_VALUE_SQL[] = "SELECT value FROM stat_counters WHERE scope = ? AND key = ?";
+
+const QVector<CounterTable> &counterTables()
+{
+    static const QVector<CounterTable> tables = {
+        {"flights", {
+            {"flights", "'total'"},
+            {"flight_status", "COALESCE(%1.status, '')"},
+            {"flight_route", "%1.departure || '-' || %1.destination"},
+            {"flight_day", "COALESCE(date(%1.departure_time), '')"}
+        }},
+        {"users", {
+            {"users", "'total'"},
+            {"user_status", "COALESCE(%1.status, '')"},
+            {"user_role", "COALESCE(%1.role, '')"}
+        }},
+        {"bookings", {
+            {"bookings", "'total'"},
+            {"booking_status", "COALESCE(%1.status, '')"},
+            {"booking_day", "COALESCE(date(%1.created_at), '')"}
+        }}
+    };
+    return tables;
+}
+
+QString counterKey(const CounterDimension &dimension, const QString &row)
+{
+    return QString(dimension.key).replace("%1", row);
+}
+
+// 触发器体：row 的每个维度计数加一或减一
+QString counterChangeSql(const CounterTable &table, const QString &row, bool increment)
+{
+    QString sql;
+    for (const CounterDimension &dimension : table.dimensions) {
+        if (increment) {
+            sql += QString("INSERT INTO stat_counters (scope, key, value) VALUES ('%1', %2, 1) "
+                           "ON CONFLICT (scope, key) DO UPDATE SET value = value + 1; ")
+                       .arg(dimension.scope, counterKey(dimension, row));
+        } else {
+            sql += QString("UPDATE stat_counters SET value = value - 1 WHERE scope = '%1' AND key = %2; ")
+                       .arg(dimension.scope, counterKey(dimension, row));
+        }
+    }
+    return sql;
+}
+
+QStringList counterTriggerSql(const CounterTable &table)
+{
+    const QString name = table.table;
+    return {
+        QString("CREATE TRIGGER IF NOT EXISTS trg_%1_stats_insert AFTER INSERT ON %1 BEGIN %2END")
+            .arg(name, counterChangeSql(table, "NEW", true)),
+        QString("CREATE TRIGGER IF NOT EXISTS trg_%1_stats_delete AFTER DELETE ON %1 BEGIN %2END")
+            .arg(name, counterChangeSql(table, "OLD", false)),
+        QString("CREATE TRIGGER IF NOT EXISTS trg_%1_stats_update AFTER UPDATE ON %1 BEGIN %2END")
+            .arg(name, counterChangeSql(table, "OLD", false) + counterChangeSql(table, "NEW", true))
+    };
+}
+
+QStringList counterBackfillSql(const CounterTable &table)
+{
+    QStringList statements;
+    for (const CounterDimension &dimension : table.dimensions) {
+        statements.append(QString("INSERT INTO stat_counters (scope, key, value) "
+                                  "SELECT '%1', %2, COUNT(*) FROM %3 GROUP BY 2")
+                              .arg(dimension.scope, counterKey(dimension, table.table), table.table));
+    }
+    return statements;
+}
+
+// 缓存条目的估算内存占用：结构体本身加字符串内容
+qint64 footprint(const Flight &flight)
+{
+    const QString *fields[] = {
+        &flight.flightNumber, &flight.airline, &flight.departure, &flight.destination,
+        &flight.departureTime, &flight.arrivalTime, &flight.status, &flight.gate,
+        &flight.aircraft, &flight.createdAt
+    };
+    qint64 bytes = sizeof(Flight) + flight.flightNumber.size() * sizeof(QChar);
+    for (const QString *field : fields) {
+        bytes += field->size() * sizeof(QChar);
+    }
+    return bytes;
+}
+
+qint64 footprint(const User &user)
+{
+    const QString *fields[] = {
+        &user.username, &user.password, &user.email, &user.phone, &user.firstName,
+        &user.lastName, &user.role, &user.status, &user.createdAt
+    };
+    qint64 bytes = sizeof(User) + user.username.size() * sizeof(QChar);
+    for (const QString *field : fields) {
+        bytes += field->size() * sizeof(QChar);
+    }
+    return bytes;
+}
+
+QJsonObject cacheStatisticsJson(const CacheStatistics &statistics)
+{
+    QJsonObject stats;
+    stats["hits"] = QString::number(statistics.hits);
+    stats["misses"] = QString::number(statistics.misses);
+    stats["evictions"] = QString::number(statistics.evictions);
+    stats["entries"] = statistics.entries;
+    stats["bytes"] = QString::number(statistics.bytes);
+    stats["hit_ratio"] = statistics.hitRatio();
+    return stats;
+}
+
+// 绑定分页位置和 LIMIT 后执行，多取一行用于判断是否还有下一页
+template<typename T>
+Page<T> readPage(QSqlQuery &query, const PageKey &after, int pageSize, int sortColumn,
+                 T (*decode)(const QSqlQuery &))
+{
+    Page<T> page;
+    // 空页沿用原位置，调用方不会因为 next 变回首页而从头再读一遍
+    page.next = after;
+    
+    if (!after.isFirst()) {
+        query.addBindValue(after.sortValue);
+        query.addBindValue(after.id);
+    }
+    query.addBindValue(pageSize + 1);
+    
+    if (!query.exec()) {
+        return page;
+    }
+    
+    page.items.reserve(pageSize);
+    while (query.next()) {
+        if (page.items.size() == pageSize) {
+            page.hasMore = true;
+            break;
+        }
+        page.items.append(decode(query));
+        page.next.sortValue = query.value(sortColumn).toString();
+        page.next.id = page.items.last().id;
+    }
+    query.finish();
+    
+    return page;
+}
+
+}
+
+FlightCursor::FlightCursor()
+    : batchSize(0)
+    , opened(false)
+    , finished(true)
+    , rows(0)
+{
+}
+
+FlightCursor::FlightCursor(const QSqlQuery &query, int batchSize, std::shared_ptr<ConnectionPin> pin)
+    : query(query)
+    , pin(std::move(pin))
+    , batchSize(qMax(1, batchSize))
+    , opened(query.isActive())
+    , finished(!query.isActive())
+    , rows(0)
+{
+}
+
+bool FlightCursor::isValid() const
+{
+    return opened;
+}
+
+bool FlightCursor::atEnd() const
+{
+    return finished;
+}
+
+QVector<Flight> FlightCursor::nextBatch()
+{
+    QVector<Flight> batch;
+    if (finished) {
+        return batch;
+    }
+    
+    batch.reserve(batchSize);
+    while (batch.size() < batchSize) {
+        if (!query.next()) {
+            close();
+            break;
+        }
+        batch.append(decodeFlight(query));
+    }
+    
+    rows += batch.size();
+    return batch;
+}
+
+qint64 FlightCursor::rowsRead() const
+{
+    return rows;
+}
+
+void FlightCursor::close()
+{
+    finished = true;
+    query.finish();
+    pin.reset();
+}
+
+StorageProfile StorageProfile::concurrentProfile()
+{
+    return StorageProfile();
+}
+
+StorageProfile StorageProfile::legacyProfile()
+{
+    StorageProfile legacy;
+    legacy.journalMode = "DELETE";
+    legacy.synchronous = "FULL";
+    legacy.cacheSizeKb = 2000;
+    legacy.mmapSize = 0;
+    legacy.tempStore = "DEFAULT";
+    legacy.busyTimeoutMs = 0;
+    return legacy;
+}
+
+QStringList StorageProfile::pragmas() const
+{
+    // page_size 必须先于 journal_mode 设置，WAL 模式下无法再修改页大小
+    return {
+        QString("PRAGMA page_size = %1").arg(pageSize),
+        QString("PRAGMA journal_mode = %1").arg(journalMode),
+        QString("PRAGMA synchronous = %1").arg(synchronous),
+        QString("PRAGMA cache_size = -%1").arg(cacheSizeKb),
+        QString("PRAGMA mmap_size = %1").arg(mmapSize),
+        QString("PRAGMA temp_store = %1").arg(tempStore),
+        QString("PRAGMA busy_timeout = %1").arg(busyTimeoutMs)
+    };
+}
+
 DatabaseHelper::DatabaseHelper(QObject *parent)
     : QObject(parent)
+    , connectionPool(new ConnectionPool("QSQLITE", this))
     , isConnected(false)
 {
-    database = QSqlDatabase::addDatabase("QSQLITE");
+    connect(connectionPool, &ConnectionPool::connectionError, this, &DatabaseHelper::databaseError);
+    setStorageProfile(StorageProfile::concurrentProfile());
 }
 
 DatabaseHelper::~DatabaseHelper()
@@ -21,324 +508,1196 @@ bool DatabaseHelper::connectToDatabase(const QString &hostName, const QString &d
     Q_UNUSED(username);
     Q_UNUSED(password);
     
-    database.setDatabaseName(dbName.isEmpty() ? "flightsystem.db" : dbName);
+    // 重新连接时丢弃指向旧数据库文件的连接
+    connectionPool->closeAll();
+    clearLookupCaches();
+    connectionPool->setDatabaseName(dbName.isEmpty() ? "flightsystem.db" : dbName);
+    
+    QSqlDatabase database = connection();
+    if (!database.isOpen()) {
+        emit databaseError(QString("无法连接数据库: %1").arg(database.lastError().text()));
+        return false;
+    }
+    
+    isConnected = true;
+    createTables();
+    emit databaseConnected();
+    return true;
+}
+
+bool DatabaseHelper::insertFlight(const QJsonObject &flightData)
+{
+    if (!isConnected) return false;
+    
+    QSqlQuery query = connectionPool->prepare(
+        "INSERT INTO flights (flight_number, airline, departure, destination, "
+        "departure_time, arrival_time, status, gate, aircraft, "
+        "price_economy, price_business, price_first) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    
+    query.addBindValue(flightData["flight_number"].toString());
+    query.addBindValue(flightData["airline"].toString());
+    query.addBindValue(flightData["departure"].toString());
+    query.addBindValue(flightData["destination"].toString());
+    query.addBindValue(flightData["departure_time"].toString());
+    query.addBindValue(flightData["arrival_time"].toString());
+    query.addBindValue(flightData["status"].toString());
+    query.addBindValue(flightData["gate"].toString());
+    query.addBindValue(flightData["aircraft"].toString());
+    query.addBindValue(priceValue(flightData["price_economy"]));
+    query.addBindValue(priceValue(flightData["price_business"]));
+    query.addBindValue(priceValue(flightData["price_first"]));
+    
+    if (!query.exec()) {
+        return false;
+    }
+    
+    emit routeChanged(flightData["departure"].toString(), flightData["destination"].toString());
+    return true;
+}
+
+QJsonArray DatabaseHelper::getFlights(const QString &departure, const QString &destination)
+{
+    QJsonArray flights;
+    
+    for (const Flight &flight : queryFlights(departure, destination)) {
+        flights.append(flight.toJson());
+    }
+    
+    return flights;
+}
+
+QVector<Flight> DatabaseHelper::queryFlights(const QString &departure, const QString &destination)
+{
+    QVector<Flight> flights;
+    
+    if (!isConnected) return flights;
+    
+    QSqlQuery query = connectionPool->prepare(flightSearchSql(!departure.isEmpty(), !destination.isEmpty()));
+    
+    if (!departure.isEmpty()) {
+        query.addBindValue(departure);
+    }
+    
+    if (!destination.isEmpty()) {
+        query.addBindValue(destination);
+    }
+    
+    if (query.exec()) {
+        while (query.next()) {
+            flights.append(decodeFlight(query));
+        }
+    }
+    
+    return flights;
+}
+
+FlightCursor DatabaseHelper::openFlightCursor(const QString &departure, const QString &destination,
+                                              int batchSize)
+{
+    if (!isConnected) return FlightCursor();
+    
+    // 游标在多次调用间保持语句打开，不能使用共享的缓存语句；游标关闭前连接不会被回收
+    auto pin = std::make_shared<ConnectionPin>(connectionPool);
+    QSqlQuery query(connection());
+    query.setForwardOnly(true);
+    query.prepare(flightSearchSql(!departure.isEmpty(), !destination.isEmpty()));
+    
+    if (!departure.isEmpty()) {
+        query.addBindValue(departure);
+    }
+    
+    if (!destination.isEmpty()) {
+        query.addBindValue(destination);
+    }
+    
+    if (!query.exec()) {
+        emit databaseError(QString("无法打开航班游标: %1").arg(query.lastError().text()));
+        return FlightCursor();
+    }
+    
+    return FlightCursor(query, batchSize, pin);
+}
+
+Page<Flight> DatabaseHelper::queryFlightPage(const QString &departure, const QString &destination,
+                                             const PageKey &after, int pageSize)
+{
+    if (!isConnected) return Page<Flight>();
+    
+    QSqlQuery query = connectionPool->prepare(
+        flightPageSql(!departure.isEmpty(), !destination.isEmpty(), !after.isFirst()));
+    
+    if (!departure.isEmpty()) {
+        query.addBindValue(departure);
+    }
+    
+    if (!destination.isEmpty()) {
+        query.addBindValue(destination);
+    }
+    
+    return readPage(query, after, qMax(1, pageSize), 5, decodeFlight);
+}
+
+QJsonObject DatabaseHelper::getFlightDetails(const QString &flightNumber)
+{
+    Flight flight = findFlight(flightNumber);
+    return flight.isValid() ? flight.toJson() : QJsonObject();
+}
+
+Flight DatabaseHelper::findFlight(const QString &flightNumber)
+{
+    Flight flight;
+    
+    if (!isConnected) return flight;
+    
+    if (flightCache.lookup(flightNumber, &flight)) {
+        return flight;
+    }
+    const quint64 generation = flightCache.generation();
+    
+    QSqlQuery query = connectionPool->prepare(FLIGHT_BY_NUMBER_SQL);
+    query.addBindValue(flightNumber);
+    
+    if (query.exec() && query.next()) {
+        flight = decodeFlight(query);
+    }
+    // 单行查询未走到结果末尾，需显式重置语句以释放读快照
+    query.finish();
+    
+    // 不存在的航班不缓存，之后插入时无需失效
+    if (flight.isValid()) {
+        flightCache.insert(flightNumber, flight, footprint(flight), generation);
+    }
+    
+    return flight;
+}
+
+bool DatabaseHelper::updateFlightStatus(const QString &flightNumber, const QString &status)
+{
+    if (!isConnected) return false;
+    
+    QSqlQuery query = connectionPool->prepare("UPDATE flights SET status = ? WHERE flight_number = ?");
+    query.addBindValue(status);
+    query.addBindValue(flightNumber);
+    
+    const bool updated = query.exec();
+    flightCache.remove(flightNumber);
+    
+    // 只有在有接收者时才需要查出航线
+    if (updated && isSignalConnected(QMetaMethod::fromSignal(&DatabaseHelper::routeChanged))) {
+        const Flight flight = findFlight(flightNumber);
+        if (flight.isValid()) {
+            emit routeChanged(flight.departure, flight.destination);
+        }
+    }
+    return updated;
+}
+
+ImportResult DatabaseHelper::importFlights(const QJsonArray &flights, int batchSize)
+{
+    int index = 0;
+    return importFlightRecords([&flights, &index](QJsonObject &record) {
+        if (index >= flights.size()) {
+            return false;
+        }
+        record = flights.at(index++).toObject();
+        return true;
+    }, flights.size(), batchSize);
+}
+
+ImportResult DatabaseHelper::importFlightsFromFile(const QString &filePath, int batchSize)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        emit databaseError(QString("无法打开导入文件: %1").arg(file.errorString()));
+        return ImportResult();
+    }
+    
+    QTextStream stream(&file);
+    const bool isCsv = filePath.endsWith(".csv", Qt::CaseInsensitive);
+    
+    QStringList columns;
+    QString text;
+    if (isCsv && readCsvRecord(stream, text)) {
+        columns = parseCsvLine(text);
+        for (QString &column : columns) {
+            column = column.trimmed();
+        }
+    }
+    
+    // 逐条读取，内存占用只与批次大小有关；CSV 引号内的换行属于字段内容，
+    // 文件末尾引号未闭合的记录按缺少字段计为失败
+    return importFlightRecords([&stream, &columns, &text, isCsv](QJsonObject &record) {
+        while (!stream.atEnd()) {
+            bool complete = true;
+            if (isCsv) {
+                complete = readCsvRecord(stream, text);
+            } else {
+                text = stream.readLine();
+            }
+            if (text.trimmed().isEmpty()) {
+                continue;
+            }
+            
+            record = QJsonObject();
+            if (!complete) {
+                return true;
+            }
+            if (isCsv) {
+                const QStringList fields = parseCsvLine(text);
+                for (int i = 0; i < columns.size() && i < fields.size(); ++i) {
+                    record[columns[i]] = fields[i];
+                }
+            } else {
+                record = QJsonDocument::fromJson(text.toUtf8()).object();
+            }
+            return true;
+        }
+        return false;
+    }, -1, batchSize);
+}
+
+ImportResult DatabaseHelper::importFlightRecords(const std::function<bool(QJsonObject &)> &nextRecord,
+                                                 qint64 total, int batchSize)
+{
+    ImportResult result;
+    
+    if (!isConnected) return result;
+    
+    batchSize = qMax(1, batchSize);
+    QElapsedTimer timer;
+    timer.start();
+    
+    QVector<QJsonObject> batch;
+    batch.reserve(batchSize);
+    
+    QJsonObject record;
+    while (nextRecord(record)) {
+        ++result.processed;
+        
+        if (record["flight_number"].toString().isEmpty()) {
+            ++result.failed;
+            continue;
+        }
+        
+        batch.append(record);
+        if (batch.size() >= batchSize) {
+            flushFlightBatch(batch, result);
+            invalidateFlights(batch);
+            notifyRoutes(batch);
+            batch.clear();
+            
+            result.elapsedMs = timer.elapsed();
+            emit importProgress(result.processed, total, result.rowsPerSecond());
+        }
+    }
+    
+    if (!batch.isEmpty()) {
+        flushFlightBatch(batch, result);
+        invalidateFlights(batch);
+        notifyRoutes(batch);
+    }
+    
+    result.elapsedMs = timer.elapsed();
+    emit importProgress(result.processed, total, result.rowsPerSecond());
+    return result;
+}
+
+bool DatabaseHelper::flushFlightBatch(const QVector<QJsonObject> &batch, ImportResult &result)
+{
+    // 没有 status 的记录走不含该列的语句：新航班取表默认值，已有航班保留原状态
+    QVector<QJsonObject> withStatus;
+    QVector<QJsonObject> withoutStatus;
+    for (const QJsonObject &flight : batch) {
+        if (flight["status"].toString().isEmpty()) {
+            withoutStatus.append(flight);
+        } else {
+            withStatus.append(flight);
+        }
+    }
+    
+    // 事务期间连接不能被回收
+    ConnectionPin pin(connectionPool);
+    QSqlDatabase database = connection();
+    if (!database.transaction()) {
+        emit databaseError(QString("无法开始导入事务: %1").arg(database.lastError().text()));
+        result.failed += batch.size();
+        return false;
+    }
+    
+    QSqlQuery statusQuery = connectionPool->prepare(flightUpsertSql(true));
+    QSqlQuery defaultQuery = connectionPool->prepare(flightUpsertSql(false));
+    
+    if (execFlightBatch(statusQuery, withStatus, true)
+        && execFlightBatch(defaultQuery, withoutStatus, false)
+        && database.commit()) {
+        result.imported += batch.size();
+        return true;
+    }
+    
+    // 整批失败时回滚，再逐行写入以隔离出错的记录
+    database.rollback();
+    if (!database.transaction()) {
+        emit databaseError(QString("无法开始导入事务: %1").arg(database.lastError().text()));
+        result.failed += batch.size();
+        return false;
+    }
+    
+    qint64 imported = 0;
+    for (const QJsonObject &flight : withStatus) {
+        if (execFlightBatch(statusQuery, {flight}, true)) {
+            ++imported;
+        }
+    }
+    for (const QJsonObject &flight : withoutStatus) {
+        if (execFlightBatch(defaultQuery, {flight}, false)) {
+            ++imported;
+        }
+    }
+    
+    // 提交失败时逐行写入的结果一并作废
+    if (!database.commit()) {
+        emit databaseError(QString("无法提交导入事务: %1").arg(database.lastError().text()));
+        database.rollback();
+        imported = 0;
+    }
+    result.imported += imported;
+    result.failed += batch.size() - imported;
+    return false;
+}
+
+bool DatabaseHelper::insertUser(const QJsonObject &userData)
+{
+    if (!isConnected) return false;
+    
+    QSqlQuery query = connectionPool->prepare(
+        "INSERT INTO users (username, password, email, phone, first_name, "
+        "last_name, role, status) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    
+    query.addBindValue(userData["username"].toString());
+    query.addBindValue(userData["password"].toString());
+    query.addBindValue(userData["email"].toString());
+    query.addBindValue(userData["phone"].toString());
+    query.addBindValue(userData["first_name"].toString());
+    query.addBindValue(userData["last_name"].toString());
+    query.addBindValue(userData["role"].toString());
+    query.addBindValue(userData["status"].toString());
+    
+    return query.exec();
+}
+
+QJsonObject DatabaseHelper::getUser(const QString &username)
+{
+    User user = findUser(username);
+    return user.isValid() ? user.toJson() : QJsonObject();
+}
+
+User DatabaseHelper::findUser(const QString &username)
+{
+    User user;
+    
+    if (!isConnected) return user;
+    
+    if (userCache.lookup(username, &user)) {
+        return user;
+    }
+    const quint64 generation = userCache.generation();
+    
+    QSqlQuery query = connectionPool->prepare(USER_BY_NAME_SQL);
+    query.addBindValue(username);
+    
+    if (query.exec() && query.next()) {
+        user = decodeUser(query);
+    }
+    query.finish();
+    
+    if (user.isValid()) {
+        QMutexLocker locker(&userNamesMutex);
+        userCache.insert(username, user, footprint(user), generation);
+        userNames.insert(user.id, username);
+        
+        // 被淘汰的用户留下的映射积累到一定数量后一并清理
+        if (userNames.size() > 2 * userCache.statistics().entries + 256) {
+            for (auto it = userNames.begin(); it != userNames.end();) {
+                it = userCache.contains(it.value()) ? std::next(it) : userNames.erase(it);
+            }
+        }
+    }
+    
+    return user;
+}
+
+bool DatabaseHelper::updateUser(const QString &userId, const QJsonObject &userData)
+{
+    if (!isConnected) return false;
+    
+    QSqlQuery query = connectionPool->prepare(
+        "UPDATE users SET email = ?, phone = ?, first_name = ?, last_name = ?, "
+        "role = ?, status = ? WHERE id = ?");
+    
+    query.addBindValue(userData["email"].toString());
+    query.addBindValue(userData["phone"].toString());
+    query.addBindValue(userData["first_name"].toString());
+    query.addBindValue(userData["last_name"].toString());
+    query.addBindValue(userData["role"].toString());
+    query.addBindValue(userData["status"].toString());
+    query.addBindValue(userId);
+    
+    const bool updated = query.exec();
+    invalidateUser(userId);
+    return updated;
+}
+
+bool DatabaseHelper::deleteUser(const QString &userId)
+{
+    if (!isConnected) return false;
+    
+    QSqlQuery query = connectionPool->prepare("DELETE FROM users WHERE id = ?");
+    query.addBindValue(userId);
+    
+    const bool deleted = query.exec();
+    invalidateUser(userId);
+    return deleted;
+}
+
+void DatabaseHelper::invalidateUser(const QString &userId)
+{
+    // 没有缓存项时也调用 remove 推进代数，让并发的读穿放弃写入旧值
+    QMutexLocker locker(&userNamesMutex);
+    userCache.remove(userNames.take(userId.toLongLong()));
+}
+
+void DatabaseHelper::invalidateFlights(const QVector<QJsonObject> &flights)
+{
+    for (const QJsonObject &flight : flights) {
+        flightCache.remove(flight["flight_number"].toString());
+    }
+}
+
+void DatabaseHelper::notifyRoutes(const QVector<QJsonObject> &flights)
+{
+    if (!isSignalConnected(QMetaMethod::fromSignal(&DatabaseHelper::routeChanged))) {
+        return;
+    }
+    
+    // 一批中同一航线只通知一次
+    QSet<QPair<QString, QString>> routes;
+    for (const QJsonObject &flight : flights) {
+        routes.insert(qMakePair(flight["departure"].toString(), flight["destination"].toString()));
+    }
+    
+    for (const auto &route : std::as_const(routes)) {
+        emit routeChanged(route.first, route.second);
+    }
+}
+
+Page<User> DatabaseHelper::queryUserPage(const PageKey &after, int pageSize)
+{
+    if (!isConnected) return Page<User>();
+    
+    QSqlQuery query = connectionPool->prepare(userPageSql(!after.isFirst()));
+    return readPage(query, after, qMax(1, pageSize), 9, decodeUser);
+}
+
+bool DatabaseHelper::insertBooking(const QJsonObject &bookingData)
+{
+    if (!isConnected) return false;
+    
+    QSqlQuery query = connectionPool->prepare(
+        "INSERT INTO bookings (user_id, flight_number, booking_date, status, "
+        "total_price, passenger_count) VALUES (?, ?, ?, ?, ?, ?)");
+    
+    query.addBindValue(bookingData["user_id"].toString());
+    query.addBindValue(bookingData["flight_number"].toString());
+    query.addBindValue(bookingData["booking_date"].toString());
+    query.addBindValue(bookingData["status"].toString());
+    query.addBindValue(bookingData["total_price"].toString());
+    query.addBindValue(bookingData["passenger_count"].toString());
+    
+    return query.exec();
+}
+
+QJsonArray DatabaseHelper::getUserBookings(const QString &userId)
+{
+    QJsonArray bookings;
+    
+    for (const Booking &booking : queryUserBookings(userId)) {
+        bookings.append(booking.toJson());
+    }
+    
+    return bookings;
+}
+
+QVector<Booking> DatabaseHelper::queryUserBookings(const QString &userId)
+{
+    QVector<Booking> bookings;
+    
+    if (!isConnected) return bookings;
+    
+    QSqlQuery query = connectionPool->prepare(BOOKINGS_BY_USER_SQL);
+    query.addBindValue(userId);
+    
+    if (query.exec()) {
+        while (query.next()) {
+            bookings.append(decodeBooking(query));
+        }
+    }
+    
+    return bookings;
+}
+
+QJsonObject DatabaseHelper::getBookingDetails(const QString &bookingId)
+{
+    Booking booking = findBooking(bookingId);
+    if (!booking.isValid()) {
+        return QJsonObject();
+    }
+    
+    QJsonObject details = booking.toJson();
+    QJsonArray passengers;
+    for (const Passenger &passenger : queryBookingPassengers(bookingId)) {
+        passengers.append(passenger.toJson());
+    }
+    details["passengers"] = passengers;
+    
+    return details;
+}
+
+Booking DatabaseHelper::findBooking(const QString &bookingId)
+{
+    Booking booking;
+    
+    if (!isConnected) return booking;
+    
+    QSqlQuery query = connectionPool->prepare(BOOKING_BY_ID_SQL);
+    query.addBindValue(bookingId);
+    
+    if (query.exec() && query.next()) {
+        booking = decodeBooking(query);
+    }
+    query.finish();
+    
+    return booking;
+}
+
+QVector<Passenger> DatabaseHelper::queryBookingPassengers(const QString &bookingId)
+{
+    QVector<Passenger> passengers;
+    
+    if (!isConnected) return passengers;
+    
+    QSqlQuery query = connectionPool->prepare(PASSENGERS_BY_BOOKING_SQL);
+    query.addBindValue(bookingId);
+    
+    if (query.exec()) {
+        while (query.next()) {
+            passengers.append(decodePassenger(query));
+        }
+    }
+    
+    return passengers;
+}
+
+Page<Booking> DatabaseHelper::queryBookingPage(const QString &userId, const PageKey &after, int pageSize)
+{
+    if (!isConnected) return Page<Booking>();
+    
+    QSqlQuery query = connectionPool->prepare(bookingPageSql(!userId.isEmpty(), !after.isFirst()));
+    
+    if (!userId.isEmpty()) {
+        query.addBindValue(userId);
+    }
+    
+    return readPage(query, after, qMax(1, pageSize), 7, decodeBooking);
+}
+
+BookingResult DatabaseHelper::createBooking(const Booking &booking, const QVector<Passenger> &passengers)
+{
+    BookingResult result;
+    
+    if (!isConnected) {
+        result.message = "数据库未连接";
+        return result;
+    }
+    
+    if (booking.flightNumber.isEmpty() || passengers.isEmpty()) {
+        result.status = BookingResult::Invalid;
+        result.message = "预订缺少航班号或乘客";
+        return result;
+    }
+    
+    QMap<QString, int> seatsByClass;
+    for (const Passenger &passenger : passengers) {
+        ++seatsByClass[cabinOf(passenger)];
+    }
+    
+    ConnectionPin pin(connectionPool);
+    QSqlQuery control(connection());
+    for (int attempt = 1; attempt <= MAX_BOOKING_ATTEMPTS; ++attempt) {
+        result.attempts = attempt;
+        
+        // 事务外读取库存及版本，余座不足时无需获取写锁即可拒绝
+        QHash<QString, qint64> versions;
+        for (auto it = seatsByClass.cbegin(); it != seatsByClass.cend(); ++it) {
+            const SeatInventory inventory = findSeatInventory(booking.flightNumber, it.key());
+            if (!inventory.isValid()) {
+                result.status = BookingResult::Invalid;
+                result.message = QString("航班 %1 未配置%2库存").arg(booking.flightNumber, it.key());
+                return result;
+            }
+            if (inventory.available < it.value()) {
+                result.status = BookingResult::SoldOut;
+                result.message = QString("%1剩余 %2 座，需要 %3 座")
+                                     .arg(it.key()).arg(inventory.available).arg(it.value());
+                return result;
+            }
+            versions[it.key()] = inventory.version;
+        }
+        
+        // 直接获取写锁，避免读事务升级为写事务时返回 SQLITE_BUSY；事务内只做少量按主键的写入
+        if (!control.exec("BEGIN IMMEDIATE")) {
+            result.status = BookingResult::Failed;
+            result.message = QString("无法开始预订事务: %1").arg(control.lastError().text());
+            return result;
+        }
+        
+        if (writeBooking(booking, passengers, seatsByClass, versions, result)) {
+            if (control.exec("COMMIT")) {
+                result.status = BookingResult::Booked;
+                result.message.clear();
+                return result;
+            }
+            result.status = BookingResult::Failed;
+            result.message = QString("提交预订失败: %1").arg(control.lastError().text());
+        }
+        
+        control.exec("ROLLBACK");
+        result.bookingId = 0;
+        if (result.status != BookingResult::Conflict) {
+            return result;
+        }
+    }
+    
+    result.message = QString("库存在 %1 次尝试中均被并发预订修改").arg(MAX_BOOKING_ATTEMPTS);
+    return result;
+}
+
+bool DatabaseHelper::writeBooking(const Booking &booking, const QVector<Passenger> &passengers,
+                                  const QMap<QString, int> &seatsByClass,
+                                  const QHash<QString, qint64> &versions, BookingResult &result)
+{
+    // 版本号与读取时一致且余座充足才扣减，否则说明期间有其他预订提交
+    QSqlQuery reserve = connectionPool->prepare(
+        "UPDATE seat_inventory SET available = available - ?, version = version + 1 "
+        "WHERE flight_number = ? AND class_type = ? AND version = ? AND available >= ?");
+    
+    for (auto it = seatsByClass.cbegin(); it != seatsByClass.cend(); ++it) {
+        reserve.addBindValue(it.value());
+        reserve.addBindValue(booking.flightNumber);
+        reserve.addBindValue(it.key());
+        reserve.addBindValue(versions.value(it.key()));
+        reserve.addBindValue(it.value());
+        
+        if (!reserve.exec()) {
+            result.status = BookingResult::Failed;
+            result.message = QString("扣减库存失败: %1").arg(reserve.lastError().text());
+            return false;
+        }
+        
+        if (reserve.numRowsAffected() != 1) {
+            result.status = BookingResult::Conflict;
+            result.message = QString("%1库存已被其他预订修改").arg(it.key());
+            return false;
+        }
+    }
     
-    if (!database.open()) {
-        emit databaseError(QString("无法连接数据库: %1").arg(database.lastError().text()));
+    QSqlQuery insert = connectionPool->prepare(
+        "INSERT INTO bookings (user_id, flight_number, booking_date, status, "
+        "total_price, passenger_count) VALUES (?, ?, ?, ?, ?, ?)");
+    
+    insert.addBindValue(booking.userId);
+    insert.addBindValue(booking.flightNumber);
+    insert.addBindValue(booking.bookingDate.isEmpty() ? QDate::currentDate().toString(Qt::ISODate)
+                                                      : booking.bookingDate);
+    insert.addBindValue(booking.status.isEmpty() ? QString("已预订") : booking.status);
+    insert.addBindValue(booking.totalPrice);
+    insert.addBindValue(passengers.size());
+    
+    if (!insert.exec()) {
+        result.status = BookingResult::Failed;
+        result.message = QString("写入预订失败: %1").arg(insert.lastError().text());
         return false;
     }
+    result.bookingId = insert.lastInsertId().toLongLong();
+    
+    QSqlQuery passengerInsert = connectionPool->prepare(
+        "INSERT INTO passengers (booking_id, first_name, last_name, id_number, "
+        "seat_number, class_type) VALUES (?, ?, ?, ?, ?, ?)");
+    
+    for (const Passenger &passenger : passengers) {
+        passengerInsert.addBindValue(result.bookingId);
+        passengerInsert.addBindValue(passenger.firstName);
+        passengerInsert.addBindValue(passenger.lastName);
+        passengerInsert.addBindValue(passenger.idNumber);
+        passengerInsert.addBindValue(passenger.seatNumber);
+        passengerInsert.addBindValue(cabinOf(passenger));
+        
+        if (!passengerInsert.exec()) {
+            result.status = BookingResult::Failed;
+            result.message = QString("写入乘客失败: %1").arg(passengerInsert.lastError().text());
+            return false;
+        }
+    }
     
-    isConnected = true;
-    createTables();
-    emit databaseConnected();
     return true;
 }
 
-bool DatabaseHelper::insertFlight(const QJsonObject &flightData)
+bool DatabaseHelper::setSeatInventory(const QString &flightNumber, const QString &classType, int capacity)
 {
     if (!isConnected) return false;
     
-    QSqlQuery query(database);
-    query.prepare("INSERT INTO flights (flight_number, airline, departure, destination, "
-                 "departure_time, arrival_time, status, gate, aircraft) "
-                 "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    // SET 右侧取更新前的值：新余座 = 新容量 - 已售
+    QSqlQuery query = connectionPool->prepare(
+        "INSERT INTO seat_inventory (flight_number, class_type, capacity, available) VALUES (?, ?, ?, ?) "
+        "ON CONFLICT (flight_number, class_type) DO UPDATE SET "
+        "capacity = excluded.capacity, "
+        "available = MAX(0, excluded.capacity - (capacity - available)), "
+        "version = version + 1");
     
-    query.addBindValue(flightData["flight_number"].toString());
-    query.addBindValue(flightData["airline"].toString());
-    query.addBindValue(flightData["departure"].toString());
-    query.addBindValue(flightData["destination"].toString());
-    query.addBindValue(flightData["departure_time"].toString());
-    query.addBindValue(flightData["arrival_time"].toString());
-    query.addBindValue(flightData["status"].toString());
-    query.addBindValue(flightData["gate"].toString());
-    query.addBindValue(flightData["aircraft"].toString());
+    query.addBindValue(flightNumber);
+    query.addBindValue(classType);
+    query.addBindValue(qMax(0, capacity));
+    query.addBindValue(qMax(0, capacity));
     
     return query.exec();
 }
 
-QJsonArray DatabaseHelper::getFlights(const QString &departure, const QString &destination)
+SeatInventory DatabaseHelper::findSeatInventory(const QString &flightNumber, const QString &classType)
 {
-    QJsonArray flights;
+    SeatInventory inventory;
     
-    if (!isConnected) return flights;
+    if (!isConnected) return inventory;
     
-    QString queryString = "SELECT * FROM flights WHERE 1=1";
-    QVariantList params;
+    QSqlQuery query = connectionPool->prepare(
+        QString(SEAT_INVENTORY_COLUMNS_SQL) + " WHERE flight_number = ? AND class_type = ?");
+    query.addBindValue(flightNumber);
+    query.addBindValue(classType);
     
-    if (!departure.isEmpty()) {
-        queryString += " AND departure = ?";
-        params.append(departure);
+    if (query.exec() && query.next()) {
+        inventory = decodeSeatInventory(query);
     }
+    query.finish();
     
-    if (!destination.isEmpty()) {
-        queryString += " AND destination = ?";
-        params.append(destination);
-    }
+    return inventory;
+}
+
+QVector<SeatInventory> DatabaseHelper::querySeatInventory(const QString &flightNumber)
+{
+    QVector<SeatInventory> inventories;
     
-    QSqlQuery query(database);
-    query.prepare(queryString);
+    if (!isConnected) return inventories;
     
-    for (const QVariant &param : params) {
-        query.addBindValue(param);
-    }
+    QSqlQuery query = connectionPool->prepare(QString(SEAT_INVENTORY_COLUMNS_SQL) + " WHERE flight_number = ?");
+    query.addBindValue(flightNumber);
     
     if (query.exec()) {
         while (query.next()) {
-            QJsonObject flight;
-            QSqlRecord record = query.record();
-            
-            for (int i = 0; i < record.count(); ++i) {
-                flight[record.fieldName(i)] = query.value(i).toString();
-            }
-            
-            flights.append(flight);
+            inventories.append(decodeSeatInventory(query));
         }
     }
     
-    return flights;
+    return inventories;
 }
 
-QJsonObject DatabaseHelper::getFlightDetails(const QString &flightNumber)
+QStringList DatabaseHelper::queryAssignedSeats(const QString &flightNumber, const QString &classType)
 {
-    QJsonObject flight;
+    QStringList seats;
     
-    if (!isConnected) return flight;
+    if (!isConnected) return seats;
     
-    QSqlQuery query(database);
-    query.prepare("SELECT * FROM flights WHERE flight_number = ?");
+    QSqlQuery query = connectionPool->prepare(
+        "SELECT p.seat_number FROM passengers p JOIN bookings b ON b.id = p.booking_id "
+        "WHERE b.flight_number = ? AND p.class_type = ? AND p.seat_number <> '' AND b.status <> '已取消'");
     query.addBindValue(flightNumber);
+    query.addBindValue(classType);
     
-    if (query.exec() && query.next()) {
-        QSqlRecord record = query.record();
-        for (int i = 0; i < record.count(); ++i) {
-            flight[record.fieldName(i)] = query.value(i).toString();
+    if (query.exec()) {
+        while (query.next()) {
+            seats.append(query.value(0).toString());
         }
     }
     
-    return flight;
+    return seats;
 }
 
-bool DatabaseHelper::updateFlightStatus(const QString &flightNumber, const QString &status)
+bool DatabaseHelper::updatePassengerSeat(qint64 passengerId, const QString &flightNumber,
+                                         const QString &classType, const QString &seatNumber,
+                                         QString *previousSeat)
 {
     if (!isConnected) return false;
     
-    QSqlQuery query(database);
-    query.prepare("UPDATE flights SET status = ? WHERE flight_number = ?");
-    query.addBindValue(status);
-    query.addBindValue(flightNumber);
+    // 校验归属、读取原座位和写入新座位在同一事务中完成，期间乘客记录不会被其他写入改动
+    ConnectionPin pin(connectionPool);
+    QSqlQuery control(connection());
+    if (!control.exec("BEGIN IMMEDIATE")) {
+        emit databaseError(QString("无法开始选座事务: %1").arg(control.lastError().text()));
+        return false;
+    }
     
-    return query.exec();
+    // 乘客必须属于该航班该舱位的有效预订
+    QSqlQuery lookup = connectionPool->prepare(
+        "SELECT p.seat_number FROM passengers p JOIN bookings b ON b.id = p.booking_id "
+        "WHERE p.id = ? AND b.flight_number = ? AND p.class_type = ? AND b.status <> '已取消'");
+    lookup.addBindValue(passengerId);
+    lookup.addBindValue(flightNumber);
+    lookup.addBindValue(classType);
+    if (!lookup.exec() || !lookup.next()) {
+        lookup.finish();
+        control.exec("ROLLBACK");
+        return false;
+    }
+    const QString previous = lookup.value(0).toString();
+    lookup.finish();
+    
+    QSqlQuery update = connectionPool->prepare("UPDATE passengers SET seat_number = ? WHERE id = ?");
+    update.addBindValue(seatNumber);
+    update.addBindValue(passengerId);
+    if (!update.exec() || update.numRowsAffected() != 1 || !control.exec("COMMIT")) {
+        control.exec("ROLLBACK");
+        return false;
+    }
+    
+    if (previousSeat) {
+        *previousSeat = previous;
+    }
+    return true;
 }
 
-bool DatabaseHelper::insertUser(const QJsonObject &userData)
+bool DatabaseHelper::updateBookingStatus(const QString &bookingId, const QString &status)
 {
     if (!isConnected) return false;
     
-    QSqlQuery query(database);
-    query.prepare("INSERT INTO users (username, password, email, phone, first_name, "
-                 "last_name, role, status) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
-    
-    query.addBindValue(userData["username"].toString());
-    query.addBindValue(userData["password"].toString());
-    query.addBindValue(userData["email"].toString());
-    query.addBindValue(userData["phone"].toString());
-    query.addBindValue(userData["first_name"].toString());
-    query.addBindValue(userData["last_name"].toString());
-    query.addBindValue(userData["role"].toString());
-    query.addBindValue(userData["status"].toString());
+    QSqlQuery query = connectionPool->prepare("UPDATE bookings SET status = ? WHERE id = ?");
+    query.addBindValue(status);
+    query.addBindValue(bookingId);
     
     return query.exec();
 }
 
-QJsonObject DatabaseHelper::getUser(const QString &username)
+QJsonObject DatabaseHelper::getFlightStatistics()
 {
-    QJsonObject user;
-    
-    if (!isConnected) return user;
+    QJsonObject stats;
     
-    QSqlQuery query(database);
-    query.prepare("SELECT * FROM users WHERE username = ?");
-    query.addBindValue(username);
+    if (!isConnected) return stats;
     
-    if (query.exec() && query.next()) {
-        QSqlRecord record = query.record();
-        for (int i = 0; i < record.count(); ++i) {
-            user[record.fieldName(i)] = query.value(i).toString();
-        }
-    }
+    stats["total_flights"] = QString::number(counterValue("flights", "total"));
+    stats["active_flights"] = QString::number(counterValue("flight_status", "准点"));
+    stats["by_status"] = getCounterBreakdown("flight_status");
     
-    return user;
+    return stats;
 }
 
-bool DatabaseHelper::updateUser(const QString &userId, const QJsonObject &userData)
+QJsonObject DatabaseHelper::getUserStatistics()
 {
-    if (!isConnected) return false;
+    QJsonObject stats;
     
-    QSqlQuery query(database);
-    query.prepare("UPDATE users SET email = ?, phone = ?, first_name = ?, last_name = ?, "
-                 "role = ?, status = ? WHERE id = ?");
+    if (!isConnected) return stats;
     
-    query.addBindValue(userData["email"].toString());
-    query.addBindValue(userData["phone"].toString());
-    query.addBindValue(userData["first_name"].toString());
-    query.addBindValue(userData["last_name"].toString());
-    query.addBindValue(userData["role"].toString());
-    query.addBindValue(userData["status"].toString());
-    query.addBindValue(userId);
+    stats["total_users"] = QString::number(counterValue("users", "total"));
     
-    return query.exec();
+    return stats;
 }
 
-bool DatabaseHelper::deleteUser(const QString &userId)
+QJsonObject DatabaseHelper::getBookingStatistics()
 {
-    if (!isConnected) return false;
+    QJsonObject stats;
     
-    QSqlQuery query(database);
-    query.prepare("DELETE FROM users WHERE id = ?");
-    query.addBindValue(userId);
+    if (!isConnected) return stats;
     
-    return query.exec();
+    stats["total_bookings"] = QString::number(counterValue("bookings", "total"));
+    stats["by_status"] = getCounterBreakdown("booking_status");
+    
+    return stats;
 }
 
-bool DatabaseHelper::insertBooking(const QJsonObject &bookingData)
+qint64 DatabaseHelper::counterValue(const QString &scope, const QString &key)
 {
-    if (!isConnected) return false;
+    if (!isConnected) return 0;
     
-    QSqlQuery query(database);
-    query.prepare("INSERT INTO bookings (user_id, flight_number, booking_date, status, "
-                 "total_price, passenger_count) VALUES (?, ?, ?, ?, ?, ?)");
+    QSqlQuery query = connectionPool->prepare(COUNTER_VALUE_SQL);
+    query.addBindValue(scope);
+    query.addBindValue(key);
     
-    query.addBindValue(bookingData["user_id"].toString());
-    query.addBindValue(bookingData["flight_number"].toString());
-    query.addBindValue(bookingData["booking_date"].toString());
-    query.addBindValue(bookingData["status"].toString());
-    query.addBindValue(bookingData["total_price"].toString());
-    query.addBindValue(bookingData["passenger_count"].toString());
+    qint64 value = 0;
+    if (query.exec() && query.next()) {
+        value = query.value(0).toLongLong();
+    }
+    query.finish();
     
-    return query.exec();
+    return value;
 }
 
-QJsonArray DatabaseHelper::getUserBookings(const QString &userId)
+QJsonObject DatabaseHelper::getCounterBreakdown(const QString &scope)
 {
-    QJsonArray bookings;
+    QJsonObject counters;
     
-    if (!isConnected) return bookings;
+    if (!isConnected) return counters;
     
-    QSqlQuery query(database);
-    query.prepare("SELECT * FROM bookings WHERE user_id = ?");
-    query.addBindValue(userId);
+    QSqlQuery query = connectionPool->prepare(
+        "SELECT key, value FROM stat_counters WHERE scope = ? AND value > 0");
+    query.addBindValue(scope);
     
     if (query.exec()) {
         while (query.next()) {
-            QJsonObject booking;
-            QSqlRecord record = query.record();
-            
-            for (int i = 0; i < record.count(); ++i) {
-                booking[record.fieldName(i)] = query.value(i).toString();
-            }
-            
-            bookings.append(booking);
+            counters[query.value(0).toString()] = query.value(1).toLongLong();
         }
     }
     
-    return bookings;
+    return counters;
 }
 
-QJsonObject DatabaseHelper::getBookingDetails(const QString &bookingId)
+bool DatabaseHelper::rebuildStatistics()
 {
-    QJsonObject booking;
+    if (!isConnected) return false;
     
-    if (!isConnected) return booking;
+    // 清空与重新计数在同一事务中完成，期间其他写入等待，计数与基表保持一致
+    ConnectionPin pin(connectionPool);
+    QSqlDatabase database = connection();
+    if (!database.transaction()) {
+        emit databaseError(QString("无法开始统计重建事务: %1").arg(database.lastError().text()));
+        return false;
+    }
     
-    QSqlQuery query(database);
-    query.prepare("SELECT * FROM bookings WHERE id = ?");
-    query.addBindValue(bookingId);
+    QStringList statements = {"DELETE FROM stat_counters"};
+    for (const CounterTable &table : counterTables()) {
+        statements += counterBackfillSql(table);
+    }
     
-    if (query.exec() && query.next()) {
-        QSqlRecord record = query.record();
-        for (int i = 0; i < record.count(); ++i) {
-            booking[record.fieldName(i)] = query.value(i).toString();
+    QSqlQuery query(database);
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            emit databaseError(QString("重建统计失败: %1").arg(query.lastError().text()));
+            database.rollback();
+            return false;
         }
     }
     
-    return booking;
+    return database.commit();
 }
 
-bool DatabaseHelper::updateBookingStatus(const QString &bookingId, const QString &status)
+QJsonObject DatabaseHelper::getLookupCacheStatistics()
 {
-    if (!isConnected) return false;
+    QJsonObject stats;
+    stats["flights"] = cacheStatisticsJson(flightCache.statistics());
+    stats["users"] = cacheStatisticsJson(userCache.statistics());
+    return stats;
+}
+
+void DatabaseHelper::setLookupCacheSize(qint64 maxBytes)
+{
+    flightCache.setMaxBytes(maxBytes);
+    userCache.setMaxBytes(maxBytes);
+}
+
+void DatabaseHelper::clearLookupCaches()
+{
+    flightCache.clear();
+    QMutexLocker locker(&userNamesMutex);
+    userCache.clear();
+    userNames.clear();
+}
+
+QJsonObject DatabaseHelper::getStatementCacheStatistics()
+{
+    QJsonObject stats;
     
-    QSqlQuery query(database);
-    query.prepare("UPDATE bookings SET status = ? WHERE id = ?");
-    query.addBindValue(status);
-    query.addBindValue(bookingId);
+    const quint64 hits = connectionPool->statementCacheHits();
+    const quint64 misses = connectionPool->statementCacheMisses();
+    stats["hits"] = QString::number(hits);
+    stats["misses"] = QString::number(misses);
+    stats["hit_ratio"] = (hits + misses) > 0 ? double(hits) / double(hits + misses) : 0.0;
     
-    return query.exec();
+    return stats;
 }
 
-QJsonObject DatabaseHelper::getFlightStatistics()
+bool DatabaseHelper::createTables()
 {
-    QJsonObject stats;
+    return createFlightTable() && createUserTable() && createBookingTable() && createPassengerTable()
+        && createSeatInventoryTable() && createIndexes() && createStatistics();
+}
+
+bool DatabaseHelper::createStatistics()
+{
+    // 计数器由各表的触发器在写入时维护，统计读取只需按主键查一行
+    QSqlQuery query(connection());
+    if (!query.exec("CREATE TABLE IF NOT EXISTS stat_counters ("
+                    "scope TEXT NOT NULL,"
+                    "key TEXT NOT NULL,"
+                    "value INTEGER NOT NULL DEFAULT 0,"
+                    "PRIMARY KEY (scope, key)"
+                    ") WITHOUT ROWID")) {
+        emit databaseError(QString("创建统计表失败: %1").arg(query.lastError().text()));
+        return false;
+    }
     
-    if (!isConnected) return stats;
+    QStringList triggers;
+    for (const CounterTable &table : counterTables()) {
+        triggers += counterTriggerSql(table);
+    }
     
-    QSqlQuery query(database);
-    if (query.exec("SELECT COUNT(*) as total_flights FROM flights")) {
-        if (query.next()) {
-            stats["total_flights"] = query.value("total_flights").toString();
-        }
+    // 触发器齐全说明计数器一直在同步，否则在创建触发器后按现有数据回填
+    if (query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger' AND name GLOB 'trg_*_stats_*'")
+        && query.next() && query.value(0).toInt() == triggers.size()) {
+        return true;
     }
     
-    if (query.exec("SELECT COUNT(*) as active_flights FROM flights WHERE status = '准点'")) {
-        if (query.next()) {
-            stats["active_flights"] = query.value("active_flights").toString();
+    for (const QString &statement : triggers) {
+        if (!query.exec(statement)) {
+            emit databaseError(QString("创建统计触发器失败: %1").arg(query.lastError().text()));
+            return false;
         }
     }
     
-    return stats;
+    return rebuildStatistics();
 }
 
-QJsonObject DatabaseHelper::getUserStatistics()
+bool DatabaseHelper::createIndexes()
 {
-    QJsonObject stats;
+    // 覆盖 getFlights / getUserBookings / 乘客按预订查询等热点路径，避免全表扫描
+    const QStringList statements = {
+        "CREATE INDEX IF NOT EXISTS idx_flights_route_time "
+        "ON flights (departure, destination, departure_time)",
+        "CREATE INDEX IF NOT EXISTS idx_bookings_user_created "
+        "ON bookings (user_id, created_at)",
+        "CREATE INDEX IF NOT EXISTS idx_passengers_booking "
+        "ON passengers (booking_id)",
+        // 键集分页：索引以排序列结尾（隐含 rowid 即 id），翻页不需要临时排序
+        "CREATE INDEX IF NOT EXISTS idx_flights_time "
+        "ON flights (departure_time)",
+        "CREATE INDEX IF NOT EXISTS idx_flights_departure_time "
+        "ON flights (departure, departure_time)",
+        "CREATE INDEX IF NOT EXISTS idx_flights_destination_time "
+        "ON flights (destination, departure_time)",
+        "CREATE INDEX IF NOT EXISTS idx_users_created "
+        "ON users (created_at)",
+        "CREATE INDEX IF NOT EXISTS idx_bookings_created "
+        "ON bookings (created_at)",
+        // 座位图按航班载入已分配座位
+        "CREATE INDEX IF NOT EXISTS idx_bookings_flight "
+        "ON bookings (flight_number)"
+    };
     
-    if (!isConnected) return stats;
-    
-    QSqlQuery query(database);
-    if (query.exec("SELECT COUNT(*) as total_users FROM users")) {
-        if (query.next()) {
-            stats["total_users"] = query.value("total_users").toString();
+    QSqlQuery query(connection());
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            emit databaseError(QString("创建索引失败: %1").arg(query.lastError().text()));
+            return false;
         }
     }
-    
-    return stats;
+    return true;
 }
 
-QJsonObject DatabaseHelper::getBookingStatistics()
+bool DatabaseHelper::readCsvRecord(QTextStream &stream, QString &record)
 {
-    QJsonObject stats;
-    
-    if (!isConnected) return stats;
+    // 引号个数为奇数说明还在引号内，换行属于字段内容，接着读下一行
+    record = stream.readLine();
+    int quotes = record.count('"');
+    while (quotes % 2 != 0 && !stream.atEnd()) {
+        const QString line = stream.readLine();
+        record += '\n';
+        record += line;
+        quotes += line.count('"');
+    }
+    return quotes % 2 == 0;
+}
+
+QStringList DatabaseHelper::parseCsvLine(const QString &line)
+{
+    QStringList fields;
+    QString field;
+    bool inQuotes = false;
     
-    QSqlQuery query(database);
-    if (query.exec("SELECT COUNT(*) as total_bookings FROM bookings")) {
-        if (query.next()) {
-            stats["total_bookings"] = query.value("total_bookings").toString();
+    for (int i = 0; i < line.size(); ++i) {
+        const QChar ch = line.at(i);
+        if (inQuotes) {
+            if (ch == '"') {
+                if (i + 1 < line.size() && line.at(i + 1) == '"') {
+                    field += '"';
+                    ++i;
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                field += ch;
+            }
+        } else if (ch == '"') {
+            inQuotes = true;
+        } else if (ch == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += ch;
         }
     }
+    fields.append(field);
     
-    return stats;
+    return fields;
 }
 
-bool DatabaseHelper::createTables()
+QStringList DatabaseHelper::hotQueries()
+{
+    return {
+        flightSearchSql(true, true),
+        flightSearchSql(true, false),
+        flightSearchSql(false, true),
+        FLIGHT_BY_NUMBER_SQL,
+        "UPDATE flights SET status = ? WHERE flight_number = ?",
+        USER_BY_NAME_SQL,
+        BOOKINGS_BY_USER_SQL,
+        BOOKING_BY_ID_SQL,
+        "UPDATE bookings SET status = ? WHERE id = ?",
+        PASSENGERS_BY_BOOKING_SQL,
+        flightPageSql(false, false, true),
+        flightPageSql(true, false, true),
+        flightPageSql(false, true, true),
+        flightPageSql(true, true, true),
+        userPageSql(true),
+        bookingPageSql(false, true),
+        bookingPageSql(true, true),
+        COUNTER_VALUE_SQL
+    };
+}
+
+QStringList DatabaseHelper::explainQueryPlan(const QString &sql)
 {
-    return createFlightTable() && createUserTable() && createBookingTable() && createPassengerTable();
+    QStringList plan;
+    
+    if (!isConnected) return plan;
+    
+    QSqlQuery query(connection());
+    if (!query.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        emit databaseError(QString("无法分析查询: %1").arg(query.lastError().text()));
+        return plan;
+    }
+    
+    // 参数以 NULL 绑定，不影响索引选择
+    for (int i = 0; i < sql.count('?'); ++i) {
+        query.addBindValue(QVariant());
+    }
+    
+    if (query.exec()) {
+        while (query.next()) {
+            plan.append(query.value("detail").toString());
+        }
+    }
+    
+    return plan;
 }
 
 bool DatabaseHelper::createFlightTable()
 {
-    QSqlQuery query(database);
-    return query.exec(
+    QSqlQuery query(connection());
+    const bool created = query.exec(
         "CREATE TABLE IF NOT EXISTS flights ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
         "flight_number TEXT UNIQUE NOT NULL,"
@@ -350,14 +1709,47 @@ bool DatabaseHelper::createFlightTable()
         "status TEXT DEFAULT '准点',"
         "gate TEXT,"
         "aircraft TEXT,"
-        "created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+        "created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+        "price_economy REAL,"
+        "price_business REAL,"
+        "price_first REAL"
         ")"
     );
+    
+    // 旧版本创建的数据库没有票价列
+    return created && addMissingColumns("flights", {"price_economy REAL", "price_business REAL",
+                                                    "price_first REAL"});
+}
+
+bool DatabaseHelper::addMissingColumns(const QString &table, const QStringList &definitions)
+{
+    QSqlQuery query(connection());
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        return false;
+    }
+    
+    QStringList existing;
+    while (query.next()) {
+        existing.append(query.value("name").toString());
+    }
+    
+    for (const QString &definition : definitions) {
+        const QString column = definition.section(' ', 0, 0);
+        if (existing.contains(column)) {
+            continue;
+        }
+        
+        if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2").arg(table, definition))) {
+            emit databaseError(QString("升级表 %1 失败: %2").arg(table, query.lastError().text()));
+            return false;
+        }
+    }
+    return true;
 }
 
 bool DatabaseHelper::createUserTable()
 {
-    QSqlQuery query(database);
+    QSqlQuery query(connection());
     return query.exec(
         "CREATE TABLE IF NOT EXISTS users ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -376,7 +1768,7 @@ bool DatabaseHelper::createUserTable()
 
 bool DatabaseHelper::createBookingTable()
 {
-    QSqlQuery query(database);
+    QSqlQuery query(connection());
     return query.exec(
         "CREATE TABLE IF NOT EXISTS bookings ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -395,7 +1787,7 @@ bool DatabaseHelper::createBookingTable()
 
 bool DatabaseHelper::createPassengerTable()
 {
-    QSqlQuery query(database);
+    QSqlQuery query(connection());
     return query.exec(
         "CREATE TABLE IF NOT EXISTS passengers ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
@@ -410,17 +1802,53 @@ bool DatabaseHelper::createPassengerTable()
     );
 }
 
+bool DatabaseHelper::createSeatInventoryTable()
+{
+    // 库存行按 (航班, 舱位) 聚簇，并发预订只在同一航班同一舱位上产生版本冲突
+    QSqlQuery query(connection());
+    return query.exec(
+        "CREATE TABLE IF NOT EXISTS seat_inventory ("
+        "flight_number TEXT NOT NULL,"
+        "class_type TEXT NOT NULL,"
+        "capacity INTEGER NOT NULL,"
+        "available INTEGER NOT NULL CHECK (available >= 0),"
+        "version INTEGER NOT NULL DEFAULT 0,"
+        "PRIMARY KEY (flight_number, class_type),"
+        "FOREIGN KEY (flight_number) REFERENCES flights(flight_number)"
+        ") WITHOUT ROWID"
+    );
+}
+
 void DatabaseHelper::closeDatabase()
 {
-    if (database.isOpen()) {
-        database.close();
-    }
+    connectionPool->closeAll();
     isConnected = false;
 }
 
+ConnectionPool *DatabaseHelper::pool() const
+{
+    return connectionPool;
+}
+
+void DatabaseHelper::setStorageProfile(const StorageProfile &newProfile)
+{
+    profile = newProfile;
+    connectionPool->setInitStatements(profile.pragmas());
+}
+
+StorageProfile DatabaseHelper::storageProfile() const
+{
+    return profile;
+}
+
+QSqlDatabase DatabaseHelper::connection()
+{
+    return connectionPool->acquire();
+}
+
 QVariant DatabaseHelper::executeScalar(const QString &query)
 {
-    QSqlQuery sqlQuery(database);
+    QSqlQuery sqlQuery(connection());
     if (sqlQuery.exec(query) && sqlQuery.next()) {
         return sqlQuery.value(0);
     }
@@ -429,7 +1857,7 @@ QVariant DatabaseHelper::executeScalar(const QString &query)
 
 QSqlQuery DatabaseHelper::executeQuery(const QString &query, const QVariantList &params)
 {
-    QSqlQuery sqlQuery(database);
+    QSqlQuery sqlQuery(connection());
     sqlQuery.prepare(query);
     
     for (const QVariant &param : params) {
@@ -6,9 +6,92 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QMutex>
+#include <QTextStream>
+#include <atomic>
+#include <functional>
+#include "connectionpool.h"
+#include "datamodels.h"
+#include "lrucache.h"
+
+// SQLite 存储配置，在每个连接打开时以 PRAGMA 形式应用
+struct StorageProfile
+{
+    QString journalMode = "WAL";      // DELETE / TRUNCATE / WAL ...
+    QString synchronous = "NORMAL";   // OFF / NORMAL / FULL
+    int pageSize = 4096;              // 仅对新建数据库或 VACUUM 后生效
+    int cacheSizeKb = 16 * 1024;      // 每个连接的页缓存大小
+    qint64 mmapSize = 256LL * 1024 * 1024;
+    QString tempStore = "MEMORY";     // DEFAULT / FILE / MEMORY
+    int busyTimeoutMs = 5000;
+
+    // 适合并发读 + 预订写入的默认配置
+    static StorageProfile concurrentProfile();
+    // SQLite 出厂默认值（回滚日志），用于对比测试
+    static StorageProfile legacyProfile();
+
+    QStringList pragmas() const;
+};
+
+// 批量导入结果
+struct ImportResult
+{
+    qint64 processed = 0;   // 读取的记录数
+    qint64 imported = 0;    // 成功插入或更新的记录数
+    qint64 failed = 0;      // 字段缺失或写入失败的记录数
+    qint64 elapsedMs = 0;
+    
+    double rowsPerSecond() const { return elapsedMs > 0 ? processed * 1000.0 / elapsedMs : 0.0; }
+};
+
+// 事务性预订的结果
+struct BookingResult
+{
+    enum Status {
+        Booked,     // 预订、乘客和库存扣减已一并提交
+        SoldOut,    // 某个舱位剩余座位不足
+        Conflict,   // 库存在多次重试中均被并发预订修改
+        Invalid,    // 缺少航班号或乘客，或航班未配置该舱位库存
+        Failed      // 数据库错误
+    };
+    
+    Status status = Failed;
+    qint64 bookingId = 0;
+    int attempts = 0;
+    QString message;
+    
+    bool isBooked() const { return status == Booked; }
+};
+
+// 航班结果的只进游标，按固定批次读取，内存占用只与批次大小有关
+// 游标持有打开的语句并钉住所在连接，只能在创建它的线程中使用，用完后应尽快 close()
+class FlightCursor
+{
+public:
+    FlightCursor();
+    FlightCursor(const QSqlQuery &query, int batchSize, std::shared_ptr<ConnectionPin> pin = nullptr);
+    
+    bool isValid() const;
+    bool atEnd() const;
+    QVector<Flight> nextBatch();
+    qint64 rowsRead() const;
+    void close();
+    
+private:
+    QSqlQuery query;
+    std::shared_ptr<ConnectionPin> pin;     // 游标打开期间钉住连接
+    int batchSize;
+    bool opened;
+    bool finished;
+    qint64 rows;
+};
 
 class DatabaseHelper : public QObject
 {
@@ -21,46 +104,137 @@ public:
     bool connectToDatabase(const QString &hostName, const QString &dbName, 
                           const QString &username, const QString &password);
     
+    // get* 返回 API 边界使用的 JSON，query*/find* 返回按列序号解码的类型化结果
+    
     // 航班相关操作
     bool insertFlight(const QJsonObject &flightData);
     QJsonArray getFlights(const QString &departure = "", const QString &destination = "");
     QJsonObject getFlightDetails(const QString &flightNumber);
+    QVector<Flight> queryFlights(const QString &departure = "", const QString &destination = "");
+    Flight findFlight(const QString &flightNumber);
+    FlightCursor openFlightCursor(const QString &departure = "", const QString &destination = "",
+                                  int batchSize = 1000);
+    // 键集分页：按 (departure_time, id) 排序，after 为上一页返回的 next
+    Page<Flight> queryFlightPage(const QString &departure, const QString &destination,
+                                 const PageKey &after = PageKey(), int pageSize = 50);
     bool updateFlightStatus(const QString &flightNumber, const QString &status);
     
+    // 批量导入航班：按批次在事务中执行，flight_number 已存在时更新
+    ImportResult importFlights(const QJsonArray &flights, int batchSize = 5000);
+    // 从 CSV（首行为列名）或 NDJSON 文件流式导入
+    ImportResult importFlightsFromFile(const QString &filePath, int batchSize = 5000);
+    
     // 用户相关操作
     bool insertUser(const QJsonObject &userData);
     QJsonObject getUser(const QString &username);
+    User findUser(const QString &username);
     bool updateUser(const QString &userId, const QJsonObject &userData);
     bool deleteUser(const QString &userId);
+    // 按 (created_at, id) 键集分页
+    Page<User> queryUserPage(const PageKey &after = PageKey(), int pageSize = 50);
     
     // 预订相关操作
     bool insertBooking(const QJsonObject &bookingData);
     QJsonArray getUserBookings(const QString &userId);
     QJsonObject getBookingDetails(const QString &bookingId);
+    QVector<Booking> queryUserBookings(const QString &userId);
+    Booking findBooking(const QString &bookingId);
+    QVector<Passenger> queryBookingPassengers(const QString &bookingId);
+    // 按 (created_at, id) 键集分页，userId 为空时列出全部预订
+    Page<Booking> queryBookingPage(const QString &userId, const PageKey &after = PageKey(),
+                                   int pageSize = 50);
     bool updateBookingStatus(const QString &bookingId, const QString &status);
     
-    // 系统统计
+    // 在一个事务中写入预订和乘客并按舱位扣减库存；库存按版本号乐观校验，冲突时自动重试
+    BookingResult createBooking(const Booking &booking, const QVector<Passenger> &passengers);
+    
+    // 座位库存：按航班和舱位维护，重设容量时保留已售座位数
+    bool setSeatInventory(const QString &flightNumber, const QString &classType, int capacity);
+    SeatInventory findSeatInventory(const QString &flightNumber, const QString &classType);
+    QVector<SeatInventory> querySeatInventory(const QString &flightNumber);
+    
+    // 座位分配：SeatMapEngine 建图时读取已分配座位，确认选座时写回乘客记录
+    QStringList queryAssignedSeats(const QString &flightNumber, const QString &classType);
+    // 乘客不属于该航班该舱位的有效预订时失败；previousSeat 返回换座前的座位
+    bool updatePassengerSeat(qint64 passengerId, const QString &flightNumber, const QString &classType,
+                             const QString &seatNumber, QString *previousSeat = nullptr);
+    
+    // 系统统计：读取由触发器维护的计数器，不扫描基表
     QJsonObject getFlightStatistics();
     QJsonObject getUserStatistics();
     QJsonObject getBookingStatistics();
+    // 单个计数器和某类计数器的全部键，scope 如 flight_status、flight_route、flight_day、
+    // user_status、user_role、booking_status、booking_day
+    qint64 counterValue(const QString &scope, const QString &key);
+    QJsonObject getCounterBreakdown(const QString &scope);
+    // 按基表重新计算全部计数器
+    bool rebuildStatistics();
+    QJsonObject getStatementCacheStatistics();
+    
+    // findFlight / findUser 前的读穿缓存，updateFlightStatus、updateUser、deleteUser 和导入时失效
+    QJsonObject getLookupCacheStatistics();
+    void setLookupCacheSize(qint64 maxBytes);
+    void clearLookupCaches();
     
     // 数据库维护
     bool createTables();
     void closeDatabase();
+    
+    // 查询计划检查：hotQueries() 列出各热点路径使用的 SQL
+    static QStringList hotQueries();
+    QStringList explainQueryPlan(const QString &sql);
+    
+    // 连接池：每个调用线程使用独立的连接，可在此调整池大小和空闲超时
+    ConnectionPool *pool() const;
+    
+    // 存储配置，应在 connectToDatabase 之前设置
+    void setStorageProfile(const StorageProfile &profile);
+    StorageProfile storageProfile() const;
 
 signals:
     void databaseConnected();
     void databaseError(const QString &error);
+    void importProgress(qint64 processed, qint64 total, double rowsPerSecond);
+    // 航线上的航班被新增、导入或修改状态后发出，供票价日历等派生数据增量刷新
+    void routeChanged(const QString &departure, const QString &destination);
 
 private:
-    QSqlDatabase database;
-    bool isConnected;
+    ConnectionPool *connectionPool;
+    std::atomic<bool> isConnected;
+    StorageProfile profile;
+    LruCache<QString, Flight> flightCache;
+    LruCache<QString, User> userCache;
+    // 用户缓存以用户名为键，按 id 的写操作经此找到缓存项；由 userNamesMutex 保护
+    QHash<qint64, QString> userNames;
+    QMutex userNamesMutex;
+    
+    // 当前线程的数据库连接
+    QSqlDatabase connection();
     
     void initializeDatabase();
     bool createFlightTable();
     bool createUserTable();
     bool createBookingTable();
     bool createPassengerTable();
+    bool createSeatInventoryTable();
+    bool addMissingColumns(const QString &table, const QStringList &definitions);
+    bool createIndexes();
+    bool createStatistics();
+    
+    ImportResult importFlightRecords(const std::function<bool(QJsonObject &)> &nextRecord,
+                                     qint64 total, int batchSize);
+    bool flushFlightBatch(const QVector<QJsonObject> &batch, ImportResult &result);
+    // 读取一条 CSV 记录，引号内的换行不结束记录；引号到文件末尾仍未闭合时返回 false
+    static bool readCsvRecord(QTextStream &stream, QString &record);
+    static QStringList parseCsvLine(const QString &line);
+    
+    bool writeBooking(const Booking &booking, const QVector<Passenger> &passengers,
+                      const QMap<QString, int> &seatsByClass, const QHash<QString, qint64> &versions,
+                      BookingResult &result);
+    
+    void invalidateUser(const QString &userId);
+    void invalidateFlights(const QVector<QJsonObject> &flights);
+    void notifyRoutes(const QVector<QJsonObject> &flights);
     
     QVariant executeScalar(const QString &query);
     QSqlQuery executeQuery(const QString &query, const QVariantList &params = QVariantList());
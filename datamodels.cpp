@@ -0,0 +1,192 @@
+#include "datamodels.h"
+#include <QJsonValue>
+
+namespace {
+
+// 兼容旧接口中以字符串形式传递的数值字段
+qint64 toInt64(const QJsonValue &value)
+{
+    return value.isString() ? value.toString().toLongLong() : qint64(value.toDouble());
+}
+
+double toDouble(const QJsonValue &value)
+{
+    return value.isString() ? value.toString().toDouble() : value.toDouble();
+}
+
+}
+
+QJsonObject Flight::toJson() const
+{
+    QJsonObject json;
+    json["id"] = id;
+    json["flight_number"] = flightNumber;
+    json["airline"] = airline;
+    json["departure"] = departure;
+    json["destination"] = destination;
+    json["departure_time"] = departureTime;
+    json["arrival_time"] = arrivalTime;
+    json["status"] = status;
+    json["gate"] = gate;
+    json["aircraft"] = aircraft;
+    json["created_at"] = createdAt;
+    json["price_economy"] = economyPrice;
+    json["price_business"] = businessPrice;
+    json["price_first"] = firstPrice;
+    return json;
+}
+
+double Flight::price(const QString &classType) const
+{
+    if (classType == "头等舱") {
+        return firstPrice;
+    }
+    if (classType == "商务舱") {
+        return businessPrice;
+    }
+    return economyPrice;
+}
+
+Flight Flight::fromJson(const QJsonObject &json)
+{
+    Flight flight;
+    flight.id = toInt64(json["id"]);
+    flight.flightNumber = json["flight_number"].toString();
+    flight.airline = json["airline"].toString();
+    flight.departure = json["departure"].toString();
+    flight.destination = json["destination"].toString();
+    flight.departureTime = json["departure_time"].toString();
+    flight.arrivalTime = json["arrival_time"].toString();
+    flight.status = json["status"].toString();
+    flight.gate = json["gate"].toString();
+    flight.aircraft = json["aircraft"].toString();
+    flight.createdAt = json["created_at"].toString();
+    flight.economyPrice = toDouble(json["price_economy"]);
+    flight.businessPrice = toDouble(json["price_business"]);
+    flight.firstPrice = toDouble(json["price_first"]);
+    return flight;
+}
+
+QJsonObject User::toJson() const
+{
+    QJsonObject json;
+    json["id"] = id;
+    json["username"] = username;
+    json["password"] = password;
+    json["email"] = email;
+    json["phone"] = phone;
+    json["first_name"] = firstName;
+    json["last_name"] = lastName;
+    json["role"] = role;
+    json["status"] = status;
+    json["created_at"] = createdAt;
+    return json;
+}
+
+User User::fromJson(const QJsonObject &json)
+{
+    User user;
+    user.id = toInt64(json["id"]);
+    user.username = json["username"].toString();
+    user.password = json["password"].toString();
+    user.email = json["email"].toString();
+    user.phone = json["phone"].toString();
+    user.firstName = json["first_name"].toString();
+    user.lastName = json["last_name"].toString();
+    user.role = json["role"].toString();
+    user.status = json["status"].toString();
+    user.createdAt = json["created_at"].toString();
+    return user;
+}
+
+QJsonObject Booking::toJson() const
+{
+    QJsonObject json;
+    json["id"] = id;
+    json["user_id"] = userId;
+    json["flight_number"] = flightNumber;
+    json["booking_date"] = bookingDate;
+    json["status"] = status;
+    json["total_price"] = totalPrice;
+    json["passenger_count"] = passengerCount;
+    json["created_at"] = createdAt;
+    return json;
+}
+
+Booking Booking::fromJson(const QJsonObject &json)
+{
+    Booking booking;
+    booking.id = toInt64(json["id"]);
+    booking.userId = toInt64(json["user_id"]);
+    booking.flightNumber = json["flight_number"].toString();
+    booking.bookingDate = json["booking_date"].toString();
+    booking.status = json["status"].toString();
+    booking.totalPrice = toDouble(json["total_price"]);
+    booking.passengerCount = json.contains("passenger_count") ? int(toInt64(json["passenger_count"])) : 1;
+    booking.createdAt = json["created_at"].toString();
+    return booking;
+}
+
+QJsonObject Passenger::toJson() const
+{
+    QJsonObject json;
+    json["id"] = id;
+    json["booking_id"] = bookingId;
+    json["first_name"] = firstName;
+    json["last_name"] = lastName;
+    json["id_number"] = idNumber;
+    json["seat_number"] = seatNumber;
+    json["class_type"] = classType;
+    return json;
+}
+
+Passenger Passenger::fromJson(const QJsonObject &json)
+{
+    Passenger passenger;
+    passenger.id = toInt64(json["id"]);
+    passenger.bookingId = toInt64(json["booking_id"]);
+    passenger.firstName = json["first_name"].toString();
+    passenger.lastName = json["last_name"].toString();
+    passenger.idNumber = json["id_number"].toString();
+    passenger.seatNumber = json["seat_number"].toString();
+    passenger.classType = json["class_type"].toString();
+    return passenger;
+}
+
+QJsonObject SeatInventory::toJson() const
+{
+    QJsonObject json;
+    json["flight_number"] = flightNumber;
+    json["class_type"] = classType;
+    json["capacity"] = capacity;
+    json["available"] = available;
+    json["version"] = version;
+    return json;
+}
+
+SeatInventory SeatInventory::fromJson(const QJsonObject &json)
+{
+    SeatInventory inventory;
+    inventory.flightNumber = json["flight_number"].toString();
+    inventory.classType = json["class_type"].toString();
+    inventory.capacity = int(toInt64(json["capacity"]));
+    inventory.available = int(toInt64(json["available"]));
+    inventory.version = toInt64(json["version"]);
+    return inventory;
+}
+
+QJsonObject PageKey::toJson() const
+{
+    QJsonObject json;
+    json["sort_value"] = sortValue;
+    json["id"] = id;
+    return json;
+}
+
+PageKey PageKey::fromJson(const QJsonObject &json)
+{
+    PageKey key;
+    key.sortValue = json["sort_value"].toString();
+    key.id = toInt64(json["id"]);
+    return key;
+}
@@ -0,0 +1,152 @@
+#ifndef DATAMODELS_H
+#define DATAMODELS_H
+
+#include <QString>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QVector>
+#include <QMetaType>
+
+// 数据库行的类型化表示
+// DatabaseHelper 按列序号直接解码为这些结构，JSON 只在 API 边界通过 toJson() 生成。
+
+// 航班
+struct Flight
+{
+    qint64 id = 0;
+    QString flightNumber;
+    QString airline;
+    QString departure;
+    QString destination;
+    QString departureTime;
+    QString arrivalTime;
+    QString status;
+    QString gate;
+    QString aircraft;
+    QString createdAt;
+    // 各舱位票价，0 表示未定价
+    double economyPrice = 0.0;
+    double businessPrice = 0.0;
+    double firstPrice = 0.0;
+
+    bool isValid() const { return id > 0; }
+    double price(const QString &classType) const;
+
+    QJsonObject toJson() const;
+    static Flight fromJson(const QJsonObject &json);
+};
+
+// 用户
+struct User
+{
+    qint64 id = 0;
+    QString username;
+    QString password;
+    QString email;
+    QString phone;
+    QString firstName;
+    QString lastName;
+    QString role;
+    QString status;
+    QString createdAt;
+
+    bool isValid() const { return id > 0; }
+
+    QJsonObject toJson() const;
+    static User fromJson(const QJsonObject &json);
+};
+
+// 预订
+struct Booking
+{
+    qint64 id = 0;
+    qint64 userId = 0;
+    QString flightNumber;
+    QString bookingDate;
+    QString status;
+    double totalPrice = 0.0;
+    int passengerCount = 1;
+    QString createdAt;
+
+    bool isValid() const { return id > 0; }
+
+    QJsonObject toJson() const;
+    static Booking fromJson(const QJsonObject &json);
+};
+
+// 乘客
+struct Passenger
+{
+    qint64 id = 0;
+    qint64 bookingId = 0;
+    QString firstName;
+    QString lastName;
+    QString idNumber;
+    QString seatNumber;
+    QString classType;
+
+    bool isValid() const { return id > 0; }
+
+    QJsonObject toJson() const;
+    static Passenger fromJson(const QJsonObject &json);
+};
+
+// 航班某一舱位的座位库存，version 在每次扣减时递增，用于乐观并发校验
+struct SeatInventory
+{
+    QString flightNumber;
+    QString classType;
+    int capacity = 0;
+    int available = 0;
+    qint64 version = 0;
+
+    bool isValid() const { return !flightNumber.isEmpty(); }
+
+    QJsonObject toJson() const;
+    static SeatInventory fromJson(const QJsonObject &json);
+};
+
+// 键集分页位置：上一页最后一行的排序键和 id，id 为 0 表示从第一页开始
+struct PageKey
+{
+    QString sortValue;
+    qint64 id = 0;
+
+    bool isFirst() const { return id == 0; }
+
+    QJsonObject toJson() const;
+    static PageKey fromJson(const QJsonObject &json);
+};
+
+// 一页查询结果，next 作为请求下一页时的位置
+template<typename T>
+struct Page
+{
+    QVector<T> items;
+    PageKey next;
+    bool hasMore = false;
+
+    QJsonObject toJson() const
+    {
+        QJsonArray array;
+        for (const T &item : items) {
+            array.append(item.toJson());
+        }
+
+        QJsonObject json;
+        json["items"] = array;
+        json["has_more"] = hasMore;
+        if (hasMore) {
+            json["next_cursor"] = next.toJson();
+        }
+        return json;
+    }
+};
+
+Q_DECLARE_METATYPE(Flight)
+Q_DECLARE_METATYPE(User)
+Q_DECLARE_METATYPE(Booking)
+Q_DECLARE_METATYPE(Passenger)
+Q_DECLARE_METATYPE(SeatInventory)
+
+#endif // DATAMODELS_H
@@ -0,0 +1,298 @@
+#include "farecalendar.h"
+#include "databasehelper.h"
+#include "asyncdatabasehelper.h"
+#include <QFutureWatcher>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace {
+
+const char *const CABINS[] = {"经济舱", "商务舱", "头等舱"};
+const int CABIN_COUNT = 3;
+
+}
+
+FareCalendar::FareCalendar(DatabaseHelper *helper, QObject *parent)
+    : QObject(parent)
+    , databaseHelper(helper)
+    , asyncDatabase(nullptr)
+    , rolloverTimer(new QTimer(this))
+    , refreshTimer(new QTimer(this))
+    , rebuilding(false)
+{
+    connect(databaseHelper, &DatabaseHelper::routeChanged, this, &FareCalendar::scheduleRefresh);
+
+    // 第一条通知到达后开始计时，期间到达的通知一并处理，不因持续写入而无限推迟
+    refreshTimer->setSingleShot(true);
+    refreshTimer->setInterval(RefreshDelayMs);
+    connect(refreshTimer, &QTimer::timeout, this, &FareCalendar::flushPendingRoutes);
+
+    // 每小时检查一次日期，跨天后窗口前移
+    rolloverTimer->setInterval(60 * 60 * 1000);
+    connect(rolloverTimer, &QTimer::timeout, this, &FareCalendar::checkRollover);
+    rolloverTimer->start();
+}
+
+QDate FareCalendar::startDate() const
+{
+    QReadLocker locker(&lock);
+    return windowStart;
+}
+
+void FareCalendar::setAsyncDatabase(AsyncDatabaseHelper *async)
+{
+    asyncDatabase = async;
+}
+
+bool FareCalendar::rebuild(const QDate &start)
+{
+    const Snapshot snapshot = buildAll(databaseHelper, start);
+    if (!snapshot.valid) {
+        return false;
+    }
+    apply(snapshot);
+    return true;
+}
+
+void FareCalendar::requestRebuild()
+{
+    if (!asyncDatabase) {
+        rebuild();
+        return;
+    }
+    if (rebuilding) {
+        return;
+    }
+    rebuilding = true;
+
+    const QDate start = QDate::currentDate();
+    auto *watcher = new QFutureWatcher<Snapshot>(this);
+    connect(watcher, &QFutureWatcher<Snapshot>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        rebuilding = false;
+        if (!watcher->isCanceled() && watcher->future().resultCount() > 0) {
+            apply(watcher->result());
+        }
+        // 重建期间攒下的通知在新窗口上补算
+        if (!pendingRoutes.isEmpty()) {
+            refreshTimer->start();
+        }
+    });
+    watcher->setFuture(asyncDatabase->submit<Snapshot>([start](DatabaseHelper *helper) {
+        return buildAll(helper, start);
+    }));
+}
+
+void FareCalendar::refreshRoute(const QString &departure, const QString &destination)
+{
+    const QDate start = startDate();
+    if (!start.isValid()) {
+        return;
+    }
+    pendingRoutes.remove(Route(departure, destination));
+    apply(buildRoutes(databaseHelper, start, {Route(departure, destination)}));
+}
+
+void FareCalendar::scheduleRefresh(const QString &departure, const QString &destination)
+{
+    pendingRoutes.insert(Route(departure, destination));
+    if (!refreshTimer->isActive()) {
+        refreshTimer->start();
+    }
+}
+
+void FareCalendar::flushPendingRoutes()
+{
+    // 重建完成后会重新触发
+    if (pendingRoutes.isEmpty() || rebuilding) {
+        return;
+    }
+
+    // 还没有建过日历时没有可更新的窗口，首次重建会包含这些变化
+    const QDate start = startDate();
+    if (!start.isValid()) {
+        pendingRoutes.clear();
+        return;
+    }
+
+    // 变化的航线很多（如整批导入）时一次全表扫描比逐条查询便宜
+    if (pendingRoutes.size() > MaxIncrementalRoutes) {
+        pendingRoutes.clear();
+        requestRebuild();
+        return;
+    }
+
+    const QVector<Route> changed(pendingRoutes.begin(), pendingRoutes.end());
+    pendingRoutes.clear();
+    if (!asyncDatabase) {
+        apply(buildRoutes(databaseHelper, start, changed));
+        return;
+    }
+
+    auto *watcher = new QFutureWatcher<Snapshot>(this);
+    connect(watcher, &QFutureWatcher<Snapshot>::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        if (!watcher->isCanceled() && watcher->future().resultCount() > 0) {
+            apply(watcher->result());
+        }
+    });
+    watcher->setFuture(asyncDatabase->submit<Snapshot>([start, changed](DatabaseHelper *helper) {
+        return buildRoutes(helper, start, changed);
+    }));
+}
+
+double FareCalendar::lowestFare(const QString &departure, const QString &destination, const QDate &date,
+                                const QString &classType) const
+{
+    const QVector<double> day = fares(departure, destination, date, 1, classType);
+    return day.isEmpty() ? 0.0 : day.first();
+}
+
+QVector<double> FareCalendar::fares(const QString &departure, const QString &destination, const QDate &from,
+                                    int days, const QString &classType) const
+{
+    QVector<double> result(qMax(0, days), 0.0);
+
+    QReadLocker locker(&lock);
+    auto it = routes.constFind(routeKey(departure, destination));
+    if (it == routes.constEnd() || !windowStart.isValid()) {
+        return result;
+    }
+
+    const float *cabin = it->constData() + cabinIndex(classType) * Days;
+    const qint64 offset = windowStart.daysTo(from);
+    for (int i = 0; i < result.size(); ++i) {
+        const qint64 day = offset + i;
+        if (day >= 0 && day < Days) {
+            result[i] = cabin[day];
+        }
+    }
+    return result;
+}
+
+QVector<double> FareCalendar::monthFares(const QString &departure, const QString &destination, int year,
+                                         int month, const QString &classType) const
+{
+    const QDate first(year, month, 1);
+    return fares(departure, destination, first, first.daysInMonth(), classType);
+}
+
+int FareCalendar::routeCount() const
+{
+    QReadLocker locker(&lock);
+    return routes.size();
+}
+
+QString FareCalendar::routeKey(const QString &departure, const QString &destination)
+{
+    return departure + QChar('\x1f') + destination;
+}
+
+int FareCalendar::cabinIndex(const QString &classType)
+{
+    for (int i = 0; i < CABIN_COUNT; ++i) {
+        if (classType == CABINS[i]) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void FareCalendar::accumulate(QVector<float> &fares, const Flight &flight, const QDate &start)
+{
+    if (flight.status.contains("取消")) {
+        return;
+    }
+
+    const QDate date = QDate::fromString(flight.departureTime.left(10), "yyyy-MM-dd");
+    const qint64 day = start.daysTo(date);
+    if (!date.isValid() || day < 0 || day >= Days) {
+        return;
+    }
+
+    for (int cabin = 0; cabin < CABIN_COUNT; ++cabin) {
+        const float price = float(flight.price(CABINS[cabin]));
+        float &lowest = fares[cabin * Days + day];
+        if (price > 0.0f && (lowest == 0.0f || price < lowest)) {
+            lowest = price;
+        }
+    }
+}
+
+FareCalendar::Snapshot FareCalendar::buildAll(DatabaseHelper *helper, const QDate &start)
+{
+    Snapshot snapshot;
+    snapshot.start = start;
+    snapshot.complete = true;
+
+    FlightCursor cursor = helper->openFlightCursor();
+    if (!cursor.isValid()) {
+        return snapshot;
+    }
+    while (!cursor.atEnd()) {
+        for (const Flight &flight : cursor.nextBatch()) {
+            QVector<float> &fares = snapshot.routes[routeKey(flight.departure, flight.destination)];
+            if (fares.isEmpty()) {
+                fares.fill(0.0f, CABIN_COUNT * Days);
+            }
+            accumulate(fares, flight, start);
+        }
+    }
+    snapshot.valid = true;
+    return snapshot;
+}
+
+FareCalendar::Snapshot FareCalendar::buildRoutes(DatabaseHelper *helper, const QDate &start,
+                                                 const QVector<Route> &changed)
+{
+    Snapshot snapshot;
+    snapshot.start = start;
+    snapshot.changed = changed;
+    for (const Route &route : changed) {
+        QVector<float> fares(CABIN_COUNT * Days, 0.0f);
+        for (const Flight &flight : helper->queryFlights(route.first, route.second)) {
+            accumulate(fares, flight, start);
+        }
+        snapshot.routes.insert(routeKey(route.first, route.second), fares);
+    }
+    snapshot.valid = true;
+    return snapshot;
+}
+
+void FareCalendar::apply(const Snapshot &snapshot)
+{
+    if (!snapshot.valid) {
+        return;
+    }
+
+    {
+        QWriteLocker locker(&lock);
+        if (snapshot.complete) {
+            windowStart = snapshot.start;
+            routes = snapshot.routes;
+        } else {
+            // 计算期间窗口已经前移，结果作废，新窗口的重建已包含这些航线
+            if (snapshot.start != windowStart) {
+                return;
+            }
+            for (auto it = snapshot.routes.constBegin(); it != snapshot.routes.constEnd(); ++it) {
+                routes.insert(it.key(), it.value());
+            }
+        }
+    }
+
+    if (snapshot.complete) {
+        emit calendarRebuilt();
+        return;
+    }
+    for (const Route &route : snapshot.changed) {
+        emit calendarUpdated(route.first, route.second);
+    }
+}
+
+void FareCalendar::checkRollover()
+{
+    if (startDate().isValid() && startDate() != QDate::currentDate()) {
+        requestRebuild();
+    }
+}
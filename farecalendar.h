@@ -0,0 +1,97 @@
+#ifndef FARECALENDAR_H
+#define FARECALENDAR_H
+
+#include <QObject>
+#include <QDate>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QTimer>
+#include <QReadWriteLock>
+#include "datamodels.h"
+
+class DatabaseHelper;
+class AsyncDatabaseHelper;
+
+// 低价日历：每条航线、每个舱位保存未来 365 天的最低票价
+// 每条航线一段连续的 float 数组（3 个舱位 × 365 天），按日期下标直接读取，
+// 日期选择器取一个月的价格只需一次哈希查找。数据库中航线变化时只重算该航线，
+// 日期跨天后整体前移窗口重建。0 表示当天无航班或未定价。
+// routeChanged 通知先攒一小段时间再一起重算，一次导入触发的大量通知只查询一轮，
+// 变化的航线太多时改为全量重建；设置了 AsyncDatabaseHelper 时查询在数据库工作线程执行。
+class FareCalendar : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int Days = 365;
+    static const int RefreshDelayMs = 200;
+    static const int MaxIncrementalRoutes = 64;
+
+    explicit FareCalendar(DatabaseHelper *helper, QObject *parent = nullptr);
+
+    QDate startDate() const;
+
+    // 之后的航线刷新和跨天重建改在工作线程上查询，GUI 线程只替换结果
+    void setAsyncDatabase(AsyncDatabaseHelper *async);
+
+    // 同步全量重建，窗口从 start 开始
+    bool rebuild(const QDate &start = QDate::currentDate());
+    // 从今天开始全量重建，设置了 AsyncDatabaseHelper 时不阻塞调用线程
+    void requestRebuild();
+    // 立即重新计算单条航线
+    void refreshRoute(const QString &departure, const QString &destination);
+
+    double lowestFare(const QString &departure, const QString &destination, const QDate &date,
+                      const QString &classType = "经济舱") const;
+    // 从 from 开始连续 days 天的最低票价，窗口外的日期为 0
+    QVector<double> fares(const QString &departure, const QString &destination, const QDate &from,
+                          int days, const QString &classType = "经济舱") const;
+    QVector<double> monthFares(const QString &departure, const QString &destination, int year, int month,
+                               const QString &classType = "经济舱") const;
+
+    int routeCount() const;
+
+signals:
+    void calendarUpdated(const QString &departure, const QString &destination);
+    void calendarRebuilt();
+
+private slots:
+    void scheduleRefresh(const QString &departure, const QString &destination);
+    void flushPendingRoutes();
+    void checkRollover();
+
+private:
+    typedef QPair<QString, QString> Route;
+
+    // 在任意线程上算出的一组航线票价，回到 GUI 线程后整体替换
+    struct Snapshot
+    {
+        QDate start;
+        bool valid = false;
+        bool complete = false;          // 全量结果，替换全部航线
+        QVector<Route> changed;
+        QHash<QString, QVector<float>> routes;
+    };
+
+    DatabaseHelper *databaseHelper;
+    AsyncDatabaseHelper *asyncDatabase;
+    QTimer *rolloverTimer;
+    QTimer *refreshTimer;
+    QSet<Route> pendingRoutes;
+    bool rebuilding;
+    mutable QReadWriteLock lock;
+    QDate windowStart;
+    QHash<QString, QVector<float>> routes;
+
+    static QString routeKey(const QString &departure, const QString &destination);
+    static int cabinIndex(const QString &classType);
+    static void accumulate(QVector<float> &fares, const Flight &flight, const QDate &start);
+    static Snapshot buildAll(DatabaseHelper *helper, const QDate &start);
+    static Snapshot buildRoutes(DatabaseHelper *helper, const QDate &start, const QVector<Route> &changed);
+    void apply(const Snapshot &snapshot);
+};
+
+#endif // FARECALENDAR_H
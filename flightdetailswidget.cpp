@@ -1,4 +1,5 @@
 #include "flightdetailswidget.h"
+#include "seatmap.h"
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QDateTime>
@@ -7,6 +8,7 @@
 
 FlightDetailsWidget::FlightDetailsWidget(QWidget *parent)
     : QWidget(parent)
+    , seatMapEngine(nullptr)
 {
     setupUI();
     connectSignals();
@@ -14,6 +16,22 @@ FlightDetailsWidget::FlightDetailsWidget(QWidget *parent)
     applyStyles();
 }
 
+void FlightDetailsWidget::setSeatMapEngine(SeatMapEngine *engine)
+{
+    if (seatMapEngine) {
+        disconnect(seatMapEngine, nullptr, this, nullptr);
+    }
+    seatMapEngine = engine;
+    if (!seatMapEngine) return;
+    
+    // 正在查看的航班有座位变动时刷新乘客页
+    connect(seatMapEngine, &SeatMapEngine::seatChanged, this, [this](const QString &flightNumber) {
+        if (flightNumber == flightNumberLabel->text()) {
+            showSeatAssignments(flightNumber);
+        }
+    });
+}
+
 void FlightDetailsWidget::setupUI()
 {
     mainLayout = new QVBoxLayout(this);
@@ -82,13 +100,14 @@ void FlightDetailsWidget::setupFlightTable()
     flightCountLabel = new QLabel("航班总数: 0", this);
     mainLayout->addWidget(flightCountLabel);
     
-    flightTable = new QTableWidget(this);
-    flightTable->setColumnCount(10);
-    
-    QStringList headers;
-    headers << "航班号" << "航空公司" << "出发地" << "目的地" << "计划起飞" 
-            << "实际起飞" << "计划到达" << "实际到达" << "状态" << "登机口";
-    flightTable->setHorizontalHeaderLabels(headers);
+    flightModel = new FlightTableModel(this);
+    flightModel->setColumns({FlightTableModel::FlightNumber, FlightTableModel::Airline,
+                             FlightTableModel::Departure, FlightTableModel::Destination,
+                             FlightTableModel::DepartureTime, FlightTableModel::ArrivalTime,
+                             FlightTableModel::Aircraft, FlightTableModel::Status, FlightTableModel::Gate});
+    filterEngine = new TableFilterEngine(flightModel, this);
+    flightTable = new QTableView(this);
+    flightTable->setModel(filterEngine->proxyModel());
     
     // 设置表格属性
     flightTable->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -97,17 +116,20 @@ void FlightDetailsWidget::setupFlightTable()
     flightTable->horizontalHeader()->setStretchLastSection(true);
     flightTable->verticalHeader()->setVisible(false);
     
+    // 固定行高，视图只需计算可见行
+    flightTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    flightTable->verticalHeader()->setDefaultSectionSize(32);
+    
     // 设置列宽
     flightTable->setColumnWidth(0, 80);  // 航班号
     flightTable->setColumnWidth(1, 120); // 航空公司
     flightTable->setColumnWidth(2, 100); // 出发地
     flightTable->setColumnWidth(3, 100); // 目的地
-    flightTable->setColumnWidth(4, 130); // 计划起飞
-    flightTable->setColumnWidth(5, 130); // 实际起飞
-    flightTable->setColumnWidth(6, 130); // 计划到达
-    flightTable->setColumnWidth(7, 130); // 实际到达
-    flightTable->setColumnWidth(8, 80);  // 状态
-    flightTable->setColumnWidth(9, 80);  // 登机口
+    flightTable->setColumnWidth(4, 130); // 出发时间
+    flightTable->setColumnWidth(5, 130); // 到达时间
+    flightTable->setColumnWidth(6, 130); // 机型
+    flightTable->setColumnWidth(7, 80);  // 状态
+    flightTable->setColumnWidth(8, 80);  // 登机口
     
     mainLayout->addWidget(flightTable);
 }
@@ -251,70 +273,59 @@ void FlightDetailsWidget::connectSignals()
     connect(searchButton, &QPushButton::clicked, this, &FlightDetailsWidget::searchFlightDetails);
     connect(clearButton, &QPushButton::clicked, this, &FlightDetailsWidget::clearSearch);
     connect(refreshButton, &QPushButton::clicked, this, &FlightDetailsWidget::refreshFlights);
-    connect(flightTable, &QTableWidget::cellClicked, this, &FlightDetailsWidget::onFlightSelected);
+    connect(flightTable, &QTableView::clicked, this, &FlightDetailsWidget::onFlightSelected);
     connect(exportButton, &QPushButton::clicked, this, &FlightDetailsWidget::exportFlightData);
     connect(printButton, &QPushButton::clicked, this, &FlightDetailsWidget::printFlightDetails);
     connect(mapButton, &QPushButton::clicked, this, [this]() {
-        int row = flightTable->currentRow();
+        const int row = filterEngine->sourceRow(flightTable->currentIndex());
         if (row >= 0) {
-            QString flightNumber = flightTable->item(row, 0)->text();
-            showFlightOnMap(flightNumber);
+            showFlightOnMap(flightModel->record(row).flightNumber);
         }
     });
 }
 
 void FlightDetailsWidget::loadSampleFlights()
 {
-    // 清空现有数据
-    flightTable->setRowCount(0);
-    
     // 模拟航班数据
-    QList<QStringList> sampleFlights = {
-        {"CA1234", "中国国际航空", "北京首都", "上海浦东", "08:00", "08:15", "10:30", "10:45", "延误", "A12"},
-        {"MU5678", "东方航空", "北京首都", "上海虹桥", "09:15", "09:10", "11:45", "11:40", "准点", "B08"},
-        {"CZ9012", "南方航空", "北京首都", "上海浦东", "10:30", "10:30", "13:00", "13:00", "准点", "C15"},
-        {"HU3456", "海南航空", "北京首都", "上海虹桥", "11:45", "12:00", "14:15", "14:30", "延误", "D22"},
-        {"FM7890", "上海航空", "北京首都", "上海浦东", "13:00", "13:00", "15:30", "15:30", "准点", "E05"},
-        {"JD2345", "首都航空", "北京首都", "上海虹桥", "14:15", "14:15", "16:45", "16:45", "准点", "F18"},
-        {"3U6789", "四川航空", "北京首都", "上海浦东", "15:30", "15:45", "18:00", "18:15", "延误", "G11"},
-        {"ZH1234", "深圳航空", "北京首都", "上海虹桥", "16:45", "16:45", "19:15", "19:15", "准点", "H09"}
+    const QList<QStringList> sampleFlights = {
+        {"CA1234", "中国国际航空", "北京首都", "上海浦东", "08:00", "10:30", "Boeing 737-800", "延误", "A12"},
+        {"MU5678", "东方航空", "北京首都", "上海虹桥", "09:15", "11:45", "Airbus A320", "准点", "B08"},
+        {"CZ9012", "南方航空", "北京首都", "上海浦东", "10:30", "13:00", "Airbus A321", "准点", "C15"},
+        {"HU3456", "海南航空", "北京首都", "上海虹桥", "11:45", "14:15", "Boeing 787-9", "延误", "D22"},
+        {"FM7890", "上海航空", "北京首都", "上海浦东", "13:00", "15:30", "Boeing 737-800", "准点", "E05"},
+        {"JD2345", "首都航空", "北京首都", "上海虹桥", "14:15", "16:45", "Airbus A320", "准点", "F18"},
+        {"3U6789", "四川航空", "北京首都", "上海浦东", "15:30", "18:00", "Airbus A330", "延误", "G11"},
+        {"ZH1234", "深圳航空", "北京首都", "上海虹桥", "16:45", "19:15", "Boeing 737-800", "准点", "H09"}
     };
     
-    for (const QStringList &flight : sampleFlights) {
-        int row = flightTable->rowCount();
-        flightTable->insertRow(row);
-        
-        for (int col = 0; col < flight.size(); ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(flight[col]);
-            item->setTextAlignment(Qt::AlignCenter);
-            
-            // 根据状态设置颜色
-            if (col == 8) { // 状态列
-                if (flight[col] == "延误") {
-                    item->setForeground(QColor(255, 100, 100)); // 红色
-                } else if (flight[col] == "准点") {
-                    item->setForeground(QColor(100, 255, 100)); // 绿色
-                } else if (flight[col] == "取消") {
-                    item->setForeground(QColor(255, 0, 0)); // 深红色
-                }
-            }
-            
-            flightTable->setItem(row, col, item);
-        }
+    QVector<Flight> flights;
+    flights.reserve(sampleFlights.size());
+    for (const QStringList &row : sampleFlights) {
+        Flight flight;
+        flight.flightNumber = row[0];
+        flight.airline = row[1];
+        flight.departure = row[2];
+        flight.destination = row[3];
+        flight.departureTime = row[4];
+        flight.arrivalTime = row[5];
+        flight.aircraft = row[6];
+        flight.status = row[7];
+        flight.gate = row[8];
+        flights.append(flight);
     }
     
-    flightCountLabel->setText(QString("航班总数: %1").arg(flightTable->rowCount()));
+    flightModel->setRecords(flights);
+    flightCountLabel->setText(QString("航班总数: %1").arg(flightModel->rowCount()));
 }
 
 void FlightDetailsWidget::loadFlightDetails()
 {
-    int currentRow = flightTable->currentRow();
-    if (currentRow < 0) {
+    const int row = filterEngine->sourceRow(flightTable->currentIndex());
+    if (row < 0) {
         return;
     }
     
-    QString flightNumber = flightTable->item(currentRow, 0)->text();
-    updateFlightInfo(flightNumber);
+    updateFlightInfo(flightModel->record(row).flightNumber);
 }
 
 void FlightDetailsWidget::refreshFlights()
@@ -327,32 +338,19 @@ void FlightDetailsWidget::searchFlightDetails()
 {
     QString searchText = searchEdit->text().trimmed();
     if (searchText.isEmpty()) {
-        loadSampleFlights();
+        filterEngine->clear();
         return;
     }
     
-    for (int i = 0; i < flightTable->rowCount(); ++i) {
-        bool match = false;
-        int searchColumn = searchTypeCombo->currentIndex();
-        
-        // 映射搜索类型到表格列
-        switch (searchColumn) {
-            case 0: searchColumn = 0; break; // 航班号
-            case 1: searchColumn = 1; break; // 航空公司
-            case 2: searchColumn = 2; break; // 出发地
-            case 3: searchColumn = 3; break; // 目的地
-            case 4: searchColumn = 8; break; // 状态
-        }
-        
-        if (searchColumn < flightTable->columnCount()) {
-            QTableWidgetItem *item = flightTable->item(i, searchColumn);
-            if (item && item->text().contains(searchText, Qt::CaseInsensitive)) {
-                match = true;
-            }
-        }
-        
-        flightTable->setRowHidden(i, !match);
-    }
+    // 映射搜索类型到模型列
+    const int searchColumns[] = {FlightTableModel::FlightNumber, FlightTableModel::Airline,
+                                 FlightTableModel::Departure, FlightTableModel::Destination,
+                                 FlightTableModel::Status};
+    const int searchType = qBound(0, searchTypeCombo->currentIndex(), 4);
+    const int column = flightModel->columnOf(searchColumns[searchType]);
+    
+    // 匹配在后台线程完成，结果整批交给代理模型
+    filterEngine->filter(column, searchText);
 }
 
 void FlightDetailsWidget::clearSearch()
@@ -360,16 +358,15 @@ void FlightDetailsWidget::clearSearch()
     searchEdit->clear();
     startDateEdit->setDate(QDate::currentDate().addDays(-7));
     endDateEdit->setDate(QDate::currentDate());
+    filterEngine->clear();
     loadSampleFlights();
 }
 
-void FlightDetailsWidget::onFlightSelected(int row, int column)
+void FlightDetailsWidget::onFlightSelected(const QModelIndex &index)
 {
-    Q_UNUSED(column);
-    
-    if (row >= 0 && row < flightTable->rowCount()) {
-        QString flightNumber = flightTable->item(row, 0)->text();
-        updateFlightInfo(flightNumber);
+    const int row = filterEngine->sourceRow(index);
+    if (row >= 0) {
+        updateFlightInfo(flightModel->record(row).flightNumber);
     }
 }
 
@@ -393,6 +390,62 @@ void FlightDetailsWidget::updateFlightInfo(const QString &flightNumber)
     altitudeLabel->setText("11,000 米");
     speedLabel->setText("850 km/h");
     
+    if (!showSeatAssignments(flightNumber)) {
+        showSamplePassengers();
+    }
+    
+    delayLabel->setText("延误: 15分钟");
+    cancelReasonLabel->setText("取消原因: -");
+    
+    QString statusHistory = QString("2024-01-01 06:00 - 航班计划\n")
+                          + QString("2024-01-01 07:30 - 开始值机\n")
+                          + QString("2024-01-01 08:00 - 计划起飞\n")
+                          + QString("2024-01-01 08:15 - 实际起飞 (延误15分钟)\n")
+                          + QString("2024-01-01 10:45 - 实际到达 (延误15分钟)");
+    statusHistoryEdit->setText(statusHistory);
+}
+
+bool FlightDetailsWidget::showSeatAssignments(const QString &flightNumber)
+{
+    if (!seatMapEngine || !seatMapEngine->loadFlight(flightNumber)) {
+        return false;
+    }
+    
+    // 按座位图列出已分配座位，载客率按机型布局的总座位数计算
+    static const QStringList classTypes = {"头等舱", "商务舱", "经济舱"};
+    passengerTable->setRowCount(0);
+    int capacity = 0;
+    int assigned = 0;
+    for (const QString &classType : classTypes) {
+        const SeatMap map = seatMapEngine->seatMap(flightNumber, classType);
+        if (!map.isValid()) {
+            continue;
+        }
+        capacity += map.capacity();
+        
+        const QStringList seats = map.assignedSeats();
+        assigned += seats.size();
+        for (const QString &seat : seats) {
+            const int row = passengerTable->rowCount();
+            passengerTable->insertRow(row);
+            const QStringList cells = {seat, "-", "-", classType, "已选座"};
+            for (int col = 0; col < cells.size(); ++col) {
+                QTableWidgetItem *item = new QTableWidgetItem(cells[col]);
+                item->setTextAlignment(Qt::AlignCenter);
+                passengerTable->setItem(row, col, item);
+            }
+        }
+    }
+    
+    const int loadFactor = capacity > 0 ? assigned * 100 / capacity : 0;
+    passengerCountLabel->setText(QString("乘客总数: %1").arg(assigned));
+    loadFactorLabel->setText(QString("载客率: %1%").arg(loadFactor));
+    loadProgressBar->setValue(loadFactor);
+    return true;
+}
+
+void FlightDetailsWidget::showSamplePassengers()
+{
     // 模拟乘客数据
     passengerTable->setRowCount(0);
     QList<QStringList> passengers = {
@@ -416,16 +469,6 @@ void FlightDetailsWidget::updateFlightInfo(const QString &flightNumber)
     passengerCountLabel->setText(QString("乘客总数: %1").arg(passengers.size()));
     loadFactorLabel->setText("载客率: 65%");
     loadProgressBar->setValue(65);
-    
-    delayLabel->setText("延误: 15分钟");
-    cancelReasonLabel->setText("取消原因: -");
-    
-    QString statusHistory = QString("2024-01-01 06:00 - 航班计划\n")
-                          + QString("2024-01-01 07:30 - 开始值机\n")
-                          + QString("2024-01-01 08:00 - 计划起飞\n")
-                          + QString("2024-01-01 08:15 - 实际起飞 (延误15分钟)\n")
-                          + QString("2024-01-01 10:45 - 实际到达 (延误15分钟)");
-    statusHistoryEdit->setText(statusHistory);
 }
 
 void FlightDetailsWidget::updateFlightStatistics()
@@ -499,16 +542,16 @@ void FlightDetailsWidget::applyStyles()
         QPushButton:pressed {
             background-color: #2968a3;
         }
-        QTableWidget {
+        QTableView {
             gridline-color: #e0e0e0;
             background-color: white;
             alternate-background-color: #f9f9f9;
             selection-background-color: #4a90e2;
         }
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
         }
-        QTableWidget::item:selected {
+        QTableView::item:selected {
             color: white;
         }
         QHeaderView::section {
@@ -8,6 +8,7 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
 #include <QLineEdit>
 #include <QTextEdit>
@@ -15,6 +16,10 @@
 #include <QProgressBar>
 #include <QCalendarWidget>
 #include <QTabWidget>
+#include "tablemodels.h"
+#include "tablefilter.h"
+
+class SeatMapEngine;
 
 class FlightDetailsWidget : public QWidget
 {
@@ -22,13 +27,16 @@ class FlightDetailsWidget : public QWidget
 
 public:
     explicit FlightDetailsWidget(QWidget *parent = nullptr);
+    
+    // 座位来源，未设置或航班不在数据库中时乘客页使用示例数据
+    void setSeatMapEngine(SeatMapEngine *engine);
 
 private slots:
     void loadFlightDetails();
     void refreshFlights();
     void searchFlightDetails();
     void clearSearch();
-    void onFlightSelected(int row, int column);
+    void onFlightSelected(const QModelIndex &index);
     void exportFlightData();
     void printFlightDetails();
 
@@ -43,6 +51,8 @@ private:
     void updateFlightInfo(const QString &flightNumber);
     void updateFlightStatistics();
     void showFlightOnMap(const QString &flightNumber);
+    bool showSeatAssignments(const QString &flightNumber);
+    void showSamplePassengers();
     
     // 搜索组件
     QComboBox *searchTypeCombo;
@@ -55,7 +65,9 @@ private:
     QDateEdit *endDateEdit;
     
     // 航班表格
-    QTableWidget *flightTable;
+    QTableView *flightTable;
+    FlightTableModel *flightModel;
+    TableFilterEngine *filterEngine;
     QLabel *flightCountLabel;
     
     // 详细信息标签页
@@ -111,6 +123,7 @@ private:
     
     // 数据
     QMap<QString, QStringList> flightDetails;
+    SeatMapEngine *seatMapEngine;
     
     // 样式设置
     void applyStyles();
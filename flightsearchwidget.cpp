@@ -1,21 +1,79 @@
 #include "flightsearchwidget.h"
+#include "airportindex.h"
+#include "apimanager.h"
+#include "farecalendar.h"
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QDateTime>
-#include <QTableWidgetItem>
 #include <QDebug>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QPointer>
+#include <QCalendarWidget>
+#include <QTextCharFormat>
+#include <QRegularExpression>
 
 FlightSearchWidget::FlightSearchWidget(QWidget *parent)
     : QWidget(parent)
     , isSearching(false)
-    , searchTimer(nullptr)
+    , searchTimer(new QTimer(this))
+    , debounceTimer(new QTimer(this))
+    , asyncDatabase(nullptr)
+    , apiManager(nullptr)
+    , fareCalendar(nullptr)
+    , searchWatcher(new QFutureWatcher<QVector<Flight>>(this))
+    , searchGeneration(0)
+    , localGeneration(0)
+    , networkTicket(0)
+    , networkAnswered(false)
+    , pendingSources(0)
+    , routeEngine(std::make_shared<RouteSearchEngine>())
+    , routesStale(std::make_shared<std::atomic<bool>>(true))
 {
+    // 两个计时器都只创建一次，重新 start() 即取消上一次
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(2000); // 模拟搜索延迟
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(300);
+    
     setupUI();
     connectSignals();
     loadSampleData();
     applyStyles();
 }
 
+void FlightSearchWidget::setDataSources(AsyncDatabaseHelper *database, APIManager *api)
+{
+    cancelPendingSearch();
+    
+    if (asyncDatabase) {
+        disconnect(asyncDatabase->helper(), nullptr, this, nullptr);
+    }
+    asyncDatabase = database;
+    apiManager = api;
+    routesStale->store(true);
+    
+    if (asyncDatabase) {
+        std::shared_ptr<std::atomic<bool>> stale = routesStale;
+        connect(asyncDatabase->helper(), &DatabaseHelper::routeChanged, this, [stale]() {
+            stale->store(true);
+        });
+    }
+}
+
+void FlightSearchWidget::setFareCalendar(FareCalendar *calendar)
+{
+    if (fareCalendar) {
+        disconnect(fareCalendar, nullptr, this, nullptr);
+    }
+    fareCalendar = calendar;
+    if (fareCalendar) {
+        connect(fareCalendar, &FareCalendar::calendarRebuilt, this, &FlightSearchWidget::updateFareHints);
+        connect(fareCalendar, &FareCalendar::calendarUpdated, this, &FlightSearchWidget::updateFareHints);
+    }
+    updateFareHints();
+}
+
 void FlightSearchWidget::setupUI()
 {
     mainLayout = new QVBoxLayout(this);
@@ -39,20 +97,25 @@ void FlightSearchWidget::setupSearchForm()
     // 出发地
     QLabel *departureLabel = new QLabel("出发地:", this);
     departureEdit = new QLineEdit(this);
+    departureEdit->setObjectName("departureEdit");
     departureEdit->setPlaceholderText("请输入出发城市");
+    setupCompleter(departureEdit);
     searchLayout->addWidget(departureLabel, 0, 0);
     searchLayout->addWidget(departureEdit, 0, 1);
     
     // 目的地
     QLabel *destinationLabel = new QLabel("目的地:", this);
     destinationEdit = new QLineEdit(this);
+    destinationEdit->setObjectName("destinationEdit");
     destinationEdit->setPlaceholderText("请输入目的地城市");
+    setupCompleter(destinationEdit);
     searchLayout->addWidget(destinationLabel, 0, 2);
     searchLayout->addWidget(destinationEdit, 0, 3);
     
     // 航班类型
     QLabel *tripTypeLabel = new QLabel("航班类型:", this);
     tripTypeCombo = new QComboBox(this);
+    tripTypeCombo->setObjectName("tripTypeCombo");
     tripTypeCombo->addItems({"单程", "往返", "多程"});
     searchLayout->addWidget(tripTypeLabel, 1, 0);
     searchLayout->addWidget(tripTypeCombo, 1, 1);
@@ -60,6 +123,7 @@ void FlightSearchWidget::setupSearchForm()
     // 出发日期
     QLabel *departureDateLabel = new QLabel("出发日期:", this);
     departureDateEdit = new QDateEdit(QDate::currentDate(), this);
+    departureDateEdit->setObjectName("departureDateEdit");
     departureDateEdit->setCalendarPopup(true);
     searchLayout->addWidget(departureDateLabel, 1, 2);
     searchLayout->addWidget(departureDateEdit, 1, 3);
@@ -67,6 +131,7 @@ void FlightSearchWidget::setupSearchForm()
     // 返程日期
     QLabel *returnDateLabel = new QLabel("返程日期:", this);
     returnDateEdit = new QDateEdit(QDate::currentDate().addDays(7), this);
+    returnDateEdit->setObjectName("returnDateEdit");
     returnDateEdit->setCalendarPopup(true);
     returnDateEdit->setEnabled(false); // 默认禁用，单程时不需要
     searchLayout->addWidget(returnDateLabel, 2, 0);
@@ -86,9 +151,15 @@ void FlightSearchWidget::setupSearchForm()
     searchLayout->addWidget(classTypeLabel, 3, 0);
     searchLayout->addWidget(classTypeCombo, 3, 1);
     
+    // 所选出发日期的最低价
+    lowestFareLabel = new QLabel("当日最低价: -", this);
+    lowestFareLabel->setObjectName("lowestFareLabel");
+    searchLayout->addWidget(lowestFareLabel, 3, 2, 1, 2);
+    
     // 按钮
     buttonLayout = new QHBoxLayout();
     searchButton = new QPushButton("搜索航班", this);
+    searchButton->setObjectName("searchButton");
     clearButton = new QPushButton("清除条件", this);
     buttonLayout->addWidget(searchButton);
     buttonLayout->addWidget(clearButton);
@@ -102,6 +173,8 @@ void FlightSearchWidget::setupSearchForm()
     connect(tripTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             [this](int index) {
                 returnDateEdit->setEnabled(index == 1); // 往返时启用返程日期
+                destinationEdit->setPlaceholderText(index == 2 ? "依次输入各目的地，用逗号分隔"
+                                                               : "请输入目的地城市");
             });
 }
 
@@ -110,13 +183,14 @@ void FlightSearchWidget::setupResultsTable()
     resultsLabel = new QLabel("搜索结果: 0 个航班", this);
     mainLayout->addWidget(resultsLabel);
     
-    resultsTable = new QTableWidget(this);
-    resultsTable->setColumnCount(8);
-    
-    QStringList headers;
-    headers << "航班号" << "出发地" << "目的地" << "出发时间" << "到达时间" 
-            << "航空公司" << "价格" << "状态";
-    resultsTable->setHorizontalHeaderLabels(headers);
+    resultsModel = new FlightTableModel(this);
+    resultsModel->setColumns({FlightTableModel::FlightNumber, FlightTableModel::Departure,
+                              FlightTableModel::Destination, FlightTableModel::DepartureTime,
+                              FlightTableModel::ArrivalTime, FlightTableModel::Airline,
+                              FlightTableModel::Price, FlightTableModel::Status});
+    resultsTable = new QTableView(this);
+    resultsTable->setObjectName("resultsTable");
+    resultsTable->setModel(resultsModel);
     
     // 设置表格属性
     resultsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -125,6 +199,10 @@ void FlightSearchWidget::setupResultsTable()
     resultsTable->horizontalHeader()->setStretchLastSection(true);
     resultsTable->verticalHeader()->setVisible(false);
     
+    // 固定行高，视图只需计算可见行
+    resultsTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    resultsTable->verticalHeader()->setDefaultSectionSize(32);
+    
     // 设置列宽
     resultsTable->setColumnWidth(0, 100); // 航班号
     resultsTable->setColumnWidth(1, 120); // 出发地
@@ -146,60 +224,348 @@ void FlightSearchWidget::setupStatusBar()
     mainLayout->addWidget(searchProgressBar);
 }
 
+void FlightSearchWidget::setupCompleter(QLineEdit *edit)
+{
+    QStringListModel *model = new QStringListModel(this);
+    QCompleter *completer = new QCompleter(model, this);
+    // 候选已由索引排序过滤，弹出框不再二次过滤
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(8);
+    edit->setCompleter(completer);
+
+    connect(edit, &QLineEdit::textEdited, this, [model, completer](const QString &text) {
+        QStringList suggestions;
+        for (const Airport &airport : AirportIndex::defaultIndex().suggest(text, 8)) {
+            suggestions.append(airport.displayText());
+        }
+        model->setStringList(suggestions);
+        if (!suggestions.isEmpty()) {
+            completer->complete();
+        }
+    });
+}
+
 void FlightSearchWidget::connectSignals()
 {
     connect(searchButton, &QPushButton::clicked, this, &FlightSearchWidget::searchFlights);
     connect(clearButton, &QPushButton::clicked, this, &FlightSearchWidget::clearSearch);
-    connect(resultsTable, &QTableWidget::cellClicked, this, &FlightSearchWidget::onFlightSelected);
+    connect(resultsTable, &QTableView::clicked, this, &FlightSearchWidget::onFlightSelected);
+    
+    connect(departureEdit, &QLineEdit::textEdited, this, &FlightSearchWidget::onSearchTextEdited);
+    connect(destinationEdit, &QLineEdit::textEdited, this, &FlightSearchWidget::onSearchTextEdited);
+    connect(debounceTimer, &QTimer::timeout, this, &FlightSearchWidget::onDebounceTimeout);
+    connect(searchTimer, &QTimer::timeout, this, &FlightSearchWidget::onSearchComplete);
+    connect(searchWatcher, &QFutureWatcher<QVector<Flight>>::finished,
+            this, &FlightSearchWidget::onLocalResultsReady);
+    
+    // 航线、日期、舱位或日历翻页变化时重新标注票价
+    connect(departureEdit, &QLineEdit::textChanged, this, &FlightSearchWidget::updateFareHints);
+    connect(destinationEdit, &QLineEdit::textChanged, this, &FlightSearchWidget::updateFareHints);
+    connect(departureDateEdit, &QDateEdit::dateChanged, this, &FlightSearchWidget::updateFareHints);
+    connect(classTypeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &FlightSearchWidget::updateFareHints);
+    connect(departureDateEdit->calendarWidget(), &QCalendarWidget::currentPageChanged,
+            this, &FlightSearchWidget::updateFareHints);
 }
 
 void FlightSearchWidget::searchFlights()
 {
-    if (isSearching) {
-        return;
-    }
-    
     // 验证输入
     if (departureEdit->text().isEmpty() || destinationEdit->text().isEmpty()) {
         QMessageBox::warning(this, "输入错误", "请填写出发地和目的地");
         return;
     }
     
-    if (departureEdit->text() == destinationEdit->text()) {
+    QString departure;
+    QString destination;
+    if (!resolveRoute(departure, destination)) {
         QMessageBox::warning(this, "输入错误", "出发地和目的地不能相同");
         return;
     }
     
+    startSearch(departure, destination);
+}
+
+void FlightSearchWidget::onSearchTextEdited()
+{
+    debounceTimer->start();
+}
+
+void FlightSearchWidget::onDebounceTimeout()
+{
+    // 自动搜索不弹出提示，条件不完整时等待继续输入
+    if (departureEdit->text().isEmpty() || destinationEdit->text().isEmpty()) {
+        return;
+    }
+    
+    QString departure;
+    QString destination;
+    if (resolveRoute(departure, destination)) {
+        startSearch(departure, destination);
+    }
+}
+
+void FlightSearchWidget::updateFareHints()
+{
+    QCalendarWidget *calendar = departureDateEdit->calendarWidget();
+    calendar->setDateTextFormat(QDate(), QTextCharFormat());
+    lowestFareLabel->setText("当日最低价: -");
+    
+    QString departure;
+    QString destination;
+    if (!fareCalendar || !resolveRoute(departure, destination) || departure.isEmpty() || destination.isEmpty()) {
+        return;
+    }
+    
+    // 第一次需要票价时才建日历，建好后由 calendarRebuilt 再次进入
+    if (!fareCalendar->startDate().isValid()) {
+        fareCalendar->requestRebuild();
+        return;
+    }
+    
+    // 弹出日历当前显示的月份逐日给出最低价提示，全月最低的日期加粗标绿
+    const QString classType = classTypeCombo->currentText();
+    const int year = calendar->yearShown();
+    const int month = calendar->monthShown();
+    const QVector<double> fares = fareCalendar->monthFares(departure, destination, year, month, classType);
+    double cheapest = 0.0;
+    for (double fare : fares) {
+        if (fare > 0.0 && (cheapest == 0.0 || fare < cheapest)) {
+            cheapest = fare;
+        }
+    }
+    for (int day = 0; day < fares.size(); ++day) {
+        if (fares[day] <= 0.0) {
+            continue;
+        }
+        QTextCharFormat format;
+        format.setToolTip(QString("最低价 ¥%1").arg(fares[day], 0, 'f', 0));
+        if (fares[day] == cheapest) {
+            format.setForeground(QColor("#2e7d32"));
+            format.setFontWeight(QFont::Bold);
+        }
+        calendar->setDateTextFormat(QDate(year, month, day + 1), format);
+    }
+    
+    const double fare = fareCalendar->lowestFare(departure, destination, departureDateEdit->date(), classType);
+    if (fare > 0.0) {
+        lowestFareLabel->setText(QString("当日最低价: ¥%1").arg(fare, 0, 'f', 0));
+    }
+}
+
+bool FlightSearchWidget::resolveRoute(QString &departure, QString &destination) const
+{
+    // 城市、机场名、拼音或三字码统一解析为城市名
+    const AirportIndex &airports = AirportIndex::defaultIndex();
+    departure = airports.resolveCity(departureEdit->text());
+    destination = airports.resolveCity(destinationEdit->text());
+    return departure != destination;
+}
+
+void FlightSearchWidget::startSearch(const QString &departure, const QString &destination)
+{
+    debounceTimer->stop();
+    cancelPendingSearch();
+    
+    const quint64 generation = ++searchGeneration;
+    networkAnswered = false;
+    // 往返和多程按行程搜索（含中转），只有本地航线图能回答
+    const bool byItinerary = asyncDatabase && tripTypeCombo->currentIndex() != 0;
+    pendingSources = byItinerary ? 1 : (asyncDatabase ? 1 : 0) + (apiManager ? 1 : 0);
     isSearching = true;
-    searchButton->setEnabled(false);
     searchProgressBar->setVisible(true);
     resultsLabel->setText("正在搜索...");
     
-    // 模拟搜索延迟
-    searchTimer = new QTimer(this);
-    connect(searchTimer, &QTimer::timeout, this, &FlightSearchWidget::onSearchComplete);
-    searchTimer->start(2000); // 2秒后完成搜索
+    if (byItinerary) {
+        searchToken = QueryCancelToken();
+        localGeneration = generation;
+        searchWatcher->setFuture(searchItineraries(departure, destination));
+        return;
+    }
+    
+    if (asyncDatabase) {
+        searchToken = QueryCancelToken();
+        localGeneration = generation;
+        searchWatcher->setFuture(asyncDatabase->submit<QVector<Flight>>(
+            [departure, destination](DatabaseHelper *helper) {
+                return helper->queryFlights(departure, destination);
+            }, searchToken));
+    }
+    
+    if (apiManager) {
+        // 回调只属于这次搜索；相同条件的搜索可能与其他调用方共用一个请求
+        QPointer<FlightSearchWidget> self(this);
+        networkTicket = apiManager->searchFlights(departure, destination, departureDateEdit->date(),
+            [self, generation](const QJsonObject &response, const QString &error) {
+                if (self) {
+                    self->onNetworkResults(generation, response, error);
+                }
+            });
+    }
+    
+    if (!asyncDatabase && !apiManager) {
+        searchTimer->start();
+    }
+}
+
+QFuture<QVector<Flight>> FlightSearchWidget::searchItineraries(const QString &departure,
+                                                              const QString &destination)
+{
+    // 往返：去程和返程两段；多程：目的地栏按顺序列出各城市，后一段在前一段最优行程到达当天出发
+    const AirportIndex &airports = AirportIndex::defaultIndex();
+    QStringList cities = {departure};
+    QVector<QDate> dates = {departureDateEdit->date()};
+    if (tripTypeCombo->currentIndex() == 1) {
+        cities << destination << departure;
+        dates << returnDateEdit->date();
+    } else {
+        static const QRegularExpression separators("[,，、;；]");
+        for (const QString &part : destinationEdit->text().split(separators, Qt::SkipEmptyParts)) {
+            const QString city = airports.resolveCity(part.trimmed());
+            if (!city.isEmpty() && city != cities.last()) {
+                cities << city;
+                dates << QDate();
+            }
+        }
+    }
+    
+    RouteSearchOptions options;
+    options.classType = classTypeCombo->currentText();
+    options.maxResults = 10;
+    
+    std::shared_ptr<RouteSearchEngine> engine = routeEngine;
+    std::shared_ptr<std::atomic<bool>> stale = routesStale;
+    return asyncDatabase->submit<QVector<Flight>>(
+        [engine, stale, cities, dates, options](DatabaseHelper *helper) {
+            if (stale->exchange(false) && !engine->rebuild(helper)) {
+                stale->store(true);
+            }
+            
+            // 每个行程汇总为一行：航班号相连，起止取首末航段，价格为所选舱位的总价
+            QVector<Flight> rows;
+            QDate previousArrival;
+            for (int i = 0; i + 1 < cities.size(); ++i) {
+                RouteSearchOptions segment = options;
+                segment.departureDate = dates.at(i).isValid() ? dates.at(i) : previousArrival;
+                const QVector<Itinerary> itineraries = engine->search(cities.at(i), cities.at(i + 1), segment);
+                for (const Itinerary &itinerary : itineraries) {
+                    QStringList flightNumbers;
+                    QStringList airlines;
+                    for (const Flight &leg : itinerary.legs) {
+                        flightNumbers << leg.flightNumber;
+                        if (!airlines.contains(leg.airline)) {
+                            airlines << leg.airline;
+                        }
+                    }
+                    Flight row;
+                    row.flightNumber = flightNumbers.join(" / ");
+                    row.airline = airlines.join("、");
+                    row.departure = itinerary.legs.first().departure;
+                    row.destination = itinerary.legs.last().destination;
+                    row.departureTime = itinerary.legs.first().departureTime;
+                    row.arrivalTime = itinerary.legs.last().arrivalTime;
+                    row.economyPrice = itinerary.totalPrice;     // 价格列显示 economyPrice
+                    row.status = itinerary.stops() == 0 ? itinerary.legs.first().status
+                                                        : QString("中转 %1 次").arg(itinerary.stops());
+                    rows.append(row);
+                }
+                if (!itineraries.isEmpty()) {
+                    previousArrival = QDate::fromString(itineraries.first().legs.last().arrivalTime.left(10),
+                                                        "yyyy-MM-dd");
+                }
+            }
+            return rows;
+        }, searchToken);
+}
+
+void FlightSearchWidget::cancelPendingSearch()
+{
+    // 令牌让排队中的查询直接跳过，QFutureWatcher 改为监视新的 future 后不会再报告旧结果
+    searchToken.cancel();
+    searchWatcher->cancel();
+    searchTimer->stop();
+    
+    // 只撤回本组件的回调，其他调用方合并到同一请求上的搜索不受影响
+    if (apiManager && networkTicket != 0) {
+        apiManager->cancelFlightSearch(networkTicket);
+    }
+    networkTicket = 0;
+    pendingSources = 0;
+    
+    isSearching = false;
+    searchProgressBar->setVisible(false);
+}
+
+void FlightSearchWidget::onLocalResultsReady()
+{
+    if (localGeneration != searchGeneration || searchWatcher->isCanceled()
+        || searchWatcher->future().resultCount() == 0) {
+        return;
+    }
+    finishSource();
+    if (!networkAnswered) {
+        showResults(searchWatcher->result());
+    }
+}
+
+void FlightSearchWidget::onNetworkResults(quint64 generation, const QJsonObject &response, const QString &error)
+{
+    if (generation != searchGeneration) {
+        return;
+    }
+    networkTicket = 0;
+    finishSource();
+    
+    // 网络失败时保留本地结果
+    if (!error.isEmpty()) {
+        if (!asyncDatabase) {
+            resultsLabel->setText("搜索失败: " + error);
+        }
+        return;
+    }
+    
+    networkAnswered = true;
+    const QJsonArray flights = response["flights"].toArray();
+    QVector<Flight> results;
+    results.reserve(flights.size());
+    for (const QJsonValue &value : flights) {
+        results.append(Flight::fromJson(value.toObject()));
+    }
+    showResults(results);
+}
+
+void FlightSearchWidget::finishSource()
+{
+    // 所有来源都返回后才结束搜索状态
+    pendingSources = qMax(0, pendingSources - 1);
+    if (pendingSources == 0) {
+        isSearching = false;
+        searchProgressBar->setVisible(false);
+    }
 }
 
 void FlightSearchWidget::onSearchComplete()
 {
     isSearching = false;
-    searchButton->setEnabled(true);
     searchProgressBar->setVisible(false);
     
     // 模拟搜索结果
     loadSampleData();
     
-    resultsLabel->setText(QString("搜索结果: %1 个航班").arg(resultsTable->rowCount()));
-    
-    if (searchTimer) {
-        searchTimer->deleteLater();
-        searchTimer = nullptr;
-    }
+    resultsLabel->setText(QString("搜索结果: %1 个航班").arg(resultsModel->rowCount()));
+}
+
+void FlightSearchWidget::showResults(const QVector<Flight> &flights)
+{
+    resultsModel->setRecords(flights);
+    resultsLabel->setText(QString("搜索结果: %1 个航班").arg(resultsModel->rowCount()));
 }
 
 void FlightSearchWidget::clearSearch()
 {
+    debounceTimer->stop();
+    cancelPendingSearch();
+    
     departureEdit->clear();
     destinationEdit->clear();
     departureDateEdit->setDate(QDate::currentDate());
@@ -208,61 +574,50 @@ void FlightSearchWidget::clearSearch()
     passengerCountCombo->setCurrentIndex(0);
     classTypeCombo->setCurrentIndex(0);
     
-    resultsTable->setRowCount(0);
+    resultsModel->setRecords(QVector<Flight>());
     resultsLabel->setText("搜索结果: 0 个航班");
 }
 
-void FlightSearchWidget::onFlightSelected(int row, int column)
+void FlightSearchWidget::onFlightSelected(const QModelIndex &index)
 {
-    Q_UNUSED(column);
-    
-    if (row >= 0 && row < resultsTable->rowCount()) {
-        QTableWidgetItem *item = resultsTable->item(row, 0);
-        if (item) {
-            QString flightNumber = item->text();
-            QMessageBox::information(this, "航班选择", 
-                                   QString("您选择了航班: %1").arg(flightNumber));
-        }
+    if (index.isValid()) {
+        const QString flightNumber = resultsModel->record(index.row()).flightNumber;
+        QMessageBox::information(this, "航班选择", 
+                               QString("您选择了航班: %1").arg(flightNumber));
     }
 }
 
 void FlightSearchWidget::loadSampleData()
 {
-    // 清空现有数据
-    resultsTable->setRowCount(0);
-    
     // 模拟航班数据
-    QList<QStringList> sampleFlights = {
-        {"CA1234", "北京", "上海", "08:00", "10:30", "中国国际航空", "¥1,280", "准点"},
-        {"MU5678", "北京", "上海", "09:15", "11:45", "东方航空", "¥1,150", "准点"},
-        {"CZ9012", "北京", "上海", "10:30", "13:00", "南方航空", "¥1,320", "延误"},
-        {"HU3456", "北京", "上海", "11:45", "14:15", "海南航空", "¥1,080", "准点"},
-        {"FM7890", "北京", "上海", "13:00", "15:30", "上海航空", "¥1,200", "准点"},
-        {"JD2345", "北京", "上海", "14:15", "16:45", "首都航空", "¥980", "准点"},
-        {"3U6789", "北京", "上海", "15:30", "18:00", "四川航空", "¥1,100", "准点"},
-        {"ZH1234", "北京", "上海", "16:45", "19:15", "深圳航空", "¥1,250", "准点"}
+    const QList<QStringList> sampleFlights = {
+        {"CA1234", "北京", "上海", "08:00", "10:30", "中国国际航空", "1280", "准点"},
+        {"MU5678", "北京", "上海", "09:15", "11:45", "东方航空", "1150", "准点"},
+        {"CZ9012", "北京", "上海", "10:30", "13:00", "南方航空", "1320", "延误"},
+        {"HU3456", "北京", "上海", "11:45", "14:15", "海南航空", "1080", "准点"},
+        {"FM7890", "北京", "上海", "13:00", "15:30", "上海航空", "1200", "准点"},
+        {"JD2345", "北京", "上海", "14:15", "16:45", "首都航空", "980", "准点"},
+        {"3U6789", "北京", "上海", "15:30", "18:00", "四川航空", "1100", "准点"},
+        {"ZH1234", "北京", "上海", "16:45", "19:15", "深圳航空", "1250", "准点"}
     };
     
-    for (const QStringList &flight : sampleFlights) {
-        int row = resultsTable->rowCount();
-        resultsTable->insertRow(row);
-        
-        for (int col = 0; col < flight.size(); ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(flight[col]);
-            item->setTextAlignment(Qt::AlignCenter);
-            
-            // 根据状态设置颜色
-            if (col == 7) { // 状态列
-                if (flight[col] == "延误") {
-                    item->setForeground(QColor(255, 100, 100)); // 红色
-                } else {
-                    item->setForeground(QColor(100, 255, 100)); // 绿色
-                }
-            }
-            
-            resultsTable->setItem(row, col, item);
-        }
+    QVector<Flight> flights;
+    flights.reserve(sampleFlights.size());
+    for (const QStringList &row : sampleFlights) {
+        Flight flight;
+        flight.flightNumber = row[0];
+        flight.departure = row[1];
+        flight.destination = row[2];
+        flight.departureTime = row[3];
+        flight.arrivalTime = row[4];
+        flight.airline = row[5];
+        flight.economyPrice = row[6].toDouble();
+        flight.status = row[7];
+        flights.append(flight);
     }
+    
+    // 一次性替换，视图只重新布局一次
+    resultsModel->setRecords(flights);
 }
 
 void FlightSearchWidget::updateSearchProgress()
@@ -314,16 +669,16 @@ void FlightSearchWidget::applyStyles()
             background-color: #cccccc;
             color: #666666;
         }
-        QTableWidget {
+        QTableView {
             gridline-color: #e0e0e0;
             background-color: white;
             alternate-background-color: #f9f9f9;
             selection-background-color: #4a90e2;
         }
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
         }
-        QTableWidget::item:selected {
+        QTableView::item:selected {
             color: white;
         }
         QHeaderView::section {
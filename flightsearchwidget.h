@@ -9,11 +9,18 @@
 #include <QComboBox>
 #include <QDateEdit>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
 #include <QLabel>
 #include <QGroupBox>
 #include <QProgressBar>
 #include <QTimer>
+#include <QFutureWatcher>
+#include "tablemodels.h"
+#include "asyncdatabasehelper.h"
+#include "routesearch.h"
+
+class APIManager;
+class FareCalendar;
 
 class FlightSearchWidget : public QWidget
 {
@@ -21,13 +28,22 @@ class FlightSearchWidget : public QWidget
 
 public:
     explicit FlightSearchWidget(QWidget *parent = nullptr);
+    
+    // 搜索数据来源，均未设置时使用示例数据
+    void setDataSources(AsyncDatabaseHelper *database, APIManager *api);
+    // 低价日历：在出发日期的弹出日历上标注每天最低价，首次查价时才建日历
+    void setFareCalendar(FareCalendar *calendar);
 
 private slots:
     void searchFlights();
+    void onSearchTextEdited();
+    void onDebounceTimeout();
+    void onLocalResultsReady();
     void clearSearch();
-    void onFlightSelected(int row, int column);
+    void onFlightSelected(const QModelIndex &index);
     void onSearchComplete();
     void updateSearchProgress();
+    void updateFareHints();
 
 private:
     void setupUI();
@@ -36,6 +52,14 @@ private:
     void setupStatusBar();
     void connectSignals();
     void loadSampleData();
+    void setupCompleter(QLineEdit *edit);
+    bool resolveRoute(QString &departure, QString &destination) const;
+    void startSearch(const QString &departure, const QString &destination);
+    QFuture<QVector<Flight>> searchItineraries(const QString &departure, const QString &destination);
+    void cancelPendingSearch();
+    void onNetworkResults(quint64 generation, const QJsonObject &response, const QString &error);
+    void finishSource();
+    void showResults(const QVector<Flight> &flights);
     
     // 搜索表单组件
     QGroupBox *searchGroupBox;
@@ -46,11 +70,13 @@ private:
     QComboBox *tripTypeCombo;
     QComboBox *passengerCountCombo;
     QComboBox *classTypeCombo;
+    QLabel *lowestFareLabel;
     QPushButton *searchButton;
     QPushButton *clearButton;
     
     // 结果表格
-    QTableWidget *resultsTable;
+    QTableView *resultsTable;
+    FlightTableModel *resultsModel;
     QLabel *resultsLabel;
     QProgressBar *searchProgressBar;
     
@@ -59,9 +85,29 @@ private:
     QHBoxLayout *buttonLayout;
     QGridLayout *searchLayout;
     
+    // 往返和多程的行程搜索（含中转）使用航线图，航线图只在工作线程上访问，
+    // 航班变化后在下一次行程搜索时重建
+    std::shared_ptr<RouteSearchEngine> routeEngine;
+    std::shared_ptr<std::atomic<bool>> routesStale;
+    
     // 搜索状态
+    // 边输入边搜索：按键重启 debounceTimer，停顿后才发起搜索；新的搜索会取消
+    // 尚未完成的数据库查询并撤回本组件的网络回调，两个来源的结果都带搜索代次，
+    // 只有最新一次搜索的结果会显示。同一次搜索中网络结果优先：本地结果先到时先显示，
+    // 网络结果到达后替换；网络结果先到时丢弃之后的本地结果
     bool isSearching;
     QTimer *searchTimer;
+    QTimer *debounceTimer;
+    AsyncDatabaseHelper *asyncDatabase;
+    APIManager *apiManager;
+    FareCalendar *fareCalendar;
+    QueryCancelToken searchToken;
+    QFutureWatcher<QVector<Flight>> *searchWatcher;
+    quint64 searchGeneration;
+    quint64 localGeneration;        // searchWatcher 当前监视的查询所属代次
+    quint64 networkTicket;
+    bool networkAnswered;
+    int pendingSources;
     
     // 样式设置
     void applyStyles();
@@ -0,0 +1,120 @@
+#include "httpcache.h"
+#include <QBuffer>
+#include <QDateTime>
+
+namespace {
+
+// 内存层默认 2MB
+const qint64 DEFAULT_MEMORY_BYTES = 2 * 1024 * 1024;
+
+}
+
+HttpResponseCache::HttpResponseCache(QObject *parent)
+    : QNetworkDiskCache(parent)
+    , memory(DEFAULT_MEMORY_BYTES)
+{
+}
+
+QNetworkCacheMetaData HttpResponseCache::metaData(const QUrl &url)
+{
+    Entry entry;
+    return loadEntry(url, &entry) ? entry.metaData : QNetworkCacheMetaData();
+}
+
+void HttpResponseCache::updateMetaData(const QNetworkCacheMetaData &metaData)
+{
+    // 磁盘层会经由 data()/prepare()/insert() 重写条目，内存层直接丢弃等待下次读取
+    memory.remove(metaData.url());
+    QNetworkDiskCache::updateMetaData(metaData);
+}
+
+QIODevice *HttpResponseCache::data(const QUrl &url)
+{
+    Entry entry;
+    if (!loadEntry(url, &entry)) {
+        return nullptr;
+    }
+
+    QBuffer *buffer = new QBuffer;
+    buffer->setData(entry.body);
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+bool HttpResponseCache::remove(const QUrl &url)
+{
+    memory.remove(url);
+    for (auto it = pending.begin(); it != pending.end();) {
+        it = it.value() == url ? pending.erase(it) : it + 1;
+    }
+    return QNetworkDiskCache::remove(url);
+}
+
+QIODevice *HttpResponseCache::prepare(const QNetworkCacheMetaData &metaData)
+{
+    QIODevice *device = QNetworkDiskCache::prepare(metaData);
+    if (device) {
+        pending.insert(device, metaData.url());
+    }
+    return device;
+}
+
+void HttpResponseCache::insert(QIODevice *device)
+{
+    const QUrl url = pending.take(device);
+    if (!url.isEmpty()) {
+        memory.remove(url);
+    }
+    QNetworkDiskCache::insert(device);
+}
+
+void HttpResponseCache::expire(const QUrl &url)
+{
+    QNetworkCacheMetaData expired = metaData(url);
+    if (!expired.isValid()) {
+        return;
+    }
+    expired.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(-1));
+    updateMetaData(expired);
+}
+
+void HttpResponseCache::setMemoryCacheSize(qint64 bytes)
+{
+    memory.setMaxBytes(bytes);
+}
+
+CacheStatistics HttpResponseCache::memoryStatistics() const
+{
+    return memory.statistics();
+}
+
+void HttpResponseCache::clear()
+{
+    memory.clear();
+    pending.clear();
+    QNetworkDiskCache::clear();
+}
+
+bool HttpResponseCache::loadEntry(const QUrl &url, Entry *entry)
+{
+    if (memory.lookup(url, entry)) {
+        return true;
+    }
+
+    const quint64 generation = memory.generation();
+    const QNetworkCacheMetaData diskMetaData = QNetworkDiskCache::metaData(url);
+    if (!diskMetaData.isValid()) {
+        return false;
+    }
+
+    QIODevice *device = QNetworkDiskCache::data(url);
+    if (!device) {
+        return false;
+    }
+    entry->metaData = diskMetaData;
+    entry->body = device->readAll();
+    delete device;
+
+    memory.insert(url, *entry, entry->body.size() + url.toString().size() * 2 + 512, generation);
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef HTTPCACHE_H
+#define HTTPCACHE_H
+
+#include <QNetworkDiskCache>
+#include <QHash>
+#include "lrucache.h"
+
+// HTTP 响应缓存：磁盘 + 内存两级
+// 磁盘层由 QNetworkDiskCache 负责，QNetworkAccessManager 据此处理 Cache-Control/max-age
+// 新鲜度判断，过期后带 If-None-Match / If-Modified-Since 发出条件请求，304 时直接使用缓存内容。
+// 内存层缓存最近读取过的条目，重复查看详情时不必再读磁盘文件。
+class HttpResponseCache : public QNetworkDiskCache
+{
+    Q_OBJECT
+
+public:
+    explicit HttpResponseCache(QObject *parent = nullptr);
+
+    QNetworkCacheMetaData metaData(const QUrl &url) override;
+    void updateMetaData(const QNetworkCacheMetaData &metaData) override;
+    QIODevice *data(const QUrl &url) override;
+    bool remove(const QUrl &url) override;
+    QIODevice *prepare(const QNetworkCacheMetaData &metaData) override;
+    void insert(QIODevice *device) override;
+
+    // 把条目标记为已过期，下次请求必定向服务器发出条件请求
+    void expire(const QUrl &url);
+
+    void setMemoryCacheSize(qint64 bytes);
+    CacheStatistics memoryStatistics() const;
+
+public slots:
+    void clear() override;
+
+private:
+    struct Entry
+    {
+        QNetworkCacheMetaData metaData;
+        QByteArray body;
+    };
+
+    LruCache<QUrl, Entry> memory;
+    QHash<QIODevice *, QUrl> pending;   // prepare() 返回的设备 -> 对应 URL
+
+    bool loadEntry(const QUrl &url, Entry *entry);
+};
+
+#endif // HTTPCACHE_H
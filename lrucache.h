@@ -0,0 +1,178 @@
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <functional>
+#include <list>
+
+// 缓存运行统计
+struct CacheStatistics
+{
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+    int entries = 0;
+    qint64 bytes = 0;
+
+    double hitRatio() const { return (hits + misses) > 0 ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+// 按估算内存占用限制大小的 LRU 缓存，内部加锁，可由多个线程共享
+// 读穿时先取 generation()，查库后带上该值 insert()：期间发生过任何失效则放弃写入，
+// 避免把失效前读到的旧值放回缓存。
+template<typename Key, typename Value>
+class LruCache
+{
+public:
+    explicit LruCache(qint64 maxBytes = 4 * 1024 * 1024)
+        : capacity(qMax<qint64>(0, maxBytes))
+        , usedBytes(0)
+        , currentGeneration(0)
+        , hitCount(0)
+        , missCount(0)
+        , evictionCount(0)
+    {
+    }
+
+    bool lookup(const Key &key, Value *value)
+    {
+        QMutexLocker locker(&mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            ++missCount;
+            return false;
+        }
+
+        ++hitCount;
+        order.splice(order.begin(), order, it->position);
+        *value = it->value;
+        return true;
+    }
+
+    quint64 generation() const
+    {
+        QMutexLocker locker(&mutex);
+        return currentGeneration;
+    }
+
+    void insert(const Key &key, const Value &value, qint64 bytes, quint64 generation)
+    {
+        QMutexLocker locker(&mutex);
+        if (generation != currentGeneration || bytes > capacity) {
+            return;
+        }
+
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            usedBytes -= it->bytes;
+            order.erase(it->position);
+            entries.erase(it);
+        }
+
+        order.push_front(key);
+        entries.insert(key, Entry{value, bytes, order.begin()});
+        usedBytes += bytes;
+        evictLocked();
+    }
+
+    void remove(const Key &key)
+    {
+        QMutexLocker locker(&mutex);
+        ++currentGeneration;
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            usedBytes -= it->bytes;
+            order.erase(it->position);
+            entries.erase(it);
+        }
+    }
+
+    // 是否有缓存项，不计入命中统计也不调整使用顺序
+    bool contains(const Key &key) const
+    {
+        QMutexLocker locker(&mutex);
+        return entries.contains(key);
+    }
+
+    // 按值失效，用于只知道主键以外字段的写操作
+    void removeIf(const std::function<bool(const Value &)> &predicate)
+    {
+        QMutexLocker locker(&mutex);
+        ++currentGeneration;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (predicate(it->value)) {
+                usedBytes -= it->bytes;
+                order.erase(it->position);
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&mutex);
+        ++currentGeneration;
+        entries.clear();
+        order.clear();
+        usedBytes = 0;
+    }
+
+    void setMaxBytes(qint64 maxBytes)
+    {
+        QMutexLocker locker(&mutex);
+        capacity = qMax<qint64>(0, maxBytes);
+        evictLocked();
+    }
+
+    qint64 maxBytes() const
+    {
+        QMutexLocker locker(&mutex);
+        return capacity;
+    }
+
+    CacheStatistics statistics() const
+    {
+        QMutexLocker locker(&mutex);
+        CacheStatistics stats;
+        stats.hits = hitCount;
+        stats.misses = missCount;
+        stats.evictions = evictionCount;
+        stats.entries = entries.size();
+        stats.bytes = usedBytes;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        Value value;
+        qint64 bytes;
+        typename std::list<Key>::iterator position;
+    };
+
+    mutable QMutex mutex;
+    std::list<Key> order;   // 最近使用的在前
+    QHash<Key, Entry> entries;
+    qint64 capacity;
+    qint64 usedBytes;
+    quint64 currentGeneration;
+    quint64 hitCount;
+    quint64 missCount;
+    quint64 evictionCount;
+
+    void evictLocked()
+    {
+        while (usedBytes > capacity && !order.empty()) {
+            auto it = entries.find(order.back());
+            usedBytes -= it->bytes;
+            entries.erase(it);
+            order.pop_back();
+            ++evictionCount;
+        }
+    }
+};
+
+#endif // LRUCACHE_H
@@ -3,6 +3,11 @@
 #include "flightbookingwidget.h"
 #include "usermanagementwidget.h"
 #include "flightdetailswidget.h"
+#include "databasehelper.h"
+#include "asyncdatabasehelper.h"
+#include "apimanager.h"
+#include "farecalendar.h"
+#include "seatmap.h"
 #include <QApplication>
 #include <QMenuBar>
 #include <QToolBar>
@@ -20,13 +25,21 @@
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QStyle>
+#include <QStandardPaths>
+#include <QDir>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , centralStack(nullptr)
     , systemTray(nullptr)
+    , databaseHelper(nullptr)
+    , asyncDatabase(nullptr)
+    , fareCalendar(nullptr)
+    , seatMapEngine(nullptr)
+    , apiManager(nullptr)
     , isDarkTheme(true)
 {
+    setupDataLayer();
     setupUI();
     setupSystemTray();
     applyTheme();
@@ -48,6 +61,29 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // 子对象按创建顺序析构，先停下工作线程和使用它的日历，再让 DatabaseHelper 关闭连接
+    delete fareCalendar;
+    fareCalendar = nullptr;
+    delete asyncDatabase;
+    asyncDatabase = nullptr;
+}
+
+void MainWindow::setupDataLayer()
+{
+    apiManager = new APIManager(this);
+    databaseHelper = new DatabaseHelper(this);
+    
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    if (databaseHelper->connectToDatabase("", QDir(dataDir).filePath("flightsystem.db"), "", "")) {
+        asyncDatabase = new AsyncDatabaseHelper(databaseHelper, this);
+        
+        // 日历由搜索页第一次查价时在工作线程上建立，启动时不扫描航班表
+        fareCalendar = new FareCalendar(databaseHelper, this);
+        fareCalendar->setAsyncDatabase(asyncDatabase);
+        
+        seatMapEngine = new SeatMapEngine(databaseHelper, this);
+    }
 }
 
 void MainWindow::setupUI()
@@ -150,6 +186,11 @@ void MainWindow::setupCentralWidget()
     userManagementWidget = new UserManagementWidget(this);
     flightDetailsWidget = new FlightDetailsWidget(this);
     
+    // 数据库打开失败时只用网络搜索
+    flightSearchWidget->setDataSources(asyncDatabase, apiManager);
+    flightSearchWidget->setFareCalendar(fareCalendar);
+    flightDetailsWidget->setSeatMapEngine(seatMapEngine);
+    
     // 添加到堆栈窗口
     centralStack->addWidget(flightSearchWidget);
     centralStack->addWidget(flightBookingWidget);
@@ -162,7 +203,7 @@ void MainWindow::setupStatusBar()
     statusBar = this->statusBar();
     
     // 状态标签
-    statusLabel = new QLabel("就绪", this);
+    statusLabel = new QLabel(asyncDatabase ? "就绪" : "就绪（本地数据库不可用）", this);
     statusBar->addWidget(statusLabel);
     
     // 用户标签
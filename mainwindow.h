@@ -22,6 +22,11 @@ class FlightSearchWidget;
 class FlightBookingWidget;
 class UserManagementWidget;
 class FlightDetailsWidget;
+class DatabaseHelper;
+class AsyncDatabaseHelper;
+class APIManager;
+class FareCalendar;
+class SeatMapEngine;
 
 class MainWindow : public QMainWindow
 {
@@ -47,6 +52,7 @@ private:
     void setupStatusBar();
     void setupCentralWidget();
     void setupSystemTray();
+    void setupDataLayer();
     void applyTheme();
     
     // UI组件
@@ -81,6 +87,13 @@ private:
     UserManagementWidget *userManagementWidget;
     FlightDetailsWidget *flightDetailsWidget;
     
+    // 数据层：本地数据库、它的异步外观、低价日历和后端 API，由各页面共用
+    DatabaseHelper *databaseHelper;
+    AsyncDatabaseHelper *asyncDatabase;
+    FareCalendar *fareCalendar;
+    SeatMapEngine *seatMapEngine;
+    APIManager *apiManager;
+    
     // 定时器
     QTimer *timeTimer;
     
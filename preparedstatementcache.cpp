@@ -0,0 +1,49 @@
+#include "preparedstatementcache.h"
+
+PreparedStatementCache::PreparedStatementCache(int capacity)
+    : maxStatements(qMax(1, capacity))
+{
+}
+
+QSqlQuery PreparedStatementCache::statement(const QSqlDatabase &database, const QString &sql, bool *hit)
+{
+    auto it = statements.constFind(sql);
+    if (it != statements.constEnd()) {
+        if (hit) *hit = true;
+        return it.value();
+    }
+
+    if (hit) *hit = false;
+
+    QSqlQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        // prepare 失败的语句不缓存，错误保留在返回的 query 中
+        return query;
+    }
+
+    // 超出容量时淘汰最早缓存的语句
+    while (statements.size() >= maxStatements && !insertionOrder.isEmpty()) {
+        statements.remove(insertionOrder.dequeue());
+    }
+
+    statements.insert(sql, query);
+    insertionOrder.enqueue(sql);
+    return query;
+}
+
+void PreparedStatementCache::clear()
+{
+    statements.clear();
+    insertionOrder.clear();
+}
+
+int PreparedStatementCache::size() const
+{
+    return statements.size();
+}
+
+int PreparedStatementCache::capacity() const
+{
+    return maxStatements;
+}
@@ -0,0 +1,31 @@
+#ifndef PREPAREDSTATEMENTCACHE_H
+#define PREPAREDSTATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QHash>
+#include <QQueue>
+
+// 单个连接上的预编译语句缓存，按 SQL 文本索引
+// 返回的 QSqlQuery 与缓存共享同一 SQLite 语句，调用方只需重新绑定参数后 exec()。
+// 缓存不加锁，只能由拥有该连接的线程使用。
+class PreparedStatementCache
+{
+public:
+    explicit PreparedStatementCache(int capacity = 128);
+
+    // 返回已 prepare 的语句；缓存未命中时在 database 上 prepare 并缓存
+    QSqlQuery statement(const QSqlDatabase &database, const QString &sql, bool *hit = nullptr);
+    void clear();
+
+    int size() const;
+    int capacity() const;
+
+private:
+    int maxStatements;
+    QHash<QString, QSqlQuery> statements;
+    QQueue<QString> insertionOrder;
+};
+
+#endif // PREPAREDSTATEMENTCACHE_H
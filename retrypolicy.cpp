@@ -0,0 +1,88 @@
+#include "retrypolicy.h"
+
+int RetryPolicy::delayFor(int retry, double random) const
+{
+    // 指数部分先封顶，避免移位溢出
+    const int exponent = qBound(0, retry - 1, 20);
+    const qint64 delay = qMin<qint64>(qint64(baseDelayMs) << exponent, maxDelayMs);
+    const double spread = qBound(0.0, jitter, 1.0) * qBound(0.0, random, 1.0);
+    return int(delay * (1.0 - spread));
+}
+
+RetryPolicy RetryPolicy::none()
+{
+    return RetryPolicy();
+}
+
+RetryPolicy RetryPolicy::standard()
+{
+    RetryPolicy policy;
+    policy.maxAttempts = 3;
+    return policy;
+}
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, qint64 openDurationMs)
+    : failureThreshold(qMax(1, failureThreshold))
+    , openDurationMs(qMax<qint64>(0, openDurationMs))
+    , currentState(State::Closed)
+    , failures(0)
+    , retryAt(0)
+{
+}
+
+void CircuitBreaker::setFailureThreshold(int threshold)
+{
+    failureThreshold = qMax(1, threshold);
+}
+
+void CircuitBreaker::setOpenDuration(qint64 ms)
+{
+    openDurationMs = qMax<qint64>(0, ms);
+}
+
+bool CircuitBreaker::allowRequest(qint64 now)
+{
+    if (currentState == State::Closed) {
+        return true;
+    }
+    if (now < retryAt) {
+        return false;
+    }
+
+    // 探测结果回来之前同一周期内不再放行，探测请求丢失时下个周期再探
+    currentState = State::HalfOpen;
+    retryAt = now + openDurationMs;
+    return true;
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    currentState = State::Closed;
+    failures = 0;
+}
+
+void CircuitBreaker::recordFailure(qint64 now)
+{
+    ++failures;
+    if (currentState == State::HalfOpen || failures >= failureThreshold) {
+        currentState = State::Open;
+        retryAt = now + openDurationMs;
+    }
+}
+
+void CircuitBreaker::reset()
+{
+    currentState = State::Closed;
+    failures = 0;
+    retryAt = 0;
+}
+
+CircuitBreaker::State CircuitBreaker::state() const
+{
+    return currentState;
+}
+
+int CircuitBreaker::consecutiveFailures() const
+{
+    return failures;
+}
@@ -0,0 +1,58 @@
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <QtGlobal>
+
+// 重试策略：第 n 次重试前等待 baseDelayMs * 2^(n-1)，不超过 maxDelayMs，
+// 再随机缩短最多 jitter 比例，避免大量客户端在同一时刻一起重试
+struct RetryPolicy
+{
+    int maxAttempts = 1;        // 含第一次发送，1 表示不重试
+    int baseDelayMs = 200;
+    int maxDelayMs = 5000;
+    double jitter = 0.5;        // 0 ~ 1
+
+    // retry 从 1 开始；random 取 [0, 1)
+    int delayFor(int retry, double random) const;
+
+    static RetryPolicy none();
+    static RetryPolicy standard();
+};
+
+// 熔断器
+// 连续失败达到阈值后打开，打开期间请求直接失败、不再访问后端；
+// 打开时长过后进入半开状态，每个打开周期只放行一个探测请求，探测成功即关闭，失败则重新打开。
+// 时间由调用方传入（毫秒，单调递增），便于测试。
+class CircuitBreaker
+{
+public:
+    enum class State
+    {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    explicit CircuitBreaker(int failureThreshold = 5, qint64 openDurationMs = 10000);
+
+    void setFailureThreshold(int threshold);
+    void setOpenDuration(qint64 ms);
+
+    // 是否允许发出请求；打开期满时转入半开并放行本次请求作为探测
+    bool allowRequest(qint64 now);
+    void recordSuccess();
+    void recordFailure(qint64 now);
+    void reset();
+
+    State state() const;
+    int consecutiveFailures() const;
+
+private:
+    int failureThreshold;
+    qint64 openDurationMs;
+    State currentState;
+    int failures;
+    qint64 retryAt;             // 打开/半开状态下允许下一次探测的时间
+};
+
+#endif // RETRYPOLICY_H
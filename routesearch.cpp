@@ -0,0 +1,293 @@
+#include "routesearch.h"
+#include "databasehelper.h"
+#include <QJsonArray>
+#include <QTime>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+
+// 候选行程只记录航段序号，排序结束后才展开为 Flight
+struct RouteSearchEngine::Candidate
+{
+    int legs[3];
+    int count;
+    int duration;
+    double price;
+};
+
+struct RouteSearchEngine::SearchState
+{
+    const RouteSearchOptions &options;
+    QVector<Candidate> best;    // 按排序键升序，最多 maxResults 条
+
+    bool before(const Candidate &a, const Candidate &b) const
+    {
+        if (options.sortBy == RouteSearchOptions::ByPrice) {
+            return a.price != b.price ? a.price < b.price : a.duration < b.duration;
+        }
+        return a.duration != b.duration ? a.duration < b.duration : a.price < b.price;
+    }
+};
+
+QJsonObject Itinerary::toJson() const
+{
+    QJsonArray legArray;
+    for (const Flight &leg : legs) {
+        legArray.append(leg.toJson());
+    }
+
+    QJsonObject json;
+    json["legs"] = legArray;
+    json["stops"] = stops();
+    json["duration_minutes"] = durationMinutes;
+    json["total_price"] = totalPrice;
+    return json;
+}
+
+RouteSearchEngine::RouteSearchEngine()
+{
+}
+
+qint64 RouteSearchEngine::minuteOf(const QString &dateTime)
+{
+    const QDate date = QDate::fromString(dateTime.left(10), "yyyy-MM-dd");
+    const QTime time = QTime::fromString(dateTime.mid(11, 5), "HH:mm");
+    if (!date.isValid() || !time.isValid()) {
+        return -1;
+    }
+    return date.toJulianDay() * 1440 + time.hour() * 60 + time.minute();
+}
+
+void RouteSearchEngine::build(const QVector<Flight> &source)
+{
+    QWriteLocker locker(&lock);
+
+    flights.clear();
+    legs.clear();
+    airportIds.clear();
+    airports.clear();
+    departures.clear();
+    departuresTo.clear();
+    inbound.clear();
+
+    flights.reserve(source.size());
+    legs.reserve(source.size());
+    for (const Flight &flight : source) {
+        if (flight.status.contains("取消")) {
+            continue;
+        }
+
+        const qint64 depart = minuteOf(flight.departureTime);
+        const qint64 arrive = minuteOf(flight.arrivalTime);
+        if (depart < 0 || arrive < depart || flight.departure == flight.destination) {
+            continue;
+        }
+
+        const int from = airportId(flight.departure);
+        const int to = airportId(flight.destination);
+        legs.append(Leg{int(flights.size()), from, to, depart, arrive});
+        flights.append(flight);
+    }
+
+    departures.resize(airports.size());
+    departuresTo.resize(airports.size());
+    inbound.fill(QBitArray(airports.size()), airports.size());
+
+    for (int i = 0; i < legs.size(); ++i) {
+        const Leg &leg = legs.at(i);
+        departures[leg.from].append(i);
+        departuresTo[leg.from][leg.to].append(i);
+        inbound[leg.to].setBit(leg.from);
+    }
+
+    const auto byDeparture = [this](int a, int b) {
+        return legs.at(a).depart < legs.at(b).depart;
+    };
+    for (int airport = 0; airport < airports.size(); ++airport) {
+        std::sort(departures[airport].begin(), departures[airport].end(), byDeparture);
+        for (QVector<int> &route : departuresTo[airport]) {
+            std::sort(route.begin(), route.end(), byDeparture);
+        }
+    }
+}
+
+bool RouteSearchEngine::rebuild(DatabaseHelper *helper)
+{
+    FlightCursor cursor = helper->openFlightCursor();
+    if (!cursor.isValid()) {
+        return false;
+    }
+
+    QVector<Flight> all;
+    while (!cursor.atEnd()) {
+        all += cursor.nextBatch();
+    }
+
+    build(all);
+    return true;
+}
+
+QVector<Itinerary> RouteSearchEngine::search(const QString &origin, const QString &destination,
+                                             const RouteSearchOptions &options) const
+{
+    QVector<Itinerary> results;
+
+    QReadLocker locker(&lock);
+    const int from = airportIds.value(origin, -1);
+    const int to = airportIds.value(destination, -1);
+    if (from < 0 || to < 0 || from == to || options.maxResults <= 0) {
+        return results;
+    }
+
+    SearchState state{options, {}};
+    const int minGap = options.minConnectionMinutes;
+    const int maxGap = options.maxConnectionMinutes;
+
+    QPair<int, int> first(0, departures.at(from).size());
+    if (options.departureDate.isValid()) {
+        const qint64 dayStart = options.departureDate.toJulianDay() * 1440;
+        first = window(departures.at(from), dayStart, dayStart + 1439);
+    }
+
+    for (int i = first.first; i < first.second; ++i) {
+        const int l1 = departures.at(from).at(i);
+        const Leg &a = legs.at(l1);
+        const double priceA = flights.at(a.flight).price(options.classType);
+
+        if (a.to == to) {
+            offer(state, &l1, 1);
+            continue;
+        }
+        if (options.maxStops < 1 || a.to == from
+            || pruned(state, int(a.arrive - a.depart), priceA)) {
+            continue;
+        }
+
+        // 一次中转：X -> 目的地
+        const auto direct = departuresTo.at(a.to).constFind(to);
+        if (direct != departuresTo.at(a.to).constEnd()) {
+            const QPair<int, int> range = window(*direct, a.arrive + minGap, a.arrive + maxGap);
+            for (int j = range.first; j < range.second; ++j) {
+                const int path[] = {l1, direct->at(j)};
+                offer(state, path, 2);
+            }
+        }
+
+        if (options.maxStops < 2) {
+            continue;
+        }
+
+        // 两次中转：X -> Y 只保留能直飞目的地的 Y
+        const QVector<int> &onward = departures.at(a.to);
+        const QPair<int, int> range = window(onward, a.arrive + minGap, a.arrive + maxGap);
+        for (int j = range.first; j < range.second; ++j) {
+            const int l2 = onward.at(j);
+            const Leg &b = legs.at(l2);
+            if (b.to == from || b.to == to || !inbound.at(to).testBit(b.to)) {
+                continue;
+            }
+
+            const double priceB = priceA + flights.at(b.flight).price(options.classType);
+            if (pruned(state, int(b.arrive - a.depart), priceB)) {
+                continue;
+            }
+
+            const QVector<int> &last = departuresTo.at(b.to).value(to);
+            const QPair<int, int> lastRange = window(last, b.arrive + minGap, b.arrive + maxGap);
+            for (int k = lastRange.first; k < lastRange.second; ++k) {
+                const int path[] = {l1, l2, last.at(k)};
+                offer(state, path, 3);
+            }
+        }
+    }
+
+    results.reserve(state.best.size());
+    for (const Candidate &candidate : std::as_const(state.best)) {
+        Itinerary itinerary;
+        for (int i = 0; i < candidate.count; ++i) {
+            itinerary.legs.append(flights.at(legs.at(candidate.legs[i]).flight));
+        }
+        itinerary.durationMinutes = candidate.duration;
+        itinerary.totalPrice = candidate.price;
+        results.append(itinerary);
+    }
+    return results;
+}
+
+int RouteSearchEngine::airportCount() const
+{
+    QReadLocker locker(&lock);
+    return airports.size();
+}
+
+int RouteSearchEngine::flightCount() const
+{
+    QReadLocker locker(&lock);
+    return legs.size();
+}
+
+int RouteSearchEngine::airportId(const QString &name)
+{
+    auto it = airportIds.constFind(name);
+    if (it != airportIds.constEnd()) {
+        return it.value();
+    }
+
+    const int id = airports.size();
+    airportIds.insert(name, id);
+    airports.append(name);
+    return id;
+}
+
+QPair<int, int> RouteSearchEngine::window(const QVector<int> &sortedLegs, qint64 from, qint64 to) const
+{
+    const auto begin = std::lower_bound(sortedLegs.cbegin(), sortedLegs.cend(), from,
+                                        [this](int leg, qint64 minute) {
+                                            return legs.at(leg).depart < minute;
+                                        });
+    const auto end = std::upper_bound(begin, sortedLegs.cend(), to,
+                                      [this](qint64 minute, int leg) {
+                                          return minute < legs.at(leg).depart;
+                                      });
+    return qMakePair(int(begin - sortedLegs.cbegin()), int(end - sortedLegs.cbegin()));
+}
+
+void RouteSearchEngine::offer(SearchState &state, const int *path, int count) const
+{
+    Candidate candidate;
+    candidate.count = count;
+    candidate.price = 0.0;
+    for (int i = 0; i < count; ++i) {
+        candidate.legs[i] = path[i];
+        candidate.price += flights.at(legs.at(path[i]).flight).price(state.options.classType);
+    }
+    candidate.duration = int(legs.at(path[count - 1]).arrive - legs.at(path[0]).depart);
+
+    QVector<Candidate> &best = state.best;
+    if (best.size() >= state.options.maxResults && !state.before(candidate, best.last())) {
+        return;
+    }
+
+    const auto position = std::upper_bound(best.begin(), best.end(), candidate,
+                                           [&state](const Candidate &a, const Candidate &b) {
+                                               return state.before(a, b);
+                                           });
+    best.insert(position, candidate);
+    if (best.size() > state.options.maxResults) {
+        best.removeLast();
+    }
+}
+
+bool RouteSearchEngine::pruned(const SearchState &state, int duration, double price) const
+{
+    // 后续航段只会增加时间和票价，已不优于当前第 maxResults 名的部分行程可以丢弃
+    if (state.best.size() < state.options.maxResults) {
+        return false;
+    }
+
+    const Candidate &worst = state.best.last();
+    if (state.options.sortBy == RouteSearchOptions::ByPrice) {
+        return price > worst.price;
+    }
+    return duration > worst.duration;
+}
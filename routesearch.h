@@ -0,0 +1,93 @@
+#ifndef ROUTESEARCH_H
+#define ROUTESEARCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QDate>
+#include <QVector>
+#include <QHash>
+#include <QBitArray>
+#include <QJsonObject>
+#include <QReadWriteLock>
+#include "datamodels.h"
+
+class DatabaseHelper;
+
+// 中转搜索条件
+struct RouteSearchOptions
+{
+    enum SortOrder {
+        ByDuration,     // 总行程时间（首段起飞到末段到达）
+        ByPrice         // 指定舱位的总票价
+    };
+
+    int minConnectionMinutes = 45;
+    int maxConnectionMinutes = 360;
+    int maxStops = 2;
+    int maxResults = 20;
+    SortOrder sortBy = ByDuration;
+    QString classType = "经济舱";
+    QDate departureDate;    // 首段起飞日期，为空时不限
+};
+
+// 一条由 1 至 3 个航段组成的行程
+struct Itinerary
+{
+    QVector<Flight> legs;
+    int durationMinutes = 0;
+    double totalPrice = 0.0;
+
+    int stops() const { return legs.size() - 1; }
+    QJsonObject toJson() const;
+};
+
+// 基于航班表的时间展开航线图
+// 每个机场的出发航段按起飞时间排序，并按目的地再分组；衔接航段用二分查找在
+// [到达 + 最短衔接, 到达 + 最长衔接] 窗口内定位。两次中转时第二段只考虑能直飞目的地的机场，
+// 并在已满 maxResults 条时按当前最差结果剪枝。build() 之后 search() 可并发调用。
+class RouteSearchEngine
+{
+public:
+    RouteSearchEngine();
+
+    void build(const QVector<Flight> &flights);
+    // 通过只进游标读取全部航班后重建
+    bool rebuild(DatabaseHelper *helper);
+
+    QVector<Itinerary> search(const QString &origin, const QString &destination,
+                              const RouteSearchOptions &options = RouteSearchOptions()) const;
+
+    int airportCount() const;
+    int flightCount() const;
+
+    // "yyyy-MM-dd HH:mm[:ss]" 转为分钟序号，无法解析时返回 -1
+    static qint64 minuteOf(const QString &dateTime);
+
+private:
+    struct Leg {
+        int flight;
+        int from;
+        int to;
+        qint64 depart;
+        qint64 arrive;
+    };
+
+    struct Candidate;
+    struct SearchState;
+
+    mutable QReadWriteLock lock;
+    QVector<Flight> flights;
+    QVector<Leg> legs;
+    QHash<QString, int> airportIds;
+    QStringList airports;
+    QVector<QVector<int>> departures;               // 机场 -> 按起飞时间排序的航段
+    QVector<QHash<int, QVector<int>>> departuresTo; // 机场 -> 目的地 -> 按起飞时间排序的航段
+    QVector<QBitArray> inbound;                     // 机场 -> 有直飞航班到达该机场的出发机场
+
+    int airportId(const QString &name);
+    QPair<int, int> window(const QVector<int> &sortedLegs, qint64 from, qint64 to) const;
+    void offer(SearchState &state, const int *path, int count) const;
+    bool pruned(const SearchState &state, int duration, double price) const;
+};
+
+#endif // ROUTESEARCH_H
@@ -0,0 +1,405 @@
+#include "seatmap.h"
+#include "databasehelper.h"
+#include <QtAlgorithms>
+#include <QMutexLocker>
+
+AircraftLayout AircraftLayout::forAircraft(const QString &aircraft)
+{
+    static const QStringList widebodies = {"747", "777", "787", "A330", "A340", "A350", "A380"};
+
+    AircraftLayout layout;
+    layout.aircraft = aircraft;
+
+    bool widebody = false;
+    for (const QString &model : widebodies) {
+        if (aircraft.contains(model, Qt::CaseInsensitive)) {
+            widebody = true;
+            break;
+        }
+    }
+
+    if (widebody) {
+        // 约 400 座：头等舱 1-2-1，商务舱 2-2-2，经济舱 3-4-3
+        layout.cabins = {
+            {"头等舱", 1, 2, "A DG K"},
+            {"商务舱", 3, 6, "AC DG HK"},
+            {"经济舱", 10, 36, "ABC DEFG HJK"}
+        };
+    } else {
+        // 窄体机：商务舱 2-2，经济舱 3-3
+        layout.cabins = {
+            {"商务舱", 1, 3, "AC DF"},
+            {"经济舱", 4, 29, "ABC DEF"}
+        };
+    }
+
+    return layout;
+}
+
+SeatMap::SeatMap()
+    : seatCount(0)
+    , freeSeats(0)
+{
+}
+
+SeatMap::SeatMap(const CabinLayout &layout)
+    : layout(layout)
+    , seatCount(0)
+    , freeSeats(0)
+{
+    // 每排至少留一位填充，连续空座才不会跨到下一排
+    if (layout.rowCount <= 0 || layout.seatLetters.size() >= LaneBits) {
+        return;
+    }
+
+    for (int i = 0; i < layout.seatLetters.size(); ++i) {
+        const QChar letter = layout.seatLetters.at(i);
+        if (letter != ' ' && !letterPositions.contains(letter)) {
+            letterPositions.insert(letter, i);
+        }
+    }
+
+    const int words = (layout.rowCount + LanesPerWord - 1) / LanesPerWord;
+    occupied.fill(~quint64(0), words);
+    held.fill(0, words);
+    assigned.fill(0, words);
+
+    for (int row = 0; row < layout.rowCount; ++row) {
+        for (int position : std::as_const(letterPositions)) {
+            setBit(occupied, row * LaneBits + position, false);
+        }
+    }
+
+    seatCount = layout.rowCount * letterPositions.size();
+    freeSeats = seatCount;
+}
+
+bool SeatMap::isValid() const
+{
+    return seatCount > 0;
+}
+
+QString SeatMap::classType() const
+{
+    return layout.classType;
+}
+
+int SeatMap::capacity() const
+{
+    return seatCount;
+}
+
+int SeatMap::freeCount() const
+{
+    return freeSeats;
+}
+
+bool SeatMap::contains(const QString &seat) const
+{
+    return seatBit(seat) >= 0;
+}
+
+bool SeatMap::isFree(const QString &seat) const
+{
+    const int bit = seatBit(seat);
+    return bit >= 0 && !testBit(occupied, bit);
+}
+
+bool SeatMap::isAssigned(const QString &seat) const
+{
+    const int bit = seatBit(seat);
+    return bit >= 0 && testBit(assigned, bit);
+}
+
+bool SeatMap::hold(const QString &seat)
+{
+    const int bit = seatBit(seat);
+    if (bit < 0 || testBit(occupied, bit)) {
+        return false;
+    }
+
+    setBit(occupied, bit, true);
+    setBit(held, bit, true);
+    --freeSeats;
+    return true;
+}
+
+bool SeatMap::release(const QString &seat)
+{
+    const int bit = seatBit(seat);
+    if (bit < 0 || !(testBit(held, bit) || testBit(assigned, bit))) {
+        return false;
+    }
+
+    setBit(occupied, bit, false);
+    setBit(held, bit, false);
+    setBit(assigned, bit, false);
+    ++freeSeats;
+    return true;
+}
+
+bool SeatMap::assign(const QString &seat)
+{
+    const int bit = seatBit(seat);
+    if (bit < 0 || testBit(assigned, bit)) {
+        return false;
+    }
+
+    if (!testBit(occupied, bit)) {
+        --freeSeats;
+    }
+    setBit(occupied, bit, true);
+    setBit(held, bit, false);
+    setBit(assigned, bit, true);
+    return true;
+}
+
+QStringList SeatMap::findAdjacent(int count) const
+{
+    QStringList seats;
+    if (count < 1 || count > layout.seatLetters.size() || count > freeSeats) {
+        return seats;
+    }
+
+    // runs 中第 i 位为 1 表示从第 i 位起连续 count 位都是空座
+    for (int word = 0; word < occupied.size(); ++word) {
+        const quint64 free = ~occupied.at(word);
+        quint64 runs = free;
+        for (int i = 1; i < count && runs; ++i) {
+            runs &= free >> i;
+        }
+
+        if (runs) {
+            const int first = word * 64 + qCountTrailingZeroBits(runs);
+            for (int i = 0; i < count; ++i) {
+                seats.append(seatLabel(first + i));
+            }
+            return seats;
+        }
+    }
+
+    return seats;
+}
+
+QStringList SeatMap::assignedSeats() const
+{
+    QStringList seats;
+    for (int word = 0; word < assigned.size(); ++word) {
+        quint64 bits = assigned.at(word);
+        while (bits) {
+            seats.append(seatLabel(word * 64 + qCountTrailingZeroBits(bits)));
+            bits &= bits - 1;
+        }
+    }
+    return seats;
+}
+
+int SeatMap::seatBit(const QString &seat) const
+{
+    if (seat.size() < 2 || !isValid()) {
+        return -1;
+    }
+
+    const int position = letterPositions.value(seat.at(seat.size() - 1).toUpper(), -1);
+    bool ok = false;
+    const int row = seat.left(seat.size() - 1).toInt(&ok) - layout.firstRow;
+    if (position < 0 || !ok || row < 0 || row >= layout.rowCount) {
+        return -1;
+    }
+
+    return row * LaneBits + position;
+}
+
+QString SeatMap::seatLabel(int bit) const
+{
+    return QString::number(layout.firstRow + bit / LaneBits) + layout.seatLetters.at(bit % LaneBits);
+}
+
+bool SeatMap::testBit(const QVector<quint64> &words, int bit)
+{
+    return (words.at(bit / 64) >> (bit % 64)) & 1;
+}
+
+void SeatMap::setBit(QVector<quint64> &words, int bit, bool value)
+{
+    const quint64 mask = quint64(1) << (bit % 64);
+    if (value) {
+        words[bit / 64] |= mask;
+    } else {
+        words[bit / 64] &= ~mask;
+    }
+}
+
+SeatMapEngine::SeatMapEngine(DatabaseHelper *helper, QObject *parent)
+    : QObject(parent)
+    , databaseHelper(helper)
+{
+}
+
+bool SeatMapEngine::loadFlight(const QString &flightNumber)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (flights.contains(flightNumber)) {
+            return true;
+        }
+    }
+
+    // 建图在锁外进行，只有首次访问航班时查询数据库
+    const Flight flight = databaseHelper->findFlight(flightNumber);
+    if (!flight.isValid()) {
+        return false;
+    }
+
+    QHash<QString, SeatMap> cabins;
+    for (const CabinLayout &cabin : AircraftLayout::forAircraft(flight.aircraft).cabins) {
+        SeatMap map(cabin);
+        for (const QString &seat : databaseHelper->queryAssignedSeats(flightNumber, cabin.classType)) {
+            map.assign(seat);
+        }
+        cabins.insert(cabin.classType, map);
+    }
+
+    QMutexLocker locker(&mutex);
+    if (!flights.contains(flightNumber)) {
+        flights.insert(flightNumber, cabins);
+    }
+    return true;
+}
+
+void SeatMapEngine::unloadFlight(const QString &flightNumber)
+{
+    QMutexLocker locker(&mutex);
+    flights.remove(flightNumber);
+}
+
+bool SeatMapEngine::hold(const QString &flightNumber, const QString &classType, const QString &seat)
+{
+    if (!loadFlight(flightNumber)) return false;
+
+    {
+        QMutexLocker locker(&mutex);
+        SeatMap *map = findMapLocked(flightNumber, classType);
+        if (!map || !map->hold(seat)) {
+            return false;
+        }
+    }
+
+    emit seatChanged(flightNumber, classType, seat);
+    return true;
+}
+
+bool SeatMapEngine::release(const QString &flightNumber, const QString &classType, const QString &seat)
+{
+    if (!loadFlight(flightNumber)) return false;
+
+    {
+        QMutexLocker locker(&mutex);
+        SeatMap *map = findMapLocked(flightNumber, classType);
+        if (!map || !map->release(seat)) {
+            return false;
+        }
+    }
+
+    emit seatChanged(flightNumber, classType, seat);
+    return true;
+}
+
+QStringList SeatMapEngine::findAdjacentSeats(const QString &flightNumber, const QString &classType, int count)
+{
+    if (!loadFlight(flightNumber)) return QStringList();
+
+    QMutexLocker locker(&mutex);
+    SeatMap *map = findMapLocked(flightNumber, classType);
+    return map ? map->findAdjacent(count) : QStringList();
+}
+
+QStringList SeatMapEngine::holdAdjacentSeats(const QString &flightNumber, const QString &classType, int count)
+{
+    if (!loadFlight(flightNumber)) return QStringList();
+
+    QStringList seats;
+    {
+        QMutexLocker locker(&mutex);
+        SeatMap *map = findMapLocked(flightNumber, classType);
+        if (!map) {
+            return seats;
+        }
+
+        seats = map->findAdjacent(count);
+        for (const QString &seat : std::as_const(seats)) {
+            map->hold(seat);
+        }
+    }
+
+    for (const QString &seat : std::as_const(seats)) {
+        emit seatChanged(flightNumber, classType, seat);
+    }
+    return seats;
+}
+
+bool SeatMapEngine::persistSeat(qint64 passengerId, const QString &flightNumber, const QString &classType,
+                                const QString &seat)
+{
+    if (!loadFlight(flightNumber)) return false;
+
+    bool wasHeld = false;
+    {
+        QMutexLocker locker(&mutex);
+        SeatMap *map = findMapLocked(flightNumber, classType);
+        if (!map || !map->contains(seat) || map->isAssigned(seat)) {
+            return false;
+        }
+        wasHeld = !map->isFree(seat);
+        map->assign(seat);
+    }
+
+    QString previousSeat;
+    if (!databaseHelper->updatePassengerSeat(passengerId, flightNumber, classType, seat, &previousSeat)) {
+        QMutexLocker locker(&mutex);
+        SeatMap *map = findMapLocked(flightNumber, classType);
+        if (map) {
+            map->release(seat);
+            if (wasHeld) {
+                map->hold(seat);
+            }
+        }
+        return false;
+    }
+
+    // 换座时释放原座位
+    const bool moved = !previousSeat.isEmpty() && previousSeat != seat;
+    if (moved) {
+        QMutexLocker locker(&mutex);
+        SeatMap *map = findMapLocked(flightNumber, classType);
+        if (map) {
+            map->release(previousSeat);
+        }
+    }
+
+    emit seatChanged(flightNumber, classType, seat);
+    if (moved) {
+        emit seatChanged(flightNumber, classType, previousSeat);
+    }
+    return true;
+}
+
+SeatMap SeatMapEngine::seatMap(const QString &flightNumber, const QString &classType)
+{
+    if (!loadFlight(flightNumber)) return SeatMap();
+
+    QMutexLocker locker(&mutex);
+    SeatMap *map = findMapLocked(flightNumber, classType);
+    return map ? *map : SeatMap();
+}
+
+SeatMap *SeatMapEngine::findMapLocked(const QString &flightNumber, const QString &classType)
+{
+    auto flight = flights.find(flightNumber);
+    if (flight == flights.end()) {
+        return nullptr;
+    }
+
+    auto cabin = flight->find(classType);
+    return cabin == flight->end() ? nullptr : &cabin.value();
+}
@@ -0,0 +1,116 @@
+#ifndef SEATMAP_H
+#define SEATMAP_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+class DatabaseHelper;
+
+// 一个舱位的座位布局：连续的排号和每排座位字母，字母间的空格表示过道
+// 例如宽体机经济舱 "ABC DEFG HJK"
+struct CabinLayout
+{
+    QString classType;
+    int firstRow = 1;
+    int rowCount = 0;
+    QString seatLetters;
+};
+
+// 机型布局，按 flights.aircraft 识别
+struct AircraftLayout
+{
+    QString aircraft;
+    QVector<CabinLayout> cabins;
+
+    static AircraftLayout forAircraft(const QString &aircraft);
+};
+
+// 单个航班单个舱位的座位位图
+// 每排占一个 16 位通道（每个 64 位字容纳 4 排），过道和通道尾部的填充位恒为占用，
+// 因此按位查找连续空座时不会跨越过道或排。占座、释放、分配都只改动一个字中的一位。
+class SeatMap
+{
+public:
+    SeatMap();
+    explicit SeatMap(const CabinLayout &layout);
+
+    bool isValid() const;
+    QString classType() const;
+    int capacity() const;
+    int freeCount() const;
+
+    bool contains(const QString &seat) const;
+    bool isFree(const QString &seat) const;
+    bool isAssigned(const QString &seat) const;
+
+    // 空座 -> 保留
+    bool hold(const QString &seat);
+    // 保留或已分配 -> 空座
+    bool release(const QString &seat);
+    // 空座或保留 -> 已分配
+    bool assign(const QString &seat);
+
+    // 同一排、不跨过道的 count 个连续空座，按排号从前往后取第一组；没有时返回空列表
+    QStringList findAdjacent(int count) const;
+    QStringList assignedSeats() const;
+
+private:
+    static const int LaneBits = 16;
+    static const int LanesPerWord = 64 / LaneBits;
+
+    CabinLayout layout;
+    QHash<QChar, int> letterPositions;
+    QVector<quint64> occupied;   // 保留、已分配、过道和填充位
+    QVector<quint64> held;
+    QVector<quint64> assigned;
+    int seatCount;
+    int freeSeats;
+
+    int seatBit(const QString &seat) const;
+    QString seatLabel(int bit) const;
+    static bool testBit(const QVector<quint64> &words, int bit);
+    static void setBit(QVector<quint64> &words, int bit, bool value);
+};
+
+// 按航班和舱位管理座位图
+// 航班首次访问时按机型建图并从 passengers 载入已分配座位，此后的选座操作只在内存中进行；
+// 确认分配时通过 persistSeat 写回 passengers.seat_number。
+class SeatMapEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SeatMapEngine(DatabaseHelper *helper, QObject *parent = nullptr);
+
+    bool loadFlight(const QString &flightNumber);
+    void unloadFlight(const QString &flightNumber);
+
+    bool hold(const QString &flightNumber, const QString &classType, const QString &seat);
+    bool release(const QString &flightNumber, const QString &classType, const QString &seat);
+    QStringList findAdjacentSeats(const QString &flightNumber, const QString &classType, int count);
+    // 查找并保留 count 个连续空座，查找与保留之间不会被其他线程抢占
+    QStringList holdAdjacentSeats(const QString &flightNumber, const QString &classType, int count);
+
+    // 分配座位并写回乘客记录，换座时释放原座位；
+    // 乘客不属于该航班该舱位的有效预订或写库失败时恢复原状态
+    bool persistSeat(qint64 passengerId, const QString &flightNumber, const QString &classType,
+                     const QString &seat);
+
+    SeatMap seatMap(const QString &flightNumber, const QString &classType);
+
+signals:
+    void seatChanged(const QString &flightNumber, const QString &classType, const QString &seat);
+
+private:
+    DatabaseHelper *databaseHelper;
+    mutable QMutex mutex;
+    QHash<QString, QHash<QString, SeatMap>> flights;
+
+    SeatMap *findMapLocked(const QString &flightNumber, const QString &classType);
+};
+
+#endif // SEATMAP_H
@@ -0,0 +1,203 @@
+#include "tablefilter.h"
+#include <QStringMatcher>
+#include <algorithm>
+
+namespace {
+
+// 行分隔符，用户输入中不会出现，匹配不会跨行
+const QChar ROW_SEPARATOR(0x1f);
+
+}
+
+FilterColumnIndex::FilterColumnIndex(const QStringList &rows)
+{
+    qsizetype length = 0;
+    for (const QString &row : rows) {
+        length += row.size() + 1;
+    }
+
+    folded.reserve(length);
+    offsets.reserve(rows.size() + 1);
+    for (const QString &row : rows) {
+        offsets.append(int(folded.size()));
+        folded += row.toCaseFolded();
+        folded += ROW_SEPARATOR;
+    }
+    offsets.append(int(folded.size()));
+}
+
+QVector<int> FilterColumnIndex::match(const QString &text) const
+{
+    QVector<int> rows;
+    const QString needle = text.toCaseFolded();
+    if (needle.isEmpty()) {
+        return rows;
+    }
+
+    const QStringMatcher matcher(needle, Qt::CaseSensitive);
+    qsizetype position = matcher.indexIn(folded, 0);
+    while (position >= 0) {
+        // 命中位置所在的行，随后从下一行起点继续
+        const auto next = std::upper_bound(offsets.cbegin(), offsets.cend(), int(position));
+        const int row = int(next - offsets.cbegin()) - 1;
+        rows.append(row);
+        position = matcher.indexIn(folded, *next);
+    }
+    return rows;
+}
+
+int FilterColumnIndex::rowCount() const
+{
+    return int(offsets.size()) - 1;
+}
+
+RowFilterProxyModel::RowFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , filtering(false)
+{
+}
+
+void RowFilterProxyModel::setAcceptedRows(const QVector<int> &rows, int sourceRowCount)
+{
+    accepted = QBitArray(sourceRowCount);
+    for (int row : rows) {
+        if (row < sourceRowCount) {
+            accepted.setBit(row);
+        }
+    }
+    filtering = true;
+    invalidateFilter();
+}
+
+void RowFilterProxyModel::clearRowFilter()
+{
+    if (!filtering) {
+        return;
+    }
+    accepted.clear();
+    filtering = false;
+    invalidateFilter();
+}
+
+bool RowFilterProxyModel::isFiltering() const
+{
+    return filtering;
+}
+
+bool RowFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_UNUSED(sourceParent);
+    // 索引之后新增的行在下一次过滤前保持可见
+    return !filtering || sourceRow >= accepted.size() || accepted.testBit(sourceRow);
+}
+
+TableFilterEngine::TableFilterEngine(QAbstractItemModel *source, QObject *parent)
+    : QObject(parent)
+    , sourceModel(source)
+    , proxy(new RowFilterProxyModel(this))
+    , generation(0)
+    , sourceVersion(0)
+    , activeColumn(-1)
+{
+    // 单个工作线程，过滤请求按顺序执行，被新请求取代的直接跳过
+    pool.setMaxThreadCount(1);
+    proxy->setSourceModel(sourceModel);
+
+    connect(sourceModel, &QAbstractItemModel::modelReset, this, &TableFilterEngine::sourceChanged);
+    connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &TableFilterEngine::sourceChanged);
+    connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &TableFilterEngine::sourceChanged);
+    connect(sourceModel, &QAbstractItemModel::dataChanged, this, &TableFilterEngine::sourceChanged);
+}
+
+TableFilterEngine::~TableFilterEngine()
+{
+    ++generation;
+    pool.clear();
+    pool.waitForDone();
+}
+
+RowFilterProxyModel *TableFilterEngine::proxyModel() const
+{
+    return proxy;
+}
+
+void TableFilterEngine::filter(int column, const QString &text)
+{
+    const quint64 ticket = ++generation;
+    if (text.isEmpty() || column < 0 || column >= sourceModel->columnCount()) {
+        activeColumn = -1;
+        activeText.clear();
+        proxy->clearRowFilter();
+        emit filtered(sourceModel->rowCount());
+        return;
+    }
+
+    activeColumn = column;
+    activeText = text;
+
+    // 模型只能在 GUI 线程读取，索引缺失时在这里抓取该列文本
+    std::shared_ptr<const FilterColumnIndex> index = indexes.value(column);
+    QStringList snapshot;
+    if (!index) {
+        snapshot = columnText(column);
+    }
+    const quint64 version = sourceVersion;
+    const int rowCount = sourceModel->rowCount();
+
+    pool.start([this, ticket, version, column, text, index, snapshot, rowCount]() {
+        if (generation.load() != ticket) {
+            return;
+        }
+
+        std::shared_ptr<const FilterColumnIndex> built = index;
+        if (!built) {
+            built = std::make_shared<const FilterColumnIndex>(snapshot);
+        }
+        const QVector<int> rows = built->match(text);
+
+        QMetaObject::invokeMethod(this, [this, ticket, version, column, built, rows, rowCount]() {
+            if (version == sourceVersion) {
+                indexes.insert(column, built);
+            }
+            if (generation.load() != ticket) {
+                return;
+            }
+            proxy->setAcceptedRows(rows, rowCount);
+            emit filtered(int(rows.size()));
+        }, Qt::QueuedConnection);
+    });
+}
+
+void TableFilterEngine::clear()
+{
+    filter(-1, QString());
+}
+
+int TableFilterEngine::sourceRow(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid()) {
+        return -1;
+    }
+    return proxy->mapToSource(proxyIndex).row();
+}
+
+void TableFilterEngine::sourceChanged()
+{
+    // 数据变化后索引作废，正在生效的过滤条件按新数据重新执行
+    ++sourceVersion;
+    indexes.clear();
+    if (activeColumn >= 0) {
+        filter(activeColumn, activeText);
+    }
+}
+
+QStringList TableFilterEngine::columnText(int column) const
+{
+    const int rows = sourceModel->rowCount();
+    QStringList texts;
+    texts.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        texts.append(sourceModel->index(row, column).data().toString());
+    }
+    return texts;
+}
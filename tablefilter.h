@@ -0,0 +1,90 @@
+#ifndef TABLEFILTER_H
+#define TABLEFILTER_H
+
+#include <QObject>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QBitArray>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+// 单列过滤索引
+// 所有行的文本预先折叠大小写，以 \x1f 分隔拼接成一个连续缓冲区并记录每行起点。
+// 查找时用 QStringMatcher 在整个缓冲区上扫描，命中后按起点二分定位行号并跳到下一行，
+// 不再逐行构造和折叠字符串。
+class FilterColumnIndex
+{
+public:
+    explicit FilterColumnIndex(const QStringList &rows);
+
+    // 包含 text（不区分大小写）的行号，升序
+    QVector<int> match(const QString &text) const;
+    int rowCount() const;
+
+private:
+    QString folded;
+    QVector<int> offsets;       // 第 i 行在 folded 中的起点，末尾多一个哨兵
+};
+
+// 按行号集合过滤的代理模型，匹配结果整批设置，只触发一次重新过滤
+class RowFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit RowFilterProxyModel(QObject *parent = nullptr);
+
+    void setAcceptedRows(const QVector<int> &rows, int sourceRowCount);
+    void clearRowFilter();
+    bool isFiltering() const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QBitArray accepted;
+    bool filtering;
+};
+
+// 表格过滤引擎
+// GUI 线程只负责抓取被搜索列的文本（每列在数据变化后抓取一次），
+// 折叠、建索引和匹配都在引擎自己的工作线程上完成，结果回到 GUI 线程一次性交给代理模型。
+// 连续输入时只有最新一次过滤的结果会被应用，排队中的旧请求直接跳过。
+class TableFilterEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TableFilterEngine(QAbstractItemModel *source, QObject *parent = nullptr);
+    ~TableFilterEngine();
+
+    RowFilterProxyModel *proxyModel() const;
+
+    // 在 column 列中查找 text，text 为空时显示全部行
+    void filter(int column, const QString &text);
+    void clear();
+
+    // 代理模型行号转换为源模型行号，无效时返回 -1
+    int sourceRow(const QModelIndex &proxyIndex) const;
+
+signals:
+    void filtered(int matchCount);
+
+private:
+    QAbstractItemModel *sourceModel;
+    RowFilterProxyModel *proxy;
+    QThreadPool pool;
+    std::atomic<quint64> generation;
+    quint64 sourceVersion;
+    QHash<int, std::shared_ptr<const FilterColumnIndex>> indexes;
+    int activeColumn;
+    QString activeText;
+
+    void sourceChanged();
+    QStringList columnText(int column) const;
+};
+
+#endif // TABLEFILTER_H
@@ -0,0 +1,198 @@
+#include "tablemodels.h"
+#include "databasehelper.h"
+#include <memory>
+
+FlightTableModel::FlightTableModel(QObject *parent)
+    : RecordTableModel<Flight>(parent)
+{
+    setColumns({FlightNumber, Airline, Departure, Destination, DepartureTime, ArrivalTime, Price, Status});
+}
+
+void FlightTableModel::setDatabase(DatabaseHelper *helper, const QString &departure,
+                                   const QString &destination, int pageSize)
+{
+    auto next = std::make_shared<PageKey>();
+    setBatchSource([helper, departure, destination, pageSize, next](bool *last) {
+        const Page<Flight> page = helper->queryFlightPage(departure, destination, *next, pageSize);
+        *next = page.next;
+        *last = !page.hasMore;
+        return page.items;
+    });
+}
+
+void FlightTableModel::setCursor(const FlightCursor &cursor)
+{
+    // 读到末尾时游标自行关闭，模型重置时随数据源一起析构
+    auto shared = std::make_shared<FlightCursor>(cursor);
+    setBatchSource([shared](bool *last) {
+        const QVector<Flight> batch = shared->nextBatch();
+        *last = shared->atEnd();
+        return batch;
+    });
+}
+
+QString FlightTableModel::columnTitle(int column) const
+{
+    switch (column) {
+    case FlightNumber: return "航班号";
+    case Airline: return "航空公司";
+    case Departure: return "出发地";
+    case Destination: return "目的地";
+    case DepartureTime: return "出发时间";
+    case ArrivalTime: return "到达时间";
+    case Price: return "价格";
+    case Status: return "状态";
+    case Gate: return "登机口";
+    case Aircraft: return "机型";
+    }
+    return QString();
+}
+
+QString FlightTableModel::cellText(const Flight &flight, int column) const
+{
+    switch (column) {
+    case FlightNumber: return flight.flightNumber;
+    case Airline: return flight.airline;
+    case Departure: return flight.departure;
+    case Destination: return flight.destination;
+    case DepartureTime: return flight.departureTime;
+    case ArrivalTime: return flight.arrivalTime;
+    case Price: return flight.economyPrice > 0 ? QString("¥%L1").arg(flight.economyPrice, 0, 'f', 0) : QString("-");
+    case Status: return flight.status;
+    case Gate: return flight.gate;
+    case Aircraft: return flight.aircraft;
+    }
+    return QString();
+}
+
+QVariant FlightTableModel::cellColor(const Flight &flight, int column) const
+{
+    if (column != Status) {
+        return QVariant();
+    }
+
+    // 根据状态设置颜色
+    if (flight.status == "延误") {
+        return QColor(255, 100, 100);
+    } else if (flight.status == "取消") {
+        return QColor(255, 0, 0);
+    }
+    return QColor(100, 255, 100);
+}
+
+UserTableModel::UserTableModel(QObject *parent)
+    : RecordTableModel<User>(parent)
+{
+    setColumns({Id, Username, Name, Email, Phone, Role, Status, CreatedAt});
+}
+
+void UserTableModel::setDatabase(DatabaseHelper *helper, int pageSize)
+{
+    auto next = std::make_shared<PageKey>();
+    setBatchSource([helper, pageSize, next](bool *last) {
+        const Page<User> page = helper->queryUserPage(*next, pageSize);
+        *next = page.next;
+        *last = !page.hasMore;
+        return page.items;
+    });
+}
+
+QString UserTableModel::columnTitle(int column) const
+{
+    switch (column) {
+    case Id: return "用户ID";
+    case Username: return "用户名";
+    case Name: return "姓名";
+    case Email: return "邮箱";
+    case Phone: return "电话";
+    case Role: return "角色";
+    case Status: return "状态";
+    case CreatedAt: return "注册时间";
+    }
+    return QString();
+}
+
+QString UserTableModel::cellText(const User &user, int column) const
+{
+    switch (column) {
+    case Id: return QString::number(user.id);
+    case Username: return user.username;
+    case Name: return (user.firstName + " " + user.lastName).trimmed();
+    case Email: return user.email;
+    case Phone: return user.phone;
+    case Role: return user.role;
+    case Status: return user.status;
+    case CreatedAt: return user.createdAt;
+    }
+    return QString();
+}
+
+QVariant UserTableModel::cellColor(const User &user, int column) const
+{
+    if (column != Status) {
+        return QVariant();
+    }
+
+    // 根据状态设置颜色
+    if (user.status == "活跃") {
+        return QColor(0, 128, 0);
+    } else if (user.status == "暂停") {
+        return QColor(255, 165, 0);
+    } else if (user.status == "禁用") {
+        return QColor(255, 0, 0);
+    }
+    return QVariant();
+}
+
+BookingTableModel::BookingTableModel(QObject *parent)
+    : RecordTableModel<Booking>(parent)
+{
+    setColumns({Id, FlightNumber, BookingDate, PassengerCount, TotalPrice, Status, CreatedAt});
+}
+
+void BookingTableModel::setDatabase(DatabaseHelper *helper, const QString &userId, int pageSize)
+{
+    auto next = std::make_shared<PageKey>();
+    setBatchSource([helper, userId, pageSize, next](bool *last) {
+        const Page<Booking> page = helper->queryBookingPage(userId, *next, pageSize);
+        *next = page.next;
+        *last = !page.hasMore;
+        return page.items;
+    });
+}
+
+QString BookingTableModel::columnTitle(int column) const
+{
+    switch (column) {
+    case Id: return "预订号";
+    case FlightNumber: return "航班号";
+    case BookingDate: return "预订日期";
+    case PassengerCount: return "乘客数";
+    case TotalPrice: return "总价";
+    case Status: return "状态";
+    case CreatedAt: return "创建时间";
+    }
+    return QString();
+}
+
+QString BookingTableModel::cellText(const Booking &booking, int column) const
+{
+    switch (column) {
+    case Id: return QString::number(booking.id);
+    case FlightNumber: return booking.flightNumber;
+    case BookingDate: return booking.bookingDate;
+    case PassengerCount: return QString::number(booking.passengerCount);
+    case TotalPrice: return QString("¥%L1").arg(booking.totalPrice, 0, 'f', 0);
+    case Status: return booking.status;
+    case CreatedAt: return booking.createdAt;
+    }
+    return QString();
+}
+
+QVariant BookingTableModel::cellColor(const Booking &booking, int column) const
+{
+    if (column == Status && booking.status == "已取消") {
+        return QColor(255, 0, 0);
+    }
+    return QVariant();
+}
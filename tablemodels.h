@@ -0,0 +1,263 @@
+#ifndef TABLEMODELS_H
+#define TABLEMODELS_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QColor>
+#include <functional>
+#include "datamodels.h"
+
+class DatabaseHelper;
+class FlightCursor;
+
+// 类型化表格模型
+// 每行直接保存 Flight/User/Booking 结构，单元格文本在 data() 中按需生成，不为单元格创建对象。
+// 视图使用固定行高时只查询可见行；数据可整体设置，也可挂接批量数据源，
+// 由视图滚动到末尾时通过 fetchMore() 逐批拉取，百万行也不会一次性加载。
+// 数据源读完、达到行数上限或模型被重置时立即释放，它持有的游标随之关闭。
+template<typename T>
+class RecordTableModel : public QAbstractTableModel
+{
+public:
+    // 返回下一批记录；last 置为 true 表示这是最后一批，空批次同样表示已读完
+    using BatchSource = std::function<QVector<T>(bool *last)>;
+
+    explicit RecordTableModel(QObject *parent = nullptr)
+        : QAbstractTableModel(parent)
+        , exhausted(true)
+        , maxRows(0)
+    {
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : int(records.size());
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : int(columns.size());
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+    {
+        if (!index.isValid() || index.row() >= records.size() || index.column() >= columns.size()) {
+            return QVariant();
+        }
+
+        const T &item = records.at(index.row());
+        const int column = columns.at(index.column());
+        switch (role) {
+        case Qt::DisplayRole:
+            return cellText(item, column);
+        case Qt::TextAlignmentRole:
+            return int(Qt::AlignCenter);
+        case Qt::ForegroundRole:
+            return cellColor(item, column);
+        default:
+            return QVariant();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override
+    {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole || section >= columns.size()) {
+            return QAbstractTableModel::headerData(section, orientation, role);
+        }
+        return columnTitle(columns.at(section));
+    }
+
+    bool canFetchMore(const QModelIndex &parent) const override
+    {
+        return !parent.isValid() && !exhausted;
+    }
+
+    void fetchMore(const QModelIndex &parent) override
+    {
+        if (parent.isValid() || exhausted) {
+            return;
+        }
+
+        bool last = false;
+        QVector<T> batch = source(&last);
+        if (maxRows > 0 && records.size() + batch.size() >= maxRows) {
+            batch.resize(qMax(0, maxRows - int(records.size())));
+            last = true;
+        }
+        if (last || batch.isEmpty()) {
+            exhausted = true;
+            source = BatchSource();
+        }
+        appendRecords(batch);
+    }
+
+    // 通过 fetchMore() 最多读取的行数，0 表示不限
+    void setMaxRows(int rows)
+    {
+        maxRows = qMax(0, rows);
+    }
+
+    // 显示的列及顺序，取值为子类的 Column 枚举
+    void setColumns(const QVector<int> &visibleColumns)
+    {
+        beginResetModel();
+        columns = visibleColumns;
+        endResetModel();
+    }
+
+    int columnOf(int column) const
+    {
+        return int(columns.indexOf(column));
+    }
+
+    void setRecords(const QVector<T> &items)
+    {
+        beginResetModel();
+        records = items;
+        source = BatchSource();
+        exhausted = true;
+        endResetModel();
+    }
+
+    void setBatchSource(const BatchSource &next)
+    {
+        beginResetModel();
+        records.clear();
+        source = next;
+        exhausted = !next;
+        endResetModel();
+    }
+
+    void appendRecords(const QVector<T> &items)
+    {
+        if (items.isEmpty()) {
+            return;
+        }
+        beginInsertRows(QModelIndex(), int(records.size()), int(records.size() + items.size() - 1));
+        records += items;
+        endInsertRows();
+    }
+
+    void updateRecord(int row, const T &item)
+    {
+        if (row < 0 || row >= records.size()) {
+            return;
+        }
+        records[row] = item;
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    }
+
+    void removeRecord(int row)
+    {
+        if (row < 0 || row >= records.size()) {
+            return;
+        }
+        beginRemoveRows(QModelIndex(), row, row);
+        records.removeAt(row);
+        endRemoveRows();
+    }
+
+    const T &record(int row) const
+    {
+        return records.at(row);
+    }
+
+protected:
+    virtual QString columnTitle(int column) const = 0;
+    virtual QString cellText(const T &item, int column) const = 0;
+    virtual QVariant cellColor(const T &item, int column) const
+    {
+        Q_UNUSED(item);
+        Q_UNUSED(column);
+        return QVariant();
+    }
+
+private:
+    QVector<T> records;
+    QVector<int> columns;
+    BatchSource source;
+    bool exhausted;
+    int maxRows;
+};
+
+class FlightTableModel : public RecordTableModel<Flight>
+{
+public:
+    enum Column {
+        FlightNumber,
+        Airline,
+        Departure,
+        Destination,
+        DepartureTime,
+        ArrivalTime,
+        Price,
+        Status,
+        Gate,
+        Aircraft
+    };
+
+    explicit FlightTableModel(QObject *parent = nullptr);
+
+    // 按 (departure_time, id) 键集分页读取，每次 fetchMore() 执行一条短查询，
+    // 两次读取之间不持有打开的语句
+    void setDatabase(DatabaseHelper *helper, const QString &departure = "", const QString &destination = "",
+                     int pageSize = 200);
+    // 从数据库游标逐批读取；游标在读完或模型重置前一直打开并占用读快照，只适合一次读完的场景
+    void setCursor(const FlightCursor &cursor);
+
+protected:
+    QString columnTitle(int column) const override;
+    QString cellText(const Flight &flight, int column) const override;
+    QVariant cellColor(const Flight &flight, int column) const override;
+};
+
+class UserTableModel : public RecordTableModel<User>
+{
+public:
+    enum Column {
+        Id,
+        Username,
+        Name,
+        Email,
+        Phone,
+        Role,
+        Status,
+        CreatedAt
+    };
+
+    explicit UserTableModel(QObject *parent = nullptr);
+
+    // 按注册时间键集分页读取
+    void setDatabase(DatabaseHelper *helper, int pageSize = 200);
+
+protected:
+    QString columnTitle(int column) const override;
+    QString cellText(const User &user, int column) const override;
+    QVariant cellColor(const User &user, int column) const override;
+};
+
+class BookingTableModel : public RecordTableModel<Booking>
+{
+public:
+    enum Column {
+        Id,
+        FlightNumber,
+        BookingDate,
+        PassengerCount,
+        TotalPrice,
+        Status,
+        CreatedAt
+    };
+
+    explicit BookingTableModel(QObject *parent = nullptr);
+
+    // 按创建时间键集分页读取某个用户的预订
+    void setDatabase(DatabaseHelper *helper, const QString &userId, int pageSize = 200);
+
+protected:
+    QString columnTitle(int column) const override;
+    QString cellText(const Booking &booking, int column) const override;
+    QVariant cellColor(const Booking &booking, int column) const override;
+};
+
+#endif // TABLEMODELS_H
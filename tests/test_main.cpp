@@ -1,6 +1,149 @@
 #include <QtTest/QtTest>
 #include <QApplication>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QSqlRecord>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QSemaphore>
+#include <QFutureWatcher>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QCalendarWidget>
+#include <atomic>
+#include <algorithm>
 #include "mainwindow.h"
+#include "flightsearchwidget.h"
+#include "databasehelper.h"
+#include "asyncdatabasehelper.h"
+#include "seatmap.h"
+#include "routesearch.h"
+#include "farecalendar.h"
+#include "airportindex.h"
+#include "tablemodels.h"
+#include "tablefilter.h"
+#include "customwidgets.h"
+#include "apimanager.h"
+
+// 生成测试用航班数据
+static QJsonObject makeFlight(int serial, const QString &departure = "北京",
+                              const QString &destination = "上海")
+{
+    QJsonObject flight;
+    flight["flight_number"] = QString("TS%1").arg(serial, 6, 10, QChar('0'));
+    flight["airline"] = "测试航空";
+    flight["departure"] = departure;
+    flight["destination"] = destination;
+    flight["departure_time"] = QString("2024-01-15 %1:00").arg(6 + serial % 16, 2, 10, QChar('0'));
+    flight["arrival_time"] = QString("2024-01-15 %1:30").arg(8 + serial % 16, 2, 10, QChar('0'));
+    flight["status"] = "准点";
+    flight["gate"] = "A12";
+    flight["aircraft"] = "Boeing 737-800";
+    flight["price_economy"] = 600 + serial % 10 * 50;
+    flight["price_business"] = 1800 + serial % 10 * 100;
+    return flight;
+}
+
+// 本地 HTTP 桩服务器：每个连接处理一个请求，响应由 handler 生成，收到的请求按顺序记录。
+// handler 返回空时先不应答，由 releaseHeld() 统一应答
+class StubHttpServer : public QTcpServer
+{
+public:
+    struct Request
+    {
+        QByteArray method;
+        QByteArray target;
+        QHash<QByteArray, QByteArray> headers;
+    };
+    
+    std::function<QByteArray(const Request &)> handler;
+    QVector<Request> requests;
+    
+    StubHttpServer()
+    {
+        listen(QHostAddress::LocalHost);
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (hasPendingConnections()) {
+                serve(nextPendingConnection());
+            }
+        });
+    }
+    
+    QString baseUrl() const
+    {
+        return QString("http://127.0.0.1:%1").arg(serverPort());
+    }
+    
+    void releaseHeld(const QByteArray &reply)
+    {
+        const QList<QPointer<QTcpSocket>> sockets = held;
+        held.clear();
+        for (QTcpSocket *socket : sockets) {
+            if (socket) {
+                socket->write(reply);
+                socket->disconnectFromHost();
+            }
+        }
+    }
+    
+    static QByteArray response(int status, const QByteArray &body,
+                               const QList<QPair<QByteArray, QByteArray>> &headers = {})
+    {
+        QByteArray raw = "HTTP/1.1 " + QByteArray::number(status) + (status < 300 ? " OK" : " Status") + "\r\n";
+        for (const auto &header : headers) {
+            raw += header.first + ": " + header.second + "\r\n";
+        }
+        raw += "Content-Type: application/json\r\nConnection: close\r\n";
+        raw += "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+        return raw;
+    }
+    
+private:
+    QList<QPointer<QTcpSocket>> held;
+    
+    void serve(QTcpSocket *socket)
+    {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+            // 请求体不解析，应答之后到达的数据直接丢弃
+            if (socket->property("served").toBool()) {
+                socket->readAll();
+                return;
+            }
+            QByteArray buffer = socket->property("buffer").toByteArray() + socket->readAll();
+            const int end = buffer.indexOf("\r\n\r\n");
+            if (end < 0) {
+                socket->setProperty("buffer", buffer);
+                return;
+            }
+            
+            const QList<QByteArray> lines = buffer.left(end).split('\n');
+            Request request;
+            const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+            request.method = requestLine.value(0);
+            request.target = requestLine.value(1);
+            for (int i = 1; i < lines.size(); ++i) {
+                const int colon = lines.at(i).indexOf(':');
+                if (colon > 0) {
+                    request.headers.insert(lines.at(i).left(colon).trimmed().toLower(),
+                                           lines.at(i).mid(colon + 1).trimmed());
+                }
+            }
+            
+            requests.append(request);
+            socket->setProperty("served", true);
+            const QByteArray reply = handler ? handler(request) : response(404, "{}");
+            if (reply.isEmpty()) {
+                held.append(socket);
+                return;
+            }
+            socket->write(reply);
+            socket->disconnectFromHost();
+        });
+    }
+};
 
 class TestFlightSystem : public QObject
 {
@@ -11,8 +154,46 @@ private slots:
     void cleanupTestCase();
     void testMainWindowCreation();
     void testFlightSearchWidget();
+    void testFlightSearchSupersedesPreviousSearch();
     void testUserManagement();
     void testThemeSwitching();
+    void testSearchBoxDebounce();
+    void testApiResponseCacheRevalidates();
+    void testApiRequestsCoalesce();
+    void testApiDispatchByRequestKind();
+    void testApiRetriesIdempotentRequests();
+    void testApiCircuitBreaker();
+    void testApiCircuitBreakerCountsServerErrors();
+    void testApiRateLimiterPrioritizesInteractive();
+    void testApiSchedulerLimitsConnectionsPerHost();
+    
+    // 数据库
+    void testConnectionPoolReapsOnlyIdleConnections();
+    void testAsyncDatabaseSubmitAndCancel();
+    void testAsyncDatabaseDestructionFinishesFutures();
+    void testAsyncFlightStream();
+    void testHotQueriesUseIndexes();
+    void testLookupCachesInvalidateOnWrite();
+    void testImportFlights();
+    void testKeysetPagesWithDuplicateSortValues();
+    void testStatisticsMatchBaseTables();
+    void testConcurrentBookingNeverOversells();
+    void testSeatMapAdjacentSeats();
+    void testSeatMapEnginePersistSeat();
+    void testRouteSearchConnections();
+    void testRouteSearchAtScale();
+    void testFlightSearchItineraries();
+    void testFareCalendar();
+    void testFlightSearchFareHints();
+    void testAirportIndexSuggestions();
+    void testFlightTableModelFetchesInBatches();
+    void testTableFilterEngine();
+    
+    // 数据库性能基准
+    void benchmarkStorageProfile_data();
+    void benchmarkStorageProfile();
+    void benchmarkRowDecoding_data();
+    void benchmarkRowDecoding();
 
 private:
     MainWindow *mainWindow;
@@ -20,8 +201,9 @@ private:
 
 void TestFlightSystem::initTestCase()
 {
-    // 初始化测试环境
+    // 初始化测试环境，MainWindow 的数据库建在测试专用目录
     QApplication::setApplicationName("FlightSystem Test");
+    QStandardPaths::setTestModeEnabled(true);
 }
 
 void TestFlightSystem::cleanupTestCase()
@@ -73,6 +255,83 @@ void TestFlightSystem::testFlightSearchWidget()
     QTest::qWait(2000); // 等待搜索完成
 }
 
+void TestFlightSystem::testFlightSearchSupersedesPreviousSearch()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("search.db"), "", ""));
+    QJsonArray flights;
+    for (int i = 0; i < 6; ++i) {
+        flights.append(makeFlight(i, "北京", i < 4 ? "上海" : "广州"));
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(6));
+    AsyncDatabaseHelper async(&helper);
+    
+    // 后端按目的地返回一个航班，两个请求都立即应答
+    const QJsonObject shanghai = makeFlight(900, "北京", "上海");
+    const QJsonObject guangzhou = makeFlight(901, "北京", "广州");
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    server.handler = [shanghai, guangzhou](const StubHttpServer::Request &request) {
+        const bool toShanghai = request.target.contains(QUrl::toPercentEncoding("上海"));
+        const QJsonObject body{{"flights", QJsonArray{toShanghai ? shanghai : guangzhou}}};
+        return StubHttpServer::response(200, QJsonDocument(body).toJson(QJsonDocument::Compact),
+                                        {{"Cache-Control", "no-store"}});
+    };
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    
+    FlightSearchWidget widget;
+    widget.setDataSources(&async, &api);
+    QLineEdit *departureEdit = widget.findChild<QLineEdit*>("departureEdit");
+    QLineEdit *destinationEdit = widget.findChild<QLineEdit*>("destinationEdit");
+    QPushButton *searchButton = widget.findChild<QPushButton*>("searchButton");
+    QTableView *resultsTable = widget.findChild<QTableView*>("resultsTable");
+    QVERIFY(departureEdit && destinationEdit && searchButton && resultsTable);
+    
+    // 另一调用方的搜索与第一次搜索合并为同一请求
+    QStringList otherResults;
+    api.searchFlights("北京", "上海", QDate::currentDate(), [&otherResults](const QJsonObject &response, const QString &) {
+        for (const QJsonValue &flight : response["flights"].toArray()) {
+            otherResults.append(flight.toObject()["flight_number"].toString());
+        }
+    });
+    
+    // 两次搜索之间不处理事件，第一次的两个来源都还没有返回
+    departureEdit->setText("北京");
+    destinationEdit->setText("上海");
+    QTest::mouseClick(searchButton, Qt::LeftButton);
+    destinationEdit->setText("广州");
+    QTest::mouseClick(searchButton, Qt::LeftButton);
+    
+    // 第一次搜索的结果被丢弃，合并请求的另一调用方照常收到结果；
+    // 第二次搜索的网络结果优先于本地结果
+    QTRY_COMPARE(otherResults, QStringList{shanghai["flight_number"].toString()});
+    QAbstractItemModel *model = resultsTable->model();
+    QTRY_COMPARE(model->rowCount(), 1);
+    QTRY_COMPARE(model->index(0, 0).data().toString(), guangzhou["flight_number"].toString());
+    QTRY_COMPARE(async.pendingCount(), 0);
+    QTest::qWait(50);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->index(0, 0).data().toString(), guangzhou["flight_number"].toString());
+    QCOMPARE(server.requests.size(), 2);
+    QCOMPARE(api.inFlightCount(), 0);
+    
+    // 只有本地数据源时，被取代的查询同样不会覆盖新结果
+    widget.setDataSources(&async, nullptr);
+    destinationEdit->setText("上海");
+    QTest::mouseClick(searchButton, Qt::LeftButton);
+    destinationEdit->setText("广州");
+    QTest::mouseClick(searchButton, Qt::LeftButton);
+    QTRY_COMPARE(async.pendingCount(), 0);
+    QTRY_COMPARE(model->rowCount(), 2);
+    for (int row = 0; row < model->rowCount(); ++row) {
+        QCOMPARE(model->index(row, 2).data().toString(), QString("广州"));
+    }
+}
+
 void TestFlightSystem::testUserManagement()
 {
     // 测试用户管理功能
@@ -119,5 +378,1673 @@ void TestFlightSystem::testThemeSwitching()
     QVERIFY(initialStyle != newStyle);
 }
 
+void TestFlightSystem::testSearchBoxDebounce()
+{
+    ModernSearchBox box;
+    box.setDebounceInterval(50);
+    QSignalSpy spy(&box, &ModernSearchBox::searchRequested);
+    
+    // 连续输入只在停顿后搜索一次，且使用最终文本
+    QLineEdit *edit = box.findChild<QLineEdit*>();
+    QVERIFY(edit != nullptr);
+    QTest::keyClicks(edit, "beijing");
+    QCOMPARE(spy.count(), 0);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toString(), QString("beijing"));
+    
+    // 回车立即搜索并取消待触发的自动搜索
+    QTest::keyClicks(edit, "x");
+    QTest::keyClick(edit, Qt::Key_Return);
+    QCOMPARE(spy.count(), 1);
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+    
+    // 程序设置文本和清空都不触发自动搜索；输入后立即清空也会取消待触发的搜索
+    spy.clear();
+    edit->setText("shanghai");
+    box.clear();
+    QTest::keyClicks(edit, "g");
+    QTest::keyClick(edit, Qt::Key_Backspace);
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 0);
+}
+
+void TestFlightSystem::testApiResponseCacheRevalidates()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    server.handler = [](const StubHttpServer::Request &request) {
+        const QList<QPair<QByteArray, QByteArray>> headers = {
+            {"ETag", "\"v1\""}, {"Cache-Control", "max-age=60"}
+        };
+        if (request.headers.value("if-none-match") == "\"v1\"") {
+            return StubHttpServer::response(304, QByteArray(), headers);
+        }
+        return StubHttpServer::response(200, R"({"flight_number":"CA1234"})", headers);
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    api.responseCache()->setCacheDirectory(dir.path());
+    QSignalSpy spy(&api, &APIManager::flightDetailsReceived);
+    
+    api.getFlightDetails("CA1234");
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(server.requests.size(), 1);
+    QCOMPARE(server.requests.first().method, QByteArray("GET"));
+    
+    // 仍然新鲜：直接读缓存，不发请求
+    api.getFlightDetails("CA1234");
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(server.requests.size(), 1);
+    
+    // 强制刷新：条件请求得到 304，内容来自缓存
+    api.getFlightDetails("CA1234", true);
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(server.requests.size(), 2);
+    QCOMPARE(server.requests.last().headers.value("if-none-match"), QByteArray("\"v1\""));
+    QCOMPARE(spy.last().at(0).toJsonObject().value("flight_number").toString(), QString("CA1234"));
+}
+
+void TestFlightSystem::testApiRequestsCoalesce()
+{
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    server.handler = [](const StubHttpServer::Request &) {
+        return StubHttpServer::response(200, R"({"flight_number":"CA1234"})", {{"Cache-Control", "no-store"}});
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    QSignalSpy spy(&api, &APIManager::flightDetailsReceived);
+    
+    // 第一个请求返回之前的相同请求共用同一个响应
+    api.getFlightDetails("CA1234");
+    api.getFlightDetails("CA1234");
+    QCOMPARE(api.inFlightCount(), 1);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(server.requests.size(), 1);
+    QCOMPARE(api.statistics().sent, quint64(1));
+    QCOMPARE(api.statistics().coalesced, quint64(1));
+    QCOMPARE(api.inFlightCount(), 0);
+    
+    // 返回之后再请求会重新发出
+    api.getFlightDetails("CA1234");
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(server.requests.size(), 2);
+    QCOMPARE(api.statistics().coalesced, quint64(1));
+}
+
+void TestFlightSystem::testApiDispatchByRequestKind()
+{
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    server.handler = [](const StubHttpServer::Request &request) {
+        return StubHttpServer::response(200, "{\"target\":\"" + request.target + "\"}", {{"Cache-Control", "no-store"}});
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    QSignalSpy userBookings(&api, &APIManager::userBookingsReceived);
+    QSignalSpy cancelled(&api, &APIManager::bookingCancelled);
+    QSignalSpy created(&api, &APIManager::bookingCompleted);
+    QSignalSpy profile(&api, &APIManager::userProfileReceived);
+    
+    // 路径里同时带 /users/ 和 /bookings 的请求只按登记的类型分发
+    QStringList targets;
+    const APIManager::ResponseHandler collect = [&targets](const QJsonObject &response, const QString &error) {
+        QVERIFY(error.isEmpty());
+        targets.append(response.value("target").toString());
+    };
+    api.getUserBookings("1001", QUrlQuery(), false, collect);
+    api.getUserBookings("1001", QUrlQuery(), false, collect);
+    api.cancelBooking("BK001", QJsonObject{{"reason", "行程变更"}}, collect);
+    
+    QTRY_COMPARE(targets.size(), 3);
+    QCOMPARE(userBookings.count(), 1);
+    QCOMPARE(cancelled.count(), 1);
+    QCOMPARE(created.count(), 0);
+    QCOMPARE(profile.count(), 0);
+    QCOMPARE(targets.count("/users/1001/bookings"), 2);
+    QCOMPARE(server.requests.size(), 2);
+    
+    bool cancelSeen = false;
+    for (const StubHttpServer::Request &request : server.requests) {
+        if (request.target == "/bookings/BK001/cancel") {
+            QCOMPARE(request.method, QByteArray("PUT"));
+            cancelSeen = true;
+        }
+    }
+    QVERIFY(cancelSeen);
+}
+
+void TestFlightSystem::testApiRetriesIdempotentRequests()
+{
+    RetryPolicy policy;
+    policy.maxAttempts = 3;
+    policy.baseDelayMs = 100;
+    policy.maxDelayMs = 300;
+    QCOMPARE(policy.delayFor(1, 0.0), 100);
+    QCOMPARE(policy.delayFor(2, 0.0), 200);
+    QCOMPARE(policy.delayFor(5, 0.0), 300);
+    QCOMPARE(policy.delayFor(2, 0.99), 101);
+    
+    // 前两次 503，第三次成功
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    int calls = 0;
+    server.handler = [&calls](const StubHttpServer::Request &) {
+        if (++calls <= 2) {
+            return StubHttpServer::response(503, "{}");
+        }
+        return StubHttpServer::response(200, R"({"flight_number":"CA1234"})", {{"Cache-Control", "no-store"}});
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    policy.baseDelayMs = 10;
+    api.setRetryPolicy(ApiRequest::FlightDetails, policy);
+    api.setRetryPolicy(ApiRequest::CreateBooking, policy);
+    QCOMPARE(api.retryPolicy(ApiRequest::CreateBooking).maxAttempts, 1);
+    
+    QSignalSpy details(&api, &APIManager::flightDetailsReceived);
+    QSignalSpy errors(&api, &APIManager::errorOccurred);
+    api.getFlightDetails("CA1234");
+    QTRY_COMPARE(details.count(), 1);
+    QCOMPARE(errors.count(), 0);
+    QCOMPARE(server.requests.size(), 3);
+    QCOMPARE(api.statistics().retried, quint64(2));
+    
+    // POST 不重试
+    calls = 0;
+    api.bookFlight(QJsonObject{{"flight_number", "CA1234"}});
+    QTRY_COMPARE(errors.count(), 1);
+    QTest::qWait(50);
+    QCOMPARE(server.requests.size(), 4);
+}
+
+void TestFlightSystem::testApiCircuitBreaker()
+{
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    bool healthy = false;
+    server.handler = [&healthy](const StubHttpServer::Request &) {
+        return healthy ? StubHttpServer::response(200, R"({"status":"healthy"})", {{"Cache-Control", "no-store"}})
+                       : StubHttpServer::response(503, "{}");
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    api.setRetryPolicy(ApiRequest::SystemStatus, RetryPolicy::none());
+    api.circuitBreaker().setFailureThreshold(2);
+    api.circuitBreaker().setOpenDuration(200);
+    QSignalSpy status(&api, &APIManager::systemStatusReceived);
+    QSignalSpy errors(&api, &APIManager::errorOccurred);
+    
+    api.getSystemStatus();
+    QTRY_COMPARE(errors.count(), 1);
+    api.getSystemStatus();
+    QTRY_COMPARE(errors.count(), 2);
+    QCOMPARE(api.circuitBreaker().state(), CircuitBreaker::State::Open);
+    
+    // 熔断期间直接失败，不访问服务器
+    api.getSystemStatus();
+    QTRY_COMPARE(errors.count(), 3);
+    QCOMPARE(server.requests.size(), 2);
+    QCOMPARE(api.statistics().rejected, quint64(1));
+    
+    // 打开时长过后放行一个探测请求，成功即恢复
+    healthy = true;
+    QTest::qWait(250);
+    api.getSystemStatus();
+    QTRY_COMPARE(status.count(), 1);
+    QCOMPARE(server.requests.size(), 3);
+    QCOMPARE(api.circuitBreaker().state(), CircuitBreaker::State::Closed);
+}
+
+void TestFlightSystem::testApiCircuitBreakerCountsServerErrors()
+{
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    int status = 404;
+    server.handler = [&status](const StubHttpServer::Request &) {
+        return StubHttpServer::response(status, "{}");
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    api.setRetryPolicy(ApiRequest::SystemStatus, RetryPolicy::none());
+    api.circuitBreaker().setFailureThreshold(3);
+    QSignalSpy errors(&api, &APIManager::errorOccurred);
+    
+    // 4xx 是请求本身的问题，不计入熔断
+    for (int i = 1; i <= 3; ++i) {
+        api.getSystemStatus();
+        QTRY_COMPARE(errors.count(), i);
+    }
+    QCOMPARE(api.circuitBreaker().state(), CircuitBreaker::State::Closed);
+    QCOMPARE(api.circuitBreaker().consecutiveFailures(), 0);
+    
+    // 不在重试范围内的 500 同样计入，连续三次后熔断
+    status = 500;
+    for (int i = 4; i <= 6; ++i) {
+        api.getSystemStatus();
+        QTRY_COMPARE(errors.count(), i);
+    }
+    QCOMPARE(api.circuitBreaker().state(), CircuitBreaker::State::Open);
+    QCOMPARE(server.requests.size(), 6);
+    
+    // 连接被拒绝等网络层错误也计入
+    quint16 closedPort = 0;
+    {
+        QTcpServer probe;
+        QVERIFY(probe.listen(QHostAddress::LocalHost));
+        closedPort = probe.serverPort();
+    }
+    APIManager offline;
+    offline.setBaseUrl(QString("http://127.0.0.1:%1").arg(closedPort));
+    offline.setRetryPolicy(ApiRequest::SystemStatus, RetryPolicy::none());
+    QSignalSpy offlineErrors(&offline, &APIManager::errorOccurred);
+    offline.getSystemStatus();
+    QTRY_COMPARE(offlineErrors.count(), 1);
+    QCOMPARE(offline.circuitBreaker().consecutiveFailures(), 1);
+}
+
+void TestFlightSystem::testApiRateLimiterPrioritizesInteractive()
+{
+    TokenBucket bucket(2, 60);
+    QVERIFY(bucket.tryTake(0));
+    QVERIFY(bucket.tryTake(0));
+    QVERIFY(!bucket.tryTake(0));
+    QCOMPARE(bucket.waitTime(0), qint64(1000));
+    QVERIFY(bucket.tryTake(1000));
+    
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    server.handler = [](const StubHttpServer::Request &) {
+        return StubHttpServer::response(200, "{}", {{"Cache-Control", "no-store"}});
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    // 只有一个令牌，之后每 100ms 补充一个
+    api.setRateLimit(RateLimit::General, 1, 600);
+    
+    api.getFlightStatistics();
+    api.getSystemStatus();
+    api.searchFlights("北京", "上海", QDate(2024, 1, 15));
+    QCOMPARE(api.queuedCount(), 2);
+    
+    // 后到的搜索先于排在前面的后台刷新发出
+    QTRY_COMPARE(server.requests.size(), 3);
+    QVERIFY(server.requests.at(0).target.startsWith("/statistics/flights"));
+    QVERIFY(server.requests.at(1).target.startsWith("/flights/search"));
+    QVERIFY(server.requests.at(2).target.startsWith("/system/status"));
+    QCOMPARE(api.statistics().queued, quint64(2));
+    QCOMPARE(api.queuedCount(), 0);
+}
+
+void TestFlightSystem::testApiSchedulerLimitsConnectionsPerHost()
+{
+    StubHttpServer server;
+    QVERIFY(server.isListening());
+    bool hold = true;
+    const QByteArray ok = StubHttpServer::response(200, "{}", {{"Cache-Control", "no-store"}});
+    server.handler = [&hold, ok](const StubHttpServer::Request &) {
+        return hold ? QByteArray() : ok;
+    };
+    
+    APIManager api;
+    api.setBaseUrl(server.baseUrl());
+    api.setMaxConnectionsPerHost(2);
+    QSignalSpy errors(&api, &APIManager::errorOccurred);
+    
+    // 后台请求只能占一个连接，另一个留给前台
+    api.getSystemStatus();
+    api.getSystemConfig();
+    api.getFlightDetails("CA1234");
+    api.bookFlight(QJsonObject{{"flight_number", "CA1234"}});
+    QTRY_COMPARE(server.requests.size(), 2);
+    
+    SchedulerStatistics stats = api.schedulerStatistics();
+    QCOMPARE(stats.active, 2);
+    QCOMPARE(stats.queued.at(int(RequestPriority::Interactive)), 1);
+    QCOMPARE(stats.queued.at(int(RequestPriority::Background)), 1);
+    QCOMPARE(stats.peakQueued, 2);
+    
+    // 连接空出后预订先于排在前面的后台请求发出
+    hold = false;
+    server.releaseHeld(ok);
+    QTRY_COMPARE(server.requests.size(), 4);
+    QCOMPARE(server.requests.at(2).target, QByteArray("/bookings"));
+    QVERIFY(server.requests.at(3).target.startsWith("/system/config"));
+    QTRY_COMPARE(api.inFlightCount(), 0);
+    
+    // 排队超过期限的后台请求直接失败
+    hold = true;
+    api.setQueueDeadline(RequestPriority::Background, 50);
+    api.getFlightDetails("MU5101");
+    api.getFlightDetails("MU5102");
+    api.getFlightStatistics();
+    QTRY_COMPARE(errors.count(), 1);
+    QCOMPARE(api.schedulerStatistics().expired, quint64(1));
+    QCOMPARE(api.queuedCount(), 0);
+    
+    hold = false;
+    server.releaseHeld(ok);
+    QTRY_COMPARE(api.inFlightCount(), 0);
+    QCOMPARE(server.requests.size(), 6);
+}
+
+void TestFlightSystem::testConnectionPoolReapsOnlyIdleConnections()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("pool.db"), "", ""));
+    ConnectionPool *pool = helper.pool();
+    pool->setMaxIdleTime(1);
+    
+    QJsonArray flights;
+    for (int i = 0; i < 30; ++i) {
+        flights.append(makeFlight(i));
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(30));
+    
+    // 游标打开期间连接被钉住，超时也不回收，游标能读完全部行
+    FlightCursor cursor = helper.openFlightCursor("", "", 10);
+    QVERIFY(cursor.isValid());
+    QCOMPARE(cursor.nextBatch().size(), 10);
+    QTest::qWait(10);
+    QCOMPARE(pool->reapIdleConnections(), 0);
+    qint64 rows = 10;
+    while (!cursor.atEnd()) {
+        rows += cursor.nextBatch().size();
+    }
+    QCOMPARE(rows, qint64(30));
+    QTest::qWait(10);
+    QCOMPARE(pool->reapIdleConnections(), 1);
+    
+    // 工作线程持有连接时，回收只做标记，由该线程下次使用时自己重新打开
+    QSemaphore acquired;
+    QSemaphore reaped;
+    bool openAfterReap = false;
+    int rowsAfterReap = 0;
+    QThread *worker = QThread::create([&]() {
+        {
+            QSqlDatabase database = pool->acquire();
+            acquired.release();
+            reaped.acquire();
+            openAfterReap = database.isOpen();
+        }
+        rowsAfterReap = helper.queryFlights().size();
+    });
+    worker->start();
+    acquired.acquire();
+    QTest::qWait(10);
+    QCOMPARE(pool->reapIdleConnections(), 0);
+    QCOMPARE(pool->connectionCount(), 1);
+    reaped.release();
+    worker->wait();
+    delete worker;
+    
+    QVERIFY(openAfterReap);
+    QCOMPARE(rowsAfterReap, 30);
+    QCOMPARE(pool->connectionCount(), 0);
+}
+
+void TestFlightSystem::testAsyncDatabaseSubmitAndCancel()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("async.db"), "", ""));
+    QVERIFY(helper.insertFlight(makeFlight(1)));
+    AsyncDatabaseHelper async(&helper);
+    
+    // 任务在工作线程执行，结果经 QFutureWatcher 回到 GUI 线程
+    QThread *taskThread = nullptr;
+    QThread *deliveryThread = nullptr;
+    QFutureWatcher<int> watcher;
+    connect(&watcher, &QFutureWatcher<int>::finished, this, [&deliveryThread]() {
+        deliveryThread = QThread::currentThread();
+    });
+    watcher.setFuture(async.submit<int>([&taskThread](DatabaseHelper *database) {
+        taskThread = QThread::currentThread();
+        return int(database->queryFlights().size());
+    }));
+    QTRY_VERIFY(deliveryThread != nullptr);
+    QCOMPARE(watcher.result(), 1);
+    QCOMPARE(deliveryThread, QThread::currentThread());
+    QVERIFY(taskThread != QThread::currentThread());
+    
+    // 排在阻塞任务之后、开始前被取消的查询不会执行
+    QSemaphore gate;
+    QFuture<int> blocker = async.submit<int>([&gate](DatabaseHelper *) {
+        gate.acquire();
+        return 0;
+    });
+    std::atomic<bool> ran(false);
+    QueryCancelToken token;
+    QFuture<int> cancelled = async.submit<int>([&ran](DatabaseHelper *) {
+        ran = true;
+        return 1;
+    }, token);
+    token.cancel();
+    gate.release();
+    
+    QTRY_VERIFY(cancelled.isFinished());
+    QVERIFY(blocker.isFinished());
+    QVERIFY(cancelled.isCanceled());
+    QVERIFY(!ran);
+    QTRY_COMPARE(async.pendingCount(), 0);
+}
+
+void TestFlightSystem::testAsyncDatabaseDestructionFinishesFutures()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("shutdown.db"), "", ""));
+    AsyncDatabaseHelper *async = new AsyncDatabaseHelper(&helper);
+    
+    // 一个任务正在执行，两个仍在排队时析构
+    QSemaphore started;
+    QSemaphore gate;
+    QFuture<int> running = async->submit<int>([&started, &gate](DatabaseHelper *) {
+        started.release();
+        gate.acquire();
+        return 7;
+    });
+    std::atomic<int> ran(0);
+    QFuture<int> queued = async->submit<int>([&ran](DatabaseHelper *) {
+        ++ran;
+        return 1;
+    });
+    QFuture<QJsonArray> flights = async->getFlights();
+    started.acquire();
+    
+    QThread *releaser = QThread::create([&gate]() {
+        QThread::msleep(50);
+        gate.release();
+    });
+    releaser->start();
+    delete async;
+    releaser->wait();
+    delete releaser;
+    
+    // 析构返回时所有 QFuture 都已完成，waitForFinished() 不会阻塞
+    QVERIFY(running.isFinished());
+    QVERIFY(!running.isCanceled());
+    QCOMPARE(running.result(), 7);
+    QVERIFY(queued.isFinished());
+    QVERIFY(queued.isCanceled());
+    flights.waitForFinished();
+    QVERIFY(flights.isCanceled());
+    QCOMPARE(ran.load(), 0);
+}
+
+void TestFlightSystem::testAsyncFlightStream()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("stream.db"), "", ""));
+    QJsonArray flights;
+    for (int i = 0; i < 25; ++i) {
+        flights.append(makeFlight(i));
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(25));
+    QStringList expected;
+    for (const Flight &flight : helper.queryFlights()) {
+        expected.append(flight.flightNumber);
+    }
+    AsyncDatabaseHelper async(&helper);
+    
+    // 每批 10 行、最多预读 1 批：3 批按查询顺序到达，流读取期间提交的查询不必等到流结束
+    FlightStream *stream = async.streamFlights("", "", 10, 1, this);
+    QFuture<int> other = async.submit<int>([](DatabaseHelper *database) {
+        return int(database->queryFlights().size());
+    });
+    QVector<int> sizes;
+    QStringList received;
+    bool otherDoneFirst = false;
+    connect(stream, &FlightStream::batchReady, this, [&](const QVector<Flight> &batch) {
+        sizes.append(batch.size());
+        for (const Flight &flight : batch) {
+            received.append(flight.flightNumber);
+        }
+    });
+    connect(stream, &FlightStream::finished, this, [&]() {
+        otherDoneFirst = other.isFinished();
+    });
+    QTRY_VERIFY(stream->isFinished());
+    QCOMPARE(sizes, QVector<int>({10, 10, 5}));
+    QCOMPARE(received, expected);
+    QCOMPARE(stream->rowCount(), qint64(25));
+    QVERIFY(!stream->isCancelled());
+    QVERIFY(otherDoneFirst);
+    delete stream;
+    
+    // 结果不足一批时也整批交付，随后才结束
+    FlightStream *small = async.streamFlights("", "", 100, 1, this);
+    QVector<int> smallSizes;
+    connect(small, &FlightStream::batchReady, this, [&smallSizes, small](const QVector<Flight> &batch) {
+        QVERIFY(!small->isFinished());
+        smallSizes.append(batch.size());
+    });
+    QTRY_VERIFY(small->isFinished());
+    QCOMPARE(smallSizes, QVector<int>({25}));
+    delete small;
+    
+    // 收到第一批后取消：不再交付后续批次，流正常结束
+    FlightStream *cancelled = async.streamFlights("", "", 5, 1, this);
+    int batches = 0;
+    connect(cancelled, &FlightStream::batchReady, this, [&batches, cancelled](const QVector<Flight> &) {
+        ++batches;
+        cancelled->cancel();
+    });
+    QTRY_VERIFY(cancelled->isFinished());
+    QCOMPARE(batches, 1);
+    QCOMPARE(cancelled->batchCount(), 1);
+    QVERIFY(cancelled->isCancelled());
+    QTRY_COMPARE(async.pendingCount(), 0);
+    delete cancelled;
+}
+
+void TestFlightSystem::testHotQueriesUseIndexes()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("plan.db"), "", ""));
+    
+    // 任一热点查询退化为全表扫描即失败
+    for (const QString &sql : DatabaseHelper::hotQueries()) {
+        const QStringList plan = helper.explainQueryPlan(sql);
+        QVERIFY2(!plan.isEmpty(), qPrintable(sql));
+        for (const QString &step : plan) {
+            QVERIFY2(!step.startsWith("SCAN"), qPrintable(sql + " => " + step));
+        }
+    }
+}
+
+void TestFlightSystem::testLookupCachesInvalidateOnWrite()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("cache.db"), "", ""));
+    auto hits = [&helper](const QString &cache) {
+        return helper.getLookupCacheStatistics()[cache].toObject()["hits"].toString().toLongLong();
+    };
+    
+    // 航班：第二次查找命中缓存，改状态和重新导入后读到新值
+    const QJsonObject flight = makeFlight(1);
+    const QString flightNumber = flight["flight_number"].toString();
+    QVERIFY(helper.insertFlight(flight));
+    QCOMPARE(helper.findFlight(flightNumber).status, QString("准点"));
+    QCOMPARE(helper.findFlight(flightNumber).status, QString("准点"));
+    QCOMPARE(hits("flights"), qint64(1));
+    
+    QVERIFY(helper.updateFlightStatus(flightNumber, "延误"));
+    QCOMPARE(helper.findFlight(flightNumber).status, QString("延误"));
+    
+    QJsonObject reimported = flight;
+    reimported["airline"] = "导入航空";
+    reimported["status"] = "登机";
+    QCOMPARE(helper.importFlights(QJsonArray{reimported}).imported, qint64(1));
+    const Flight afterImport = helper.findFlight(flightNumber);
+    QCOMPARE(afterImport.airline, QString("导入航空"));
+    QCOMPARE(afterImport.status, QString("登机"));
+    
+    // 用户：按 id 更新和删除时只失效该用户，其他用户的缓存项保留
+    for (const QString &name : {QString("alice"), QString("bob")}) {
+        QVERIFY(helper.insertUser(QJsonObject{{"username", name}, {"password", "secret"},
+                                              {"email", name + "@example.com"}, {"role", "user"},
+                                              {"status", "active"}}));
+    }
+    const User alice = helper.findUser("alice");
+    const User bob = helper.findUser("bob");
+    QVERIFY(alice.isValid() && bob.isValid());
+    QCOMPARE(helper.findUser("alice").email, QString("alice@example.com"));
+    const qint64 userHits = hits("users");
+    QCOMPARE(userHits, qint64(1));
+    
+    QJsonObject changes = alice.toJson();
+    changes["email"] = "alice@new.example.com";
+    QVERIFY(helper.updateUser(QString::number(alice.id), changes));
+    QCOMPARE(helper.findUser("alice").email, QString("alice@new.example.com"));
+    QCOMPARE(helper.findUser("bob").email, QString("bob@example.com"));
+    QCOMPARE(hits("users"), userHits + 1);
+    
+    QVERIFY(helper.deleteUser(QString::number(alice.id)));
+    QVERIFY(!helper.findUser("alice").isValid());
+    QVERIFY(helper.findUser("bob").isValid());
+    
+    // 清空缓存后按 id 失效仍然有效
+    helper.clearLookupCaches();
+    QCOMPARE(helper.findUser("bob").email, QString("bob@example.com"));
+    QVERIFY(helper.deleteUser(QString::number(bob.id)));
+    QVERIFY(!helper.findUser("bob").isValid());
+}
+
+void TestFlightSystem::testImportFlights()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("import.db"), "", ""));
+    QSignalSpy progress(&helper, &DatabaseHelper::importProgress);
+    
+    // 每 4 条一批：每批之后和结束时各报告一次进度
+    QJsonArray flights;
+    for (int i = 0; i < 10; ++i) {
+        flights.append(makeFlight(i));
+    }
+    ImportResult result = helper.importFlights(flights, 4);
+    QCOMPARE(result.processed, qint64(10));
+    QCOMPARE(result.imported, qint64(10));
+    QCOMPARE(result.failed, qint64(0));
+    QCOMPARE(progress.count(), 3);
+    QCOMPARE(progress.at(0).at(0).toLongLong(), qint64(4));
+    QCOMPARE(progress.at(1).at(0).toLongLong(), qint64(8));
+    QCOMPARE(progress.last().at(0).toLongLong(), qint64(10));
+    QCOMPARE(progress.last().at(1).toLongLong(), qint64(10));
+    
+    // 已存在的航班号更新而不是重复插入；缺少航班号的记录计为失败
+    QJsonArray upserts;
+    for (int i = 5; i < 15; ++i) {
+        QJsonObject flight = makeFlight(i);
+        flight["gate"] = "B7";
+        upserts.append(flight);
+    }
+    upserts.append(QJsonObject{{"airline", "无航班号"}});
+    result = helper.importFlights(upserts);
+    QCOMPARE(result.imported, qint64(10));
+    QCOMPARE(result.failed, qint64(1));
+    QCOMPARE(helper.queryFlights().size(), 15);
+    QCOMPARE(helper.findFlight(makeFlight(4)["flight_number"].toString()).gate, QString("A12"));
+    QCOMPARE(helper.findFlight(makeFlight(5)["flight_number"].toString()).gate, QString("B7"));
+    
+    // 不带 status 的记录不会把已有航班改回准点；新航班取表默认值
+    QJsonObject delayed = makeFlight(6);
+    delayed["status"] = "延误";
+    QCOMPARE(helper.importFlights(QJsonArray{delayed}).imported, qint64(1));
+    QJsonObject withoutStatus = makeFlight(6);
+    withoutStatus.remove("status");
+    withoutStatus["gate"] = "C3";
+    QJsonObject newWithoutStatus = makeFlight(15);
+    newWithoutStatus.remove("status");
+    result = helper.importFlights(QJsonArray{withoutStatus, newWithoutStatus});
+    QCOMPARE(result.imported, qint64(2));
+    helper.clearLookupCaches();
+    const Flight kept = helper.findFlight(makeFlight(6)["flight_number"].toString());
+    QCOMPARE(kept.status, QString("延误"));
+    QCOMPARE(kept.gate, QString("C3"));
+    QCOMPARE(helper.findFlight(makeFlight(15)["flight_number"].toString()).status, QString("准点"));
+    
+    // 一行被拒绝时整批回退为逐行写入，只有这一行失败
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "import-trigger");
+        database.setDatabaseName(dir.filePath("import.db"));
+        QVERIFY(database.open());
+        QSqlQuery query(database);
+        QVERIFY(query.exec("CREATE TRIGGER reject_gate BEFORE INSERT ON flights WHEN NEW.gate = 'BAD' "
+                           "BEGIN SELECT RAISE(ABORT, 'rejected'); END"));
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("import-trigger");
+    QJsonArray mixed;
+    for (int i = 20; i < 25; ++i) {
+        QJsonObject flight = makeFlight(i);
+        if (i == 22) {
+            flight["gate"] = "BAD";
+        }
+        mixed.append(flight);
+    }
+    result = helper.importFlights(mixed);
+    QCOMPARE(result.imported, qint64(4));
+    QCOMPARE(result.failed, qint64(1));
+    QVERIFY(helper.findFlight(makeFlight(21)["flight_number"].toString()).isValid());
+    QVERIFY(!helper.findFlight(makeFlight(22)["flight_number"].toString()).isValid());
+    QVERIFY(helper.findFlight(makeFlight(23)["flight_number"].toString()).isValid());
+    
+    // CSV：引号内的逗号、转义引号和换行属于字段内容，不影响后面的记录；
+    // 末尾引号未闭合的记录计为失败
+    const QString csvPath = dir.filePath("flights.csv");
+    {
+        QFile csv(csvPath);
+        QVERIFY(csv.open(QIODevice::WriteOnly | QIODevice::Text));
+        csv.write("flight_number,airline,departure,destination,departure_time,arrival_time,aircraft,price_economy\n"
+                  "CSV001,\"航空, 有限公司\",北京,上海,2024-02-01 08:00,2024-02-01 10:00,\"Boeing \"\"737\"\"\nMAX\",880\n"
+                  "\n"
+                  "CSV002,测试航空,北京,广州,2024-02-01 09:00,2024-02-01 12:00,A320,990\n"
+                  "CSV003,测试航空,北京,深圳,2024-02-01 10:00,2024-02-01 13:00,\"A321\n");
+    }
+    result = helper.importFlightsFromFile(csvPath);
+    QCOMPARE(result.processed, qint64(3));
+    QCOMPARE(result.imported, qint64(2));
+    QCOMPARE(result.failed, qint64(1));
+    const Flight quoted = helper.findFlight("CSV001");
+    QCOMPARE(quoted.airline, QString("航空, 有限公司"));
+    QCOMPARE(quoted.aircraft, QString("Boeing \"737\"\nMAX"));
+    QCOMPARE(quoted.economyPrice, 880.0);
+    const Flight next = helper.findFlight("CSV002");
+    QCOMPARE(next.destination, QString("广州"));
+    QCOMPARE(next.aircraft, QString("A320"));
+    
+    // NDJSON：每行一个对象，空行跳过
+    const QString ndjsonPath = dir.filePath("flights.ndjson");
+    {
+        QFile ndjson(ndjsonPath);
+        QVERIFY(ndjson.open(QIODevice::WriteOnly | QIODevice::Text));
+        for (int i = 30; i < 33; ++i) {
+            ndjson.write(QJsonDocument(makeFlight(i)).toJson(QJsonDocument::Compact) + "\n\n");
+        }
+    }
+    result = helper.importFlightsFromFile(ndjsonPath, 2);
+    QCOMPARE(result.processed, qint64(3));
+    QCOMPARE(result.imported, qint64(3));
+    QCOMPARE(helper.findFlight(makeFlight(31)["flight_number"].toString()).departure, QString("北京"));
+}
+
+void TestFlightSystem::testKeysetPagesWithDuplicateSortValues()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("pages.db"), "", ""));
+    
+    // 20 条记录中 15 条排序值相同，只能靠 id 决定先后
+    QJsonArray flights;
+    for (int i = 0; i < 20; ++i) {
+        QJsonObject flight = makeFlight(i);
+        flight["departure_time"] = i < 15 ? QString("2024-03-01 08:00") : QString("2024-03-0%1 08:00").arg(i - 13);
+        flights.append(flight);
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(20));
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(helper.insertUser(QJsonObject{{"username", QString("user%1").arg(i)}, {"password", "secret"},
+                                              {"email", QString("user%1@example.com").arg(i)},
+                                              {"role", "user"}, {"status", "active"}}));
+        QVERIFY(helper.insertBooking(QJsonObject{{"user_id", QString::number(i % 2 + 1)},
+                                                 {"flight_number", makeFlight(i)["flight_number"].toString()},
+                                                 {"booking_date", "2024-03-01"}, {"status", "已确认"},
+                                                 {"total_price", "800"}, {"passenger_count", "1"}}));
+    }
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "page-timestamps");
+        database.setDatabaseName(dir.filePath("pages.db"));
+        QVERIFY(database.open());
+        QSqlQuery query(database);
+        QVERIFY(query.exec("UPDATE users SET created_at = '2024-03-01 00:00:00' WHERE id <= 15"));
+        QVERIFY(query.exec("UPDATE bookings SET created_at = '2024-03-01 00:00:00'"));
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("page-timestamps");
+    
+    // 逐页读到 hasMore 为 false：每条记录恰好出现一次，顺序与 (排序列, id) 一致
+    auto walk = [](auto fetch, int pageSize, QVector<qint64> &ids, int &pages) {
+        ids.clear();
+        pages = 0;
+        PageKey after;
+        for (;;) {
+            const auto page = fetch(after, pageSize);
+            ++pages;
+            for (const auto &item : page.items) {
+                ids.append(item.id);
+            }
+            if (!page.hasMore) {
+                // 最后一页之后再取是空页，next 保持原位置
+                const auto beyond = fetch(page.next, pageSize);
+                QVERIFY(beyond.items.isEmpty());
+                QVERIFY(!beyond.hasMore);
+                QCOMPARE(beyond.next.id, page.next.id);
+                QCOMPARE(beyond.next.sortValue, page.next.sortValue);
+                return;
+            }
+            QVERIFY(!page.next.isFirst());
+            after = page.next;
+        }
+    };
+    auto expectAscending = [](const QVector<qint64> &ids, int count) {
+        QCOMPARE(ids.size(), count);
+        QCOMPARE(QSet<qint64>(ids.begin(), ids.end()).size(), count);
+    };
+    
+    QVector<qint64> ids;
+    int pages = 0;
+    for (int pageSize : {1, 4, 5, 7, 20, 50}) {
+        walk([&helper](const PageKey &after, int size) {
+            return helper.queryFlightPage("", "", after, size);
+        }, pageSize, ids, pages);
+        expectAscending(ids, 20);
+        QCOMPARE(pages, qMax(1, (20 + pageSize - 1) / pageSize));
+        QVector<qint64> expected;
+        for (const Flight &flight : helper.queryFlightPage("", "", PageKey(), 100).items) {
+            expected.append(flight.id);
+        }
+        QCOMPARE(ids, expected);
+        // 排序值相同的前 15 条按 id 递增
+        QVERIFY(std::is_sorted(ids.begin(), ids.begin() + 15));
+        
+        walk([&helper](const PageKey &after, int size) {
+            return helper.queryUserPage(after, size);
+        }, pageSize, ids, pages);
+        expectAscending(ids, 20);
+        QVERIFY(std::is_sorted(ids.begin(), ids.begin() + 15));
+        
+        walk([&helper](const PageKey &after, int size) {
+            return helper.queryBookingPage("", after, size);
+        }, pageSize, ids, pages);
+        expectAscending(ids, 20);
+        QVERIFY(std::is_sorted(ids.begin(), ids.end()));
+        
+        walk([&helper](const PageKey &after, int size) {
+            return helper.queryBookingPage("1", after, size);
+        }, pageSize, ids, pages);
+        expectAscending(ids, 10);
+    }
+    
+    // 筛选后没有记录时只有一页空页
+    const Page<Flight> none = helper.queryFlightPage("北京", "广州");
+    QVERIFY(none.items.isEmpty());
+    QVERIFY(!none.hasMore);
+    QVERIFY(none.next.isFirst());
+}
+
+void TestFlightSystem::testStatisticsMatchBaseTables()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("stats.db"), "", ""));
+    
+    QJsonArray flights;
+    for (int i = 0; i < 40; ++i) {
+        flights.append(makeFlight(i, "北京", i % 2 ? "上海" : "广州"));
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(40));
+    // 重复导入走 UPDATE 分支，计数不应翻倍
+    QCOMPARE(helper.importFlights(flights).imported, qint64(40));
+    
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(helper.updateFlightStatus(makeFlight(i)["flight_number"].toString(), "延误"));
+    }
+    
+    QSqlQuery query(helper.pool()->acquire());
+    QVERIFY(query.exec("DELETE FROM flights WHERE id % 7 = 0"));
+    
+    auto baseCount = [&query](const QString &sql) {
+        return query.exec(sql) && query.next() ? query.value(0).toLongLong() : -1;
+    };
+    
+    // 第二轮在重建后再次核对，触发器维护的计数应与回填结果一致
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) {
+            QVERIFY(helper.rebuildStatistics());
+        }
+        
+        QCOMPARE(helper.counterValue("flights", "total"), baseCount("SELECT COUNT(*) FROM flights"));
+        QCOMPARE(helper.counterValue("flight_status", "准点"),
+                 baseCount("SELECT COUNT(*) FROM flights WHERE status = '准点'"));
+        QCOMPARE(helper.counterValue("flight_status", "延误"),
+                 baseCount("SELECT COUNT(*) FROM flights WHERE status = '延误'"));
+        QCOMPARE(helper.counterValue("flight_route", "北京-上海"),
+                 baseCount("SELECT COUNT(*) FROM flights WHERE destination = '上海'"));
+        QCOMPARE(helper.counterValue("flight_day", "2024-01-15"), baseCount("SELECT COUNT(*) FROM flights"));
+    }
+}
+
+void TestFlightSystem::testConcurrentBookingNeverOversells()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("booking.db"), "", ""));
+    
+    const QString flightNumber = makeFlight(1)["flight_number"].toString();
+    QVERIFY(helper.insertFlight(makeFlight(1)));
+    QVERIFY(helper.setSeatInventory(flightNumber, "经济舱", 50));
+    
+    // 8 个线程共争 50 个座位，每次预订 1 人
+    const int threadCount = 8;
+    const int bookingsPerThread = 10;
+    std::atomic<int> booked(0);
+    std::atomic<int> soldOut(0);
+    std::atomic<int> conflicts(0);
+    
+    QList<QThread *> clients;
+    for (int t = 0; t < threadCount; ++t) {
+        QThread *client = QThread::create([&, t]() {
+            for (int i = 0; i < bookingsPerThread; ++i) {
+                Booking booking;
+                booking.userId = t + 1;
+                booking.flightNumber = flightNumber;
+                booking.totalPrice = 800.0;
+                
+                Passenger passenger;
+                passenger.firstName = "测试";
+                passenger.lastName = QString::number(t);
+                passenger.idNumber = QString("%1-%2").arg(t).arg(i);
+                
+                switch (helper.createBooking(booking, {passenger}).status) {
+                case BookingResult::Booked: ++booked; break;
+                case BookingResult::SoldOut: ++soldOut; break;
+                case BookingResult::Conflict: ++conflicts; break;
+                default: break;
+                }
+            }
+        });
+        client->start();
+        clients.append(client);
+    }
+    
+    for (QThread *client : clients) {
+        client->wait();
+        delete client;
+    }
+    
+    QCOMPARE(booked + soldOut + conflicts, threadCount * bookingsPerThread);
+    QVERIFY(booked <= 50);
+    QCOMPARE(helper.findSeatInventory(flightNumber, "经济舱").available, 50 - booked);
+    QCOMPARE(helper.counterValue("bookings", "total"), qint64(booked));
+    
+    QSqlQuery query(helper.pool()->acquire());
+    QVERIFY(query.exec("SELECT COUNT(*) FROM passengers") && query.next());
+    QCOMPARE(query.value(0).toInt(), booked.load());
+}
+
+void TestFlightSystem::testSeatMapAdjacentSeats()
+{
+    // 宽体机经济舱 3-4-3，第 10 至 45 排
+    SeatMap economy(AircraftLayout::forAircraft("Boeing 777-300ER").cabins.last());
+    QVERIFY(economy.isValid());
+    QCOMPARE(economy.capacity(), 360);
+    
+    QCOMPARE(economy.findAdjacent(4), QStringList({"10D", "10E", "10F", "10G"}));
+    QCOMPARE(economy.findAdjacent(3), QStringList({"10A", "10B", "10C"}));
+    QVERIFY(economy.findAdjacent(5).isEmpty());
+    
+    // 中间段占去一座后，4 连座只能去下一排，3 连座不会跨过道拼凑
+    QVERIFY(economy.hold("10E"));
+    QCOMPARE(economy.findAdjacent(4), QStringList({"11D", "11E", "11F", "11G"}));
+    QVERIFY(economy.assign("10A"));
+    QVERIFY(economy.hold("10H"));
+    QCOMPARE(economy.findAdjacent(3), QStringList({"11A", "11B", "11C"}));
+    
+    QVERIFY(!economy.hold("10E"));
+    QVERIFY(economy.assign("10E"));
+    QVERIFY(!economy.assign("10E"));
+    QVERIFY(!economy.hold("9A"));
+    QVERIFY(!economy.hold("10I"));
+    QCOMPARE(economy.freeCount(), 357);
+    QCOMPARE(economy.assignedSeats(), QStringList({"10A", "10E"}));
+    
+    QVERIFY(economy.release("10E"));
+    QVERIFY(economy.release("10H"));
+    QCOMPARE(economy.freeCount(), 359);
+}
+
+void TestFlightSystem::testSeatMapEnginePersistSeat()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("seats.db"), "", ""));
+    
+    // 两个航班各有一位经济舱乘客
+    QHash<QString, qint64> passengerIds;
+    for (int serial = 1; serial <= 2; ++serial) {
+        const QString flightNumber = makeFlight(serial)["flight_number"].toString();
+        QVERIFY(helper.insertFlight(makeFlight(serial)));
+        QVERIFY(helper.setSeatInventory(flightNumber, "经济舱", 50));
+        
+        Booking booking;
+        booking.userId = serial;
+        booking.flightNumber = flightNumber;
+        booking.totalPrice = 800.0;
+        Passenger passenger;
+        passenger.firstName = "测试";
+        passenger.lastName = QString::number(serial);
+        passenger.idNumber = QString("ID%1").arg(serial);
+        QCOMPARE(helper.createBooking(booking, {passenger}).status, BookingResult::Booked);
+        
+        QSqlQuery query(helper.pool()->acquire());
+        QVERIFY(query.prepare("SELECT p.id FROM passengers p JOIN bookings b ON b.id = p.booking_id "
+                              "WHERE b.flight_number = ?"));
+        query.addBindValue(flightNumber);
+        QVERIFY(query.exec() && query.next());
+        passengerIds.insert(flightNumber, query.value(0).toLongLong());
+    }
+    
+    const QString flightNumber = makeFlight(1)["flight_number"].toString();
+    const qint64 passenger = passengerIds.value(flightNumber);
+    const qint64 otherPassenger = passengerIds.value(makeFlight(2)["flight_number"].toString());
+    
+    SeatMapEngine engine(&helper);
+    QVERIFY(engine.persistSeat(passenger, flightNumber, "经济舱", "4A"));
+    QVERIFY(engine.seatMap(flightNumber, "经济舱").isAssigned("4A"));
+    
+    // 换座后原座位释放
+    QSignalSpy changes(&engine, &SeatMapEngine::seatChanged);
+    QVERIFY(engine.persistSeat(passenger, flightNumber, "经济舱", "5C"));
+    QCOMPARE(changes.count(), 2);
+    SeatMap economy = engine.seatMap(flightNumber, "经济舱");
+    QVERIFY(economy.isFree("4A"));
+    QCOMPARE(economy.assignedSeats(), QStringList({"5C"}));
+    
+    // 其他航班的乘客和舱位不符的选座都被拒绝，座位图保持原样
+    QVERIFY(!engine.persistSeat(otherPassenger, flightNumber, "经济舱", "6A"));
+    QVERIFY(engine.seatMap(flightNumber, "经济舱").isFree("6A"));
+    QVERIFY(!engine.persistSeat(passenger, flightNumber, "商务舱", "1A"));
+    QVERIFY(engine.seatMap(flightNumber, "商务舱").isFree("1A"));
+    
+    // 数据库与座位图一致，重新建图得到同样的结果
+    QCOMPARE(helper.queryAssignedSeats(flightNumber, "经济舱"), QStringList({"5C"}));
+    SeatMapEngine reloaded(&helper);
+    QCOMPARE(reloaded.seatMap(flightNumber, "经济舱").assignedSeats(), QStringList({"5C"}));
+}
+
+void TestFlightSystem::testRouteSearchConnections()
+{
+    int serial = 0;
+    auto leg = [&serial](const QString &from, const QString &to, const QString &depart,
+                         const QString &arrive, double price) {
+        Flight flight;
+        flight.id = ++serial;
+        flight.flightNumber = QString("RT%1").arg(serial);
+        flight.departure = from;
+        flight.destination = to;
+        flight.departureTime = "2024-03-01 " + depart;
+        flight.arrivalTime = "2024-03-01 " + arrive;
+        flight.economyPrice = price;
+        return flight;
+    };
+    
+    RouteSearchEngine engine;
+    engine.build({
+        leg("北京", "上海", "08:00", "10:00", 1500),
+        leg("北京", "广州", "07:00", "10:00", 500),
+        leg("广州", "上海", "10:30", "12:30", 300),   // 衔接仅 30 分钟，不可用
+        leg("广州", "上海", "11:00", "13:00", 400),
+        leg("北京", "西安", "06:00", "08:00", 200),
+        leg("西安", "成都", "09:00", "10:30", 200),
+        leg("成都", "上海", "11:30", "13:30", 200)
+    });
+    QCOMPARE(engine.airportCount(), 5);
+    
+    const QVector<Itinerary> byDuration = engine.search("北京", "上海");
+    QCOMPARE(byDuration.size(), 3);
+    QCOMPARE(byDuration.at(0).stops(), 0);
+    QCOMPARE(byDuration.at(1).legs.last().flightNumber, QString("RT4"));
+    QCOMPARE(byDuration.at(1).durationMinutes, 360);
+    QCOMPARE(byDuration.at(2).stops(), 2);
+    
+    RouteSearchOptions cheapest;
+    cheapest.sortBy = RouteSearchOptions::ByPrice;
+    cheapest.maxResults = 1;
+    const QVector<Itinerary> byPrice = engine.search("北京", "上海", cheapest);
+    QCOMPARE(byPrice.size(), 1);
+    QCOMPARE(byPrice.first().totalPrice, 600.0);
+    
+    RouteSearchOptions oneStop;
+    oneStop.maxStops = 1;
+    QCOMPARE(engine.search("北京", "上海", oneStop).size(), 2);
+}
+
+void TestFlightSystem::testRouteSearchAtScale()
+{
+    // 200 个机场，每个机场每天 4 个时刻飞往相隔 1、7、31 的机场，共 2400 个航段
+    const int airportCount = 200;
+    const int offsets[] = {1, 7, 31};
+    const int hours[] = {6, 10, 14, 18};
+    auto airport = [](int i) { return QString("A%1").arg(i, 3, 10, QChar('0')); };
+    
+    QVector<Flight> flights;
+    for (int i = 0; i < airportCount; ++i) {
+        for (int offset : offsets) {
+            for (int hour : hours) {
+                Flight flight;
+                flight.id = flights.size() + 1;
+                flight.flightNumber = QString("SC%1").arg(flight.id, 5, 10, QChar('0'));
+                flight.departure = airport(i);
+                flight.destination = airport((i + offset) % airportCount);
+                flight.departureTime = QString("2024-03-01 %1:00").arg(hour, 2, 10, QChar('0'));
+                flight.arrivalTime = QString("2024-03-01 %1:00").arg(hour + 1 + offset % 3, 2, 10, QChar('0'));
+                flight.economyPrice = 300 + (i * 7 + offset * 13 + hour) % 500;
+                flights.append(flight);
+            }
+        }
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    RouteSearchEngine engine;
+    engine.build(flights);
+    const qint64 buildNs = timer.nsecsElapsed();
+    QCOMPARE(engine.airportCount(), airportCount);
+    QCOMPARE(engine.flightCount(), flights.size());
+    
+    // 暴力枚举所有不超过 3 段、衔接 45 至 360 分钟的行程作为对照
+    const RouteSearchOptions options;
+    auto connects = [&options](const Flight &a, const Flight &b) {
+        const qint64 gap = RouteSearchEngine::minuteOf(b.departureTime) - RouteSearchEngine::minuteOf(a.arrivalTime);
+        return a.destination == b.departure && gap >= options.minConnectionMinutes
+               && gap <= options.maxConnectionMinutes;
+    };
+    auto bruteForce = [&](const QString &origin, const QString &destination) {
+        QVector<int> durations;
+        auto duration = [](const Flight &first, const Flight &last) {
+            return int(RouteSearchEngine::minuteOf(last.arrivalTime) - RouteSearchEngine::minuteOf(first.departureTime));
+        };
+        for (const Flight &a : flights) {
+            if (a.departure != origin) continue;
+            if (a.destination == destination) {
+                durations.append(duration(a, a));
+                continue;
+            }
+            for (const Flight &b : flights) {
+                if (!connects(a, b) || b.destination == origin) continue;
+                if (b.destination == destination) {
+                    durations.append(duration(a, b));
+                    continue;
+                }
+                for (const Flight &c : flights) {
+                    if (connects(b, c) && c.destination == destination && c.departure != origin) {
+                        durations.append(duration(a, c));
+                    }
+                }
+            }
+        }
+        std::sort(durations.begin(), durations.end());
+        return durations;
+    };
+    
+    // 直飞、一次中转（1+7）和只能两次中转（31+7+7）的目的地
+    qint64 searchNs = 0;
+    for (int target : {7, 8, 45}) {
+        const QString origin = airport(0);
+        const QString destination = airport(target);
+        timer.restart();
+        const QVector<Itinerary> itineraries = engine.search(origin, destination, options);
+        searchNs += timer.nsecsElapsed();
+        
+        const QVector<int> expected = bruteForce(origin, destination);
+        QVERIFY(!expected.isEmpty());
+        QCOMPARE(itineraries.size(), qMin(options.maxResults, expected.size()));
+        for (int i = 0; i < itineraries.size(); ++i) {
+            const Itinerary &itinerary = itineraries.at(i);
+            QCOMPARE(itinerary.durationMinutes, expected.at(i));
+            QVERIFY(itinerary.stops() <= options.maxStops);
+            QCOMPARE(itinerary.legs.first().departure, origin);
+            QCOMPARE(itinerary.legs.last().destination, destination);
+            for (int leg = 1; leg < itinerary.legs.size(); ++leg) {
+                QVERIFY(connects(itinerary.legs.at(leg - 1), itinerary.legs.at(leg)));
+            }
+        }
+    }
+    QCOMPARE(engine.search(airport(0), airport(45)).first().stops(), 2);
+    
+    qInfo("route search: build %.2f ms, %.3f ms/search over %d airports",
+          buildNs / 1e6, searchNs / 3 / 1e6, airportCount);
+}
+
+void TestFlightSystem::testFlightSearchItineraries()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("itineraries.db"), "", ""));
+    const QDate day = QDate::currentDate().addDays(5);
+    int serial = 0;
+    auto leg = [&](const QString &from, const QString &to, const QDate &date, const QString &depart,
+                   const QString &arrive, int price) {
+        QJsonObject flight = makeFlight(++serial, from, to);
+        flight["departure_time"] = date.toString("yyyy-MM-dd") + " " + depart;
+        flight["arrival_time"] = date.toString("yyyy-MM-dd") + " " + arrive;
+        flight["price_economy"] = price;
+        return flight;
+    };
+    QJsonArray flights;
+    flights.append(leg("北京", "广州", day, "07:00", "10:00", 500));
+    flights.append(leg("广州", "上海", day, "11:00", "13:00", 400));
+    flights.append(leg("上海", "北京", day.addDays(2), "09:00", "11:00", 700));
+    flights.append(leg("上海", "成都", day, "16:00", "19:00", 900));
+    QCOMPARE(helper.importFlights(flights).imported, qint64(4));
+    
+    AsyncDatabaseHelper async(&helper);
+    FlightSearchWidget widget;
+    widget.setDataSources(&async, nullptr);
+    QLineEdit *departureEdit = widget.findChild<QLineEdit *>("departureEdit");
+    QLineEdit *destinationEdit = widget.findChild<QLineEdit *>("destinationEdit");
+    QComboBox *tripType = widget.findChild<QComboBox *>("tripTypeCombo");
+    QTableView *results = widget.findChild<QTableView *>("resultsTable");
+    QVERIFY(departureEdit && destinationEdit && tripType && results);
+    widget.findChild<QDateEdit *>("departureDateEdit")->setDate(day);
+    widget.findChild<QDateEdit *>("returnDateEdit")->setDate(day.addDays(2));
+    FlightTableModel *model = qobject_cast<FlightTableModel *>(results->model());
+    QVERIFY(model != nullptr);
+    
+    // 往返：去程经广州中转，返程直飞
+    tripType->setCurrentIndex(1);
+    departureEdit->setText("北京");
+    destinationEdit->setText("上海");
+    QTest::mouseClick(widget.findChild<QPushButton *>("searchButton"), Qt::LeftButton);
+    QTRY_COMPARE(model->rowCount(), 2);
+    QCOMPARE(model->record(0).flightNumber, QString("TS000001 / TS000002"));
+    QCOMPARE(model->record(0).status, QString("中转 1 次"));
+    QCOMPARE(model->record(0).economyPrice, 900.0);
+    QCOMPARE(model->record(1).flightNumber, QString("TS000003"));
+    
+    // 多程：北京 -> 上海 -> 成都，第二段在第一段到达当天出发
+    tripType->setCurrentIndex(2);
+    destinationEdit->setText("上海, 成都");
+    QTest::mouseClick(widget.findChild<QPushButton *>("searchButton"), Qt::LeftButton);
+    QTRY_COMPARE(model->rowCount(), 2);
+    QCOMPARE(model->record(1).departure, QString("上海"));
+    QCOMPARE(model->record(1).destination, QString("成都"));
+    
+    // 导入新航班后下一次行程搜索重建航线图
+    QCOMPARE(helper.importFlights(QJsonArray{leg("北京", "上海", day, "08:00", "10:00", 1500)}).imported, qint64(1));
+    QTest::mouseClick(widget.findChild<QPushButton *>("searchButton"), Qt::LeftButton);
+    QTRY_COMPARE(model->rowCount(), 3);
+}
+
+void TestFlightSystem::testFareCalendar()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("fares.db"), "", ""));
+    const QDate today = QDate::currentDate();
+    auto flightOn = [](int serial, const QDate &date, int economy, const QString &destination = "上海") {
+        QJsonObject flight = makeFlight(serial, "北京", destination);
+        flight["departure_time"] = date.toString("yyyy-MM-dd") + " 08:00";
+        flight["arrival_time"] = date.toString("yyyy-MM-dd") + " 10:00";
+        flight["price_economy"] = economy;
+        return flight;
+    };
+    
+    // 昨天、今天两班、窗口最后一天和窗口外一天
+    QVERIFY(helper.insertFlight(flightOn(1, today.addDays(-1), 500)));
+    QVERIFY(helper.insertFlight(flightOn(2, today, 900)));
+    QVERIFY(helper.insertFlight(flightOn(3, today, 700)));
+    QVERIFY(helper.insertFlight(flightOn(4, today.addDays(FareCalendar::Days - 1), 800)));
+    QVERIFY(helper.insertFlight(flightOn(5, today.addDays(FareCalendar::Days), 600)));
+    
+    AsyncDatabaseHelper async(&helper);
+    FareCalendar calendar(&helper);
+    calendar.setAsyncDatabase(&async);
+    QVERIFY(calendar.rebuild());
+    QCOMPARE(calendar.startDate(), today);
+    QCOMPARE(calendar.routeCount(), 1);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today), 700.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(-1)), 0.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(FareCalendar::Days - 1)), 800.0);
+    QCOMPARE(calendar.lowestFare("北京", "广州", today), 0.0);
+    QCOMPARE(calendar.fares("北京", "上海", today.addDays(-1), 3), QVector<double>({0.0, 700.0, 0.0}));
+    const QVector<double> month = calendar.monthFares("北京", "上海", today.year(), today.month());
+    QCOMPARE(month.size(), today.daysInMonth());
+    QCOMPARE(month.at(today.day() - 1), 700.0);
+    
+    // 一次导入多条航线的通知合并处理，每条航线只重算一次
+    QSignalSpy updated(&calendar, &FareCalendar::calendarUpdated);
+    QVERIFY(helper.insertFlight(flightOn(6, today, 650)));
+    QJsonArray imported;
+    imported.append(flightOn(7, today.addDays(1), 400));
+    imported.append(flightOn(8, today.addDays(2), 450, "广州"));
+    imported.append(flightOn(9, today.addDays(3), 480, "广州"));
+    QCOMPARE(helper.importFlights(imported).imported, qint64(3));
+    QCOMPARE(calendar.lowestFare("北京", "上海", today), 700.0);
+    QTRY_COMPARE(updated.count(), 2);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today), 650.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(1)), 400.0);
+    QCOMPARE(calendar.lowestFare("北京", "广州", today.addDays(2)), 450.0);
+    QCOMPARE(calendar.routeCount(), 2);
+    QTest::qWait(FareCalendar::RefreshDelayMs * 2);
+    QCOMPARE(updated.count(), 2);
+    
+    // 取消后不再计入最低价
+    QVERIFY(helper.updateFlightStatus(flightOn(6, today, 650)["flight_number"].toString(), "取消"));
+    QTRY_COMPARE(calendar.lowestFare("北京", "上海", today), 700.0);
+    
+    // 跨天：窗口从昨天开始的日历在检查时前移到今天
+    QVERIFY(calendar.rebuild(today.addDays(-1)));
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(-1)), 500.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(FareCalendar::Days - 1)), 0.0);
+    QSignalSpy rebuilt(&calendar, &FareCalendar::calendarRebuilt);
+    QVERIFY(QMetaObject::invokeMethod(&calendar, "checkRollover"));
+    QTRY_COMPARE(rebuilt.count(), 1);
+    QCOMPARE(calendar.startDate(), today);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(-1)), 0.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today), 700.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(FareCalendar::Days - 1)), 800.0);
+    QCOMPARE(calendar.lowestFare("北京", "上海", today.addDays(FareCalendar::Days)), 0.0);
+}
+
+void TestFlightSystem::testFlightSearchFareHints()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("hints.db"), "", ""));
+    const QDate day = QDate::currentDate().addDays(3);
+    QJsonObject flight = makeFlight(1);
+    flight["departure_time"] = day.toString("yyyy-MM-dd") + " 08:00";
+    flight["arrival_time"] = day.toString("yyyy-MM-dd") + " 10:00";
+    flight["price_economy"] = 680;
+    QVERIFY(helper.insertFlight(flight));
+    
+    FareCalendar calendar(&helper);
+    FlightSearchWidget widget;
+    widget.setFareCalendar(&calendar);
+    QLabel *fareLabel = widget.findChild<QLabel *>("lowestFareLabel");
+    QVERIFY(fareLabel != nullptr);
+    
+    // 还没有查价时不建日历
+    QVERIFY(!calendar.startDate().isValid());
+    
+    widget.findChild<QLineEdit *>("departureEdit")->setText("北京");
+    widget.findChild<QLineEdit *>("destinationEdit")->setText("上海");
+    QCOMPARE(calendar.startDate(), QDate::currentDate());
+    QCOMPARE(fareLabel->text(), QString("当日最低价: -"));
+    
+    QDateEdit *dateEdit = widget.findChild<QDateEdit *>("departureDateEdit");
+    QVERIFY(dateEdit != nullptr);
+    dateEdit->setDate(day);
+    QCOMPARE(fareLabel->text(), QString("当日最低价: ¥680"));
+    dateEdit->calendarWidget()->setCurrentPage(day.year(), day.month());
+    QCOMPARE(dateEdit->calendarWidget()->dateTextFormat(day).toolTip(), QString("最低价 ¥680"));
+}
+
+void TestFlightSystem::testAirportIndexSuggestions()
+{
+    const AirportIndex &index = AirportIndex::defaultIndex();
+    QCOMPARE(index.suggest("pvg").first().iata, QString("PVG"));
+    QCOMPARE(index.suggest("北京首都").first().iata, QString("PEK"));
+    QCOMPARE(index.suggest("cheng").first().city, QString("成都"));
+    QCOMPARE(index.suggest("sh").first().city, QString("上海"));
+    QCOMPARE(index.suggest("beijng").first().city, QString("北京"));     // 漏字
+    QCOMPARE(index.resolveCity("北京大兴国际机场 (PKX)"), QString("北京"));
+    QCOMPARE(index.resolveCity("xyz123"), QString("xyz123"));
+    
+    // 1 万个机场时各类查询（含拼写错误）仍有联想结果
+    QVector<Airport> synthetic = AirportIndex::builtinAirports();
+    const QStringList syllables = {"an", "bei", "chang", "da", "fu", "guang", "hai", "jin", "lan", "nan",
+                                   "qing", "shan", "tai", "xi", "yun", "zhou"};
+    for (int i = 0; synthetic.size() < 10000; ++i) {
+        const QString pinyin = syllables.at(i % 16) + " " + syllables.at(i / 16 % 16) + " "
+                               + syllables.at(i / 256 % 16);
+        synthetic.append(Airport{QString("Z%1").arg(i, 2, 36, QChar('0')).toUpper().left(3),
+                                 QString("城市%1").arg(i), QString("城市%1机场").arg(i), pinyin});
+    }
+    AirportIndex large;
+    large.build(synthetic);
+    
+    const QStringList queries = {"b", "bei", "beijng", "shanghia", "城市12", "PEK", "guangzhou", "xian"};
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < 25; ++round) {
+        for (const QString &query : queries) {
+            QVERIFY(!large.suggest(query).isEmpty());
+        }
+    }
+    // 耗时只作记录，不作断言
+    qInfo("airport suggestions: %.3f ms/query over %d airports",
+          double(timer.nsecsElapsed()) / (25 * queries.size()) / 1e6, int(synthetic.size()));
+}
+
+void TestFlightSystem::testFlightTableModelFetchesInBatches()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("model.db"), "", ""));
+    
+    QJsonArray flights;
+    for (int i = 0; i < 25; ++i) {
+        flights.append(makeFlight(i));
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(25));
+    
+    // 游标读到最后一批时立即关闭，不等视图再取一次空批次
+    FlightTableModel model;
+    model.setCursor(helper.openFlightCursor("", "", 10));
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    QVERIFY(helper.pool()->isPinned());
+    
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 10);
+    
+    int fetches = 1;
+    while (model.canFetchMore(QModelIndex())) {
+        model.fetchMore(QModelIndex());
+        ++fetches;
+    }
+    QCOMPARE(model.rowCount(), 25);
+    QCOMPARE(fetches, 3);
+    QVERIFY(!helper.pool()->isPinned());
+    
+    // 没读完就重置模型，游标随数据源释放
+    model.setCursor(helper.openFlightCursor("", "", 10));
+    model.fetchMore(QModelIndex());
+    QVERIFY(helper.pool()->isPinned());
+    model.setRecords(QVector<Flight>());
+    QVERIFY(!helper.pool()->isPinned());
+    
+    // 分页读取在两次 fetchMore 之间不持有语句，按 (departure_time, id) 排序
+    FlightTableModel paged;
+    paged.setDatabase(&helper, "", "", 10);
+    QVERIFY(paged.canFetchMore(QModelIndex()));
+    fetches = 0;
+    while (paged.canFetchMore(QModelIndex())) {
+        paged.fetchMore(QModelIndex());
+        QVERIFY(!helper.pool()->isPinned());
+        ++fetches;
+    }
+    QCOMPARE(fetches, 3);
+    QCOMPARE(paged.rowCount(), 25);
+    const QVector<Flight> all = helper.queryFlightPage("", "", PageKey(), 100).items;
+    for (int row = 0; row < paged.rowCount(); ++row) {
+        QCOMPARE(paged.record(row).id, all.at(row).id);
+    }
+    
+    // 达到行数上限后不再读取
+    paged.setMaxRows(15);
+    paged.setDatabase(&helper, "", "", 10);
+    while (paged.canFetchMore(QModelIndex())) {
+        paged.fetchMore(QModelIndex());
+    }
+    QCOMPARE(paged.rowCount(), 15);
+    
+    const int status = model.columnOf(FlightTableModel::Status);
+    QCOMPARE(model.headerData(status, Qt::Horizontal).toString(), QString("状态"));
+    QCOMPARE(paged.index(0, status).data().toString(), QString("准点"));
+}
+
+void TestFlightSystem::testTableFilterEngine()
+{
+    // 匹配不区分大小写，也不会跨越行边界
+    const FilterColumnIndex index({"Airbus A320", "Boeing 737", "a3", "20"});
+    QCOMPARE(index.match("a3"), QVector<int>({0, 2}));
+    QCOMPARE(index.match("320"), QVector<int>({0}));
+    QVERIFY(index.match("a320b").isEmpty());
+    
+    QVector<Flight> flights;
+    for (int i = 0; i < 5000; ++i) {
+        Flight flight;
+        flight.id = i + 1;
+        flight.flightNumber = QString("TS%1").arg(i, 6, 10, QChar('0'));
+        flight.status = i % 10 ? "准点" : "延误";
+        flights.append(flight);
+    }
+    
+    FlightTableModel model;
+    model.setRecords(flights);
+    TableFilterEngine engine(&model);
+    QSignalSpy spy(&engine, &TableFilterEngine::filtered);
+    
+    // 连续输入时只应用最后一次结果
+    const int column = model.columnOf(FlightTableModel::FlightNumber);
+    engine.filter(column, "ts0000");
+    engine.filter(column, "ts00012");
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(0).toInt(), 10);
+    QCOMPARE(engine.proxyModel()->rowCount(), 10);
+    QCOMPARE(engine.sourceRow(engine.proxyModel()->index(0, 0)), 120);
+    
+    // 数据变化后按当前条件重新过滤
+    model.updateRecord(5, flights.at(120));
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(engine.proxyModel()->rowCount(), 11);
+    
+    engine.clear();
+    QCOMPARE(engine.proxyModel()->rowCount(), 5000);
+}
+
+void TestFlightSystem::benchmarkStorageProfile_data()
+{
+    QTest::addColumn<bool>("useWal");
+    
+    QTest::newRow("rollback-journal") << false;
+    QTest::newRow("wal") << true;
+}
+
+void TestFlightSystem::benchmarkStorageProfile()
+{
+    // 4 个读线程持续查询，同时主线程逐行写入（每行一个自动提交事务）
+    QFETCH(bool, useWal);
+    
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    helper.setStorageProfile(useWal ? StorageProfile::concurrentProfile()
+                                    : StorageProfile::legacyProfile());
+    // 读线程测的是 SQLite 并发读，关闭查找缓存
+    helper.setLookupCacheSize(0);
+    QVERIFY(helper.connectToDatabase("", dir.filePath("benchmark.db"), "", ""));
+    // 被读的航班先写入，读不到只可能是库被写锁占用
+    QVERIFY(helper.insertFlight(makeFlight(0)));
+    
+    int serial = 0;
+    qint64 writes = 0;
+    std::atomic<qint64> reads(0);
+    std::atomic<qint64> failedReads(0);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    
+    QBENCHMARK {
+        std::atomic<bool> writing(true);
+        QList<QThread *> readers;
+        for (int i = 0; i < 4; ++i) {
+            QThread *reader = QThread::create([&helper, &writing, &reads, &failedReads]() {
+                while (writing) {
+                    if (helper.getFlightDetails("TS000000").isEmpty()) {
+                        ++failedReads;
+                    } else {
+                        ++reads;
+                    }
+                }
+            });
+            reader->start();
+            readers.append(reader);
+        }
+        
+        for (int i = 0; i < 200; ++i) {
+            if (helper.insertFlight(makeFlight(++serial))) {
+                ++writes;
+            }
+        }
+        
+        writing = false;
+        for (QThread *reader : readers) {
+            reader->wait();
+            delete reader;
+        }
+    }
+    
+    const double seconds = qMax<qint64>(1, elapsed.elapsed()) / 1000.0;
+    qInfo("%s: %.0f writes/s, %.0f reads/s, %.0f failed reads/s", useWal ? "WAL" : "rollback journal",
+          writes / seconds, reads.load() / seconds, failedReads.load() / seconds);
+}
+
+void TestFlightSystem::benchmarkRowDecoding_data()
+{
+    QTest::addColumn<bool>("typed");
+    
+    QTest::newRow("record-to-json-strings") << false;
+    QTest::newRow("typed-by-column-index") << true;
+}
+
+void TestFlightSystem::benchmarkRowDecoding()
+{
+    QFETCH(bool, typed);
+    
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    
+    DatabaseHelper helper;
+    QVERIFY(helper.connectToDatabase("", dir.filePath("decode.db"), "", ""));
+    
+    QJsonArray flights;
+    for (int i = 0; i < 2000; ++i) {
+        flights.append(makeFlight(i));
+    }
+    QCOMPARE(helper.importFlights(flights).imported, qint64(2000));
+    
+    // 分配次数在测试之外用 heaptrack 或 valgrind 测量，例如
+    // heaptrack <测试程序> benchmarkRowDecoding:typed-by-column-index
+    qint64 rows = 0;
+    
+    QBENCHMARK {
+        if (typed) {
+            rows = helper.queryFlights("北京", "上海").size();
+        } else {
+            // 原实现：SELECT *，每行按字段名写入 QJsonObject，所有值转为字符串
+            QSqlQuery query(helper.pool()->acquire());
+            query.prepare("SELECT * FROM flights WHERE departure = ? AND destination = ?");
+            query.addBindValue("北京");
+            query.addBindValue("上海");
+            
+            QJsonArray result;
+            if (query.exec()) {
+                while (query.next()) {
+                    QJsonObject flight;
+                    QSqlRecord record = query.record();
+                    for (int i = 0; i < record.count(); ++i) {
+                        flight[record.fieldName(i)] = query.value(i).toString();
+                    }
+                    result.append(flight);
+                }
+            }
+            rows = result.size();
+        }
+    }
+    
+    QCOMPARE(rows, qint64(2000));
+}
+
 QTEST_MAIN(TestFlightSystem)
 #include "test_main.moc"
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "tokenbucket.h"
+#include <cmath>
+
+TokenBucket::TokenBucket(int capacity, int refillPerMinute)
+    : maxTokens(qMax(1, capacity))
+    , perMinute(qMax(0, refillPerMinute))
+    , tokens(maxTokens)
+    , lastRefill(0)
+{
+}
+
+void TokenBucket::configure(int capacity, int refillPerMinute)
+{
+    maxTokens = qMax(1, capacity);
+    perMinute = qMax(0, refillPerMinute);
+    tokens = qMin(tokens, double(maxTokens));
+}
+
+bool TokenBucket::ready(qint64 now)
+{
+    refill(now);
+    return tokens >= 1.0;
+}
+
+bool TokenBucket::tryTake(qint64 now)
+{
+    if (!ready(now)) {
+        return false;
+    }
+    tokens -= 1.0;
+    return true;
+}
+
+qint64 TokenBucket::waitTime(qint64 now)
+{
+    if (ready(now)) {
+        return 0;
+    }
+    if (perMinute == 0) {
+        return -1;
+    }
+    return qint64(std::ceil((1.0 - tokens) * 60000.0 / perMinute));
+}
+
+int TokenBucket::capacity() const
+{
+    return maxTokens;
+}
+
+int TokenBucket::refillPerMinute() const
+{
+    return perMinute;
+}
+
+void TokenBucket::refill(qint64 now)
+{
+    if (now > lastRefill) {
+        tokens = qMin(double(maxTokens), tokens + (now - lastRefill) * perMinute / 60000.0);
+    }
+    lastRefill = qMax(lastRefill, now);
+}
@@ -0,0 +1,34 @@
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <QtGlobal>
+
+// 令牌桶：最多积攒 capacity 个令牌，按 refillPerMinute 匀速补充，每个请求消耗一个。
+// 任意一分钟内最多放行 capacity + refillPerMinute 个请求，两者之和不超过服务端限额即不会触发 429。
+// 时间由调用方传入（毫秒，单调递增）。
+class TokenBucket
+{
+public:
+    explicit TokenBucket(int capacity = 1, int refillPerMinute = 60);
+
+    void configure(int capacity, int refillPerMinute);
+
+    // 当前是否至少有一个令牌
+    bool ready(qint64 now);
+    bool tryTake(qint64 now);
+    // 距离下一个令牌可用还要多久，已有令牌时为 0，不再补充时为 -1
+    qint64 waitTime(qint64 now);
+
+    int capacity() const;
+    int refillPerMinute() const;
+
+private:
+    int maxTokens;
+    int perMinute;
+    double tokens;
+    qint64 lastRefill;
+
+    void refill(qint64 now);
+};
+
+#endif // TOKENBUCKET_H
@@ -146,12 +146,10 @@ void UserManagementWidget::setupUserTable()
     userCountLabel = new QLabel("用户总数: 0", this);
     mainLayout->addWidget(userCountLabel);
     
-    userTable = new QTableWidget(this);
-    userTable->setColumnCount(8);
-    
-    QStringList headers;
-    headers << "用户ID" << "用户名" << "姓名" << "邮箱" << "电话" << "角色" << "状态" << "注册时间";
-    userTable->setHorizontalHeaderLabels(headers);
+    userModel = new UserTableModel(this);
+    filterEngine = new TableFilterEngine(userModel, this);
+    userTable = new QTableView(this);
+    userTable->setModel(filterEngine->proxyModel());
     
     // 设置表格属性
     userTable->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -160,6 +158,10 @@ void UserManagementWidget::setupUserTable()
     userTable->horizontalHeader()->setStretchLastSection(true);
     userTable->verticalHeader()->setVisible(false);
     
+    // 固定行高，视图只需计算可见行
+    userTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    userTable->verticalHeader()->setDefaultSectionSize(32);
+    
     // 设置列宽
     userTable->setColumnWidth(0, 80);  // 用户ID
     userTable->setColumnWidth(1, 120); // 用户名
@@ -183,7 +185,7 @@ void UserManagementWidget::connectSignals()
     
     connect(searchButton, &QPushButton::clicked, this, &UserManagementWidget::searchUsers);
     connect(clearSearchButton, &QPushButton::clicked, this, &UserManagementWidget::clearSearch);
-    connect(userTable, &QTableWidget::cellClicked, this, &UserManagementWidget::onUserSelected);
+    connect(userTable, &QTableView::clicked, this, &UserManagementWidget::onUserSelected);
 }
 
 void UserManagementWidget::addUser()
@@ -207,7 +209,7 @@ void UserManagementWidget::addUser()
 
 void UserManagementWidget::editUser()
 {
-    int currentRow = userTable->currentRow();
+    const int currentRow = filterEngine->sourceRow(userTable->currentIndex());
     if (currentRow < 0) {
         QMessageBox::warning(this, "选择用户", "请先选择要编辑的用户");
         return;
@@ -218,12 +220,15 @@ void UserManagementWidget::editUser()
     enableUserForm(true);
     
     // 加载用户数据到表单
-    userIdEdit->setText(userTable->item(currentRow, 0)->text());
-    usernameEdit->setText(userTable->item(currentRow, 1)->text());
-    emailEdit->setText(userTable->item(currentRow, 3)->text());
-    phoneEdit->setText(userTable->item(currentRow, 4)->text());
-    roleCombo->setCurrentText(userTable->item(currentRow, 5)->text());
-    statusCombo->setCurrentText(userTable->item(currentRow, 6)->text());
+    const User &user = userModel->record(currentRow);
+    userIdEdit->setText(QString::number(user.id));
+    usernameEdit->setText(user.username);
+    emailEdit->setText(user.email);
+    phoneEdit->setText(user.phone);
+    firstNameEdit->setText(user.firstName);
+    lastNameEdit->setText(user.lastName);
+    roleCombo->setCurrentText(user.role);
+    statusCombo->setCurrentText(user.status);
     
     // 切换按钮状态
     addButton->setVisible(false);
@@ -235,13 +240,13 @@ void UserManagementWidget::editUser()
 
 void UserManagementWidget::deleteUser()
 {
-    int currentRow = userTable->currentRow();
+    const int currentRow = filterEngine->sourceRow(userTable->currentIndex());
     if (currentRow < 0) {
         QMessageBox::warning(this, "选择用户", "请先选择要删除的用户");
         return;
     }
     
-    QString username = userTable->item(currentRow, 1)->text();
+    QString username = userModel->record(currentRow).username;
     QMessageBox::StandardButton reply = QMessageBox::question(
         this, "确认删除", 
         QString("确定要删除用户 '%1' 吗？").arg(username),
@@ -249,7 +254,7 @@ void UserManagementWidget::deleteUser()
     );
     
     if (reply == QMessageBox::Yes) {
-        userTable->removeRow(currentRow);
+        userModel->removeRecord(currentRow);
         updateUserTable();
         QMessageBox::information(this, "删除成功", "用户已删除");
     }
@@ -261,27 +266,10 @@ void UserManagementWidget::saveUser()
     
     if (isEditing && currentEditRow >= 0) {
         // 更新现有用户
-        userTable->setItem(currentEditRow, 0, new QTableWidgetItem(userIdEdit->text()));
-        userTable->setItem(currentEditRow, 1, new QTableWidgetItem(usernameEdit->text()));
-        userTable->setItem(currentEditRow, 2, new QTableWidgetItem(firstNameEdit->text() + " " + lastNameEdit->text()));
-        userTable->setItem(currentEditRow, 3, new QTableWidgetItem(emailEdit->text()));
-        userTable->setItem(currentEditRow, 4, new QTableWidgetItem(phoneEdit->text()));
-        userTable->setItem(currentEditRow, 5, new QTableWidgetItem(roleCombo->currentText()));
-        userTable->setItem(currentEditRow, 6, new QTableWidgetItem(statusCombo->currentText()));
-        userTable->setItem(currentEditRow, 7, new QTableWidgetItem(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss")));
+        userModel->updateRecord(currentEditRow, userFromForm());
     } else {
         // 添加新用户
-        int row = userTable->rowCount();
-        userTable->insertRow(row);
-        
-        userTable->setItem(row, 0, new QTableWidgetItem(userIdEdit->text()));
-        userTable->setItem(row, 1, new QTableWidgetItem(usernameEdit->text()));
-        userTable->setItem(row, 2, new QTableWidgetItem(firstNameEdit->text() + " " + lastNameEdit->text()));
-        userTable->setItem(row, 3, new QTableWidgetItem(emailEdit->text()));
-        userTable->setItem(row, 4, new QTableWidgetItem(phoneEdit->text()));
-        userTable->setItem(row, 5, new QTableWidgetItem(roleCombo->currentText()));
-        userTable->setItem(row, 6, new QTableWidgetItem(statusCombo->currentText()));
-        userTable->setItem(row, 7, new QTableWidgetItem(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss")));
+        userModel->appendRecords({userFromForm()});
     }
     
     updateUserTable();
@@ -312,19 +300,14 @@ void UserManagementWidget::searchUsers()
         return;
     }
     
-    for (int i = 0; i < userTable->rowCount(); ++i) {
-        bool match = false;
-        int searchColumn = searchTypeCombo->currentIndex();
-        
-        if (searchColumn < userTable->columnCount()) {
-            QTableWidgetItem *item = userTable->item(i, searchColumn);
-            if (item && item->text().contains(searchText, Qt::CaseInsensitive)) {
-                match = true;
-            }
-        }
-        
-        userTable->setRowHidden(i, !match);
-    }
+    // 映射搜索类型到模型列
+    const int searchColumns[] = {UserTableModel::Username, UserTableModel::Email,
+                                 UserTableModel::Phone, UserTableModel::Id};
+    const int searchType = qBound(0, searchTypeCombo->currentIndex(), 3);
+    const int column = userModel->columnOf(searchColumns[searchType]);
+    
+    // 匹配在后台线程完成，结果整批交给代理模型
+    filterEngine->filter(column, searchText);
 }
 
 void UserManagementWidget::clearSearch()
@@ -335,27 +318,20 @@ void UserManagementWidget::clearSearch()
 
 void UserManagementWidget::loadUsers()
 {
-    for (int i = 0; i < userTable->rowCount(); ++i) {
-        userTable->setRowHidden(i, false);
-    }
+    filterEngine->clear();
 }
 
-void UserManagementWidget::onUserSelected(int row, int column)
+void UserManagementWidget::onUserSelected(const QModelIndex &index)
 {
-    Q_UNUSED(column);
-    
-    if (row >= 0 && row < userTable->rowCount()) {
+    if (index.isValid()) {
         // 可以在这里加载用户详细信息
     }
 }
 
 void UserManagementWidget::loadSampleUsers()
 {
-    // 清空现有数据
-    userTable->setRowCount(0);
-    
     // 模拟用户数据
-    QList<QStringList> sampleUsers = {
+    const QList<QStringList> sampleUsers = {
         {"1001", "admin", "管理员", "admin@flight.com", "13800138001", "管理员", "活跃", "2024-01-01 10:00:00"},
         {"1002", "zhangsan", "张三", "zhangsan@email.com", "13800138002", "普通用户", "活跃", "2024-01-15 14:30:00"},
         {"1003", "lisi", "李四", "lisi@email.com", "13800138003", "VIP用户", "活跃", "2024-02-01 09:15:00"},
@@ -366,29 +342,22 @@ void UserManagementWidget::loadSampleUsers()
         {"1008", "zhoujiu", "周九", "zhoujiu@email.com", "13800138008", "管理员", "活跃", "2024-04-01 08:45:00"}
     };
     
-    for (const QStringList &user : sampleUsers) {
-        int row = userTable->rowCount();
-        userTable->insertRow(row);
-        
-        for (int col = 0; col < user.size(); ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(user[col]);
-            item->setTextAlignment(Qt::AlignCenter);
-            
-            // 根据状态设置颜色
-            if (col == 6) { // 状态列
-                if (user[col] == "活跃") {
-                    item->setForeground(QColor(0, 128, 0)); // 绿色
-                } else if (user[col] == "暂停") {
-                    item->setForeground(QColor(255, 165, 0)); // 橙色
-                } else if (user[col] == "禁用") {
-                    item->setForeground(QColor(255, 0, 0)); // 红色
-                }
-            }
-            
-            userTable->setItem(row, col, item);
-        }
+    QVector<User> users;
+    users.reserve(sampleUsers.size());
+    for (const QStringList &row : sampleUsers) {
+        User user;
+        user.id = row[0].toLongLong();
+        user.username = row[1];
+        user.firstName = row[2];
+        user.email = row[3];
+        user.phone = row[4];
+        user.role = row[5];
+        user.status = row[6];
+        user.createdAt = row[7];
+        users.append(user);
     }
     
+    userModel->setRecords(users);
     updateUserTable();
 }
 
@@ -412,7 +381,7 @@ void UserManagementWidget::validateUserForm()
 
 void UserManagementWidget::updateUserTable()
 {
-    userCountLabel->setText(QString("用户总数: %1").arg(userTable->rowCount()));
+    userCountLabel->setText(QString("用户总数: %1").arg(userModel->rowCount()));
 }
 
 void UserManagementWidget::clearUserForm()
@@ -431,6 +400,21 @@ void UserManagementWidget::clearUserForm()
     addressEdit->clear();
 }
 
+User UserManagementWidget::userFromForm() const
+{
+    User user;
+    user.id = userIdEdit->text().toLongLong();
+    user.username = usernameEdit->text();
+    user.email = emailEdit->text();
+    user.phone = phoneEdit->text();
+    user.firstName = firstNameEdit->text();
+    user.lastName = lastNameEdit->text();
+    user.role = roleCombo->currentText();
+    user.status = statusCombo->currentText();
+    user.createdAt = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    return user;
+}
+
 void UserManagementWidget::enableUserForm(bool enabled)
 {
     usernameEdit->setEnabled(enabled);
@@ -490,16 +474,16 @@ void UserManagementWidget::applyStyles()
             background-color: #cccccc;
             color: #666666;
         }
-        QTableWidget {
+        QTableView {
             gridline-color: #e0e0e0;
             background-color: white;
             alternate-background-color: #f9f9f9;
             selection-background-color: #4a90e2;
         }
-        QTableWidget::item {
+        QTableView::item {
             padding: 8px;
         }
-        QTableWidget::item:selected {
+        QTableView::item:selected {
             color: white;
         }
         QHeaderView::section {
@@ -8,12 +8,14 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
 #include <QLabel>
 #include <QGroupBox>
 #include <QDateEdit>
 #include <QTextEdit>
 #include <QProgressBar>
+#include "tablemodels.h"
+#include "tablefilter.h"
 
 class UserManagementWidget : public QWidget
 {
@@ -29,7 +31,7 @@ private slots:
     void searchUsers();
     void clearSearch();
     void loadUsers();
-    void onUserSelected(int row, int column);
+    void onUserSelected(const QModelIndex &index);
     void saveUser();
     void cancelEdit();
 
@@ -44,6 +46,7 @@ private:
     void updateUserTable();
     void clearUserForm();
     void enableUserForm(bool enabled);
+    User userFromForm() const;
     
     // 用户表单组件
     QGroupBox *userFormGroup;
@@ -67,7 +70,9 @@ private:
     QPushButton *clearSearchButton;
     
     // 用户表格
-    QTableWidget *userTable;
+    QTableView *userTable;
+    UserTableModel *userModel;
+    TableFilterEngine *filterEngine;
     QLabel *userCountLabel;
     
     // 按钮